@@ -0,0 +1,55 @@
+// Tests that a $group is only split across threads when its results do not depend on the order in
+// which the threads see the documents.
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod({setParameter: {internalDocumentSourceGroupParallelism: 4}});
+assert.neq(null, conn, "mongod was unable to start up");
+const db = conn.getDB("test");
+const coll = db.parallel_group_order_dependent;
+
+const numKeys = 10;
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < 10000; i++) {
+    bulk.insert({_id: i, a: i % numKeys, b: (i * 7919) % 10000});
+}
+assert.commandWorked(bulk.execute());
+
+assert.commandWorked(db.setLogLevel(1, "query"));
+
+function runsInParallel(pipeline) {
+    assert.commandWorked(db.adminCommand({clearLog: "global"}));
+    const results = coll.aggregate(pipeline).toArray();
+    return {results: results, parallel: checkLog.checkContainsOnceJson(conn, 4972101, {})};
+}
+
+// The $sort is pushed down into the query, so the $cursor returns the documents in order of 'b' and
+// $first must see them in that order.
+const expected = [];
+for (let a = 0; a < numKeys; a++) {
+    const docs = coll.find({a: a}).sort({b: 1}).toArray();
+    expected.push({_id: a, first: docs[0].b, last: docs[docs.length - 1].b});
+}
+for (let i = 0; i < 5; i++) {
+    const {results, parallel} = runsInParallel([
+        {$sort: {b: 1}},
+        {$group: {_id: "$a", first: {$first: "$b"}, last: {$last: "$b"}}},
+        {$sort: {_id: 1}}
+    ]);
+    assert(!parallel, "$group with $first after a $sort should not run in parallel");
+    assert.eq(results, expected);
+}
+
+// Order-insensitive accumulators are still split up after a $sort.
+let {results, parallel} = runsInParallel(
+    [{$sort: {b: 1}}, {$group: {_id: "$a", total: {$sum: 1}}}, {$sort: {_id: 1}}]);
+assert(parallel, "$group with $sum should run in parallel");
+assert.eq(results, Array.from({length: numKeys}, (_, a) => ({_id: a, total: 1000})));
+
+// Without a requested order, $first may run in parallel, as any document of the group is valid.
+({results, parallel} = runsInParallel([{$group: {_id: "$a", first: {$first: "$a"}}}]));
+assert(parallel, "$group with $first over an unordered $cursor should run in parallel");
+assert.eq(results.length, numKeys);
+
+MongoRunner.stopMongod(conn);
+}());
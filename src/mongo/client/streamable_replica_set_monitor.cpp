@@ -44,6 +44,8 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/bson_extract_optime.h"
 #include "mongo/db/server_options.h"
+#include "mongo/executor/host_latency_stats.h"
+#include "mongo/executor/host_latency_stats_gen.h"
 #include "mongo/executor/thread_pool_task_executor.h"
 #include "mongo/logv2/log.h"
 #include "mongo/platform/atomic_word.h"
@@ -226,6 +228,13 @@ void StreamableReplicaSetMonitor::drop() {
     _pingMonitor->shutdown();
     _isMasterMonitor->shutdown();
 
+    if (hasGlobalServiceContext()) {
+        auto hostLatencyStats = HostLatencyStats::get(getGlobalServiceContext());
+        for (const auto& server : _currentTopology()->getServers()) {
+            hostLatencyStats->removeHost(server->getAddress());
+        }
+    }
+
     ReplicaSetMonitorManager::get()->getNotifier().onDroppedSet(getName());
     LOGV2(4333210,
           "Done closing Replica Set Monitor {replicaSet}",
@@ -239,6 +248,9 @@ SemiFuture<HostAndPort> StreamableReplicaSetMonitor::getHostOrRefresh(
         .thenRunOn(_executor)
         .then([self = shared_from_this()](const std::vector<HostAndPort>& result) {
             invariant(result.size());
+            if (gAdaptiveReplicaSelectionEnabled.load()) {
+                return result.front();
+            }
             return result[self->_random.nextInt64(result.size())];
         })
         .semi();
@@ -365,7 +377,14 @@ boost::optional<std::vector<HostAndPort>> StreamableReplicaSetMonitor::_getHosts
     auto result = _serverSelector->selectServers(topology, criteria);
     if (!result)
         return boost::none;
-    return _extractHosts(*result);
+
+    auto hosts = _extractHosts(*result);
+    if (gAdaptiveReplicaSelectionEnabled.load() && hasGlobalServiceContext()) {
+        // Put the host expected to respond soonest first, which is the one targeted by callers
+        // that only use a single host and by the first (non-hedged) request of hedged reads.
+        HostLatencyStats::get(getGlobalServiceContext())->selectHost(&hosts);
+    }
+    return hosts;
 }
 
 boost::optional<std::vector<HostAndPort>> StreamableReplicaSetMonitor::_getHosts(
@@ -589,6 +608,16 @@ void StreamableReplicaSetMonitor::onTopologyDescriptionChangedEvent(
     if (_isDropped.load())
         return;
 
+    // Forget the latencies of the hosts which left the topology.
+    if (hasGlobalServiceContext()) {
+        auto hostLatencyStats = HostLatencyStats::get(getGlobalServiceContext());
+        for (const auto& server : previousDescription->getServers()) {
+            if (!newDescription->findServerByAddress(server->getAddress())) {
+                hostLatencyStats->removeHost(server->getAddress());
+            }
+        }
+    }
+
     // Notify external components if there are membership changes in the topology.
     if (_hasMembershipChange(previousDescription, newDescription)) {
         LOGV2(4333213,
@@ -0,0 +1,210 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/catalog/collection_catalog.h"
+#include "mongo/db/catalog/create_collection.h"
+#include "mongo/db/catalog/drop_collection.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/query/internal_plans.h"
+#include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/db/server_options.h"
+#include "mongo/db/views/materialized_view.h"
+#include "mongo/db/views/materialized_view_catalog.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Creates a materialized view: a collection holding the result of an aggregation over another
+ * collection of the same database, which is kept up to date as that collection is written to.
+ * A materialized view is dropped by deleting its definition from config.materializedViews, after
+ * which its collection is an ordinary collection.
+ */
+class CmdCreateMaterializedView : public BasicCommand {
+public:
+    CmdCreateMaterializedView() : BasicCommand("createMaterializedView") {}
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kNever;
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return true;
+    }
+
+    std::string help() const override {
+        return "{ createMaterializedView: <viewName>, viewOn: <sourceCollectionName>, pipeline: "
+               "[<$match and transformation stages>, { $group: <$sum and $avg fields> }] }";
+    }
+
+    void addRequiredPrivileges(const std::string& dbname,
+                               const BSONObj& cmdObj,
+                               std::vector<Privilege>* out) const override {
+        ActionSet viewActions;
+        viewActions.addAction(ActionType::createCollection);
+        viewActions.addAction(ActionType::insert);
+        viewActions.addAction(ActionType::update);
+        viewActions.addAction(ActionType::remove);
+        out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), viewActions));
+
+        const auto viewOnElem = cmdObj["viewOn"];
+        uassert(ErrorCodes::TypeMismatch,
+                "'viewOn' must be of type String",
+                viewOnElem.type() == BSONType::String);
+        const NamespaceString sourceNss(dbname, viewOnElem.valueStringData());
+        uassert(ErrorCodes::InvalidNamespace,
+                str::stream() << "Invalid source namespace: " << sourceNss.ns(),
+                sourceNss.isValid());
+
+        ActionSet sourceActions;
+        sourceActions.addAction(ActionType::find);
+        out->push_back(Privilege(ResourcePattern::forExactNamespace(sourceNss), sourceActions));
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        uassert(ErrorCodes::CommandNotSupported,
+                "Materialized views are not supported in sharded clusters",
+                serverGlobalParams.clusterRole == ClusterRole::None);
+
+        const auto viewOnElem = cmdObj["viewOn"];
+        const auto pipelineElem = cmdObj["pipeline"];
+        uassert(ErrorCodes::TypeMismatch,
+                "'viewOn' must be of type String",
+                viewOnElem.type() == BSONType::String);
+        uassert(ErrorCodes::TypeMismatch,
+                "'pipeline' must be of type Array",
+                pipelineElem.type() == BSONType::Array);
+
+        std::vector<BSONObj> pipeline;
+        for (auto&& stage : pipelineElem.Obj()) {
+            uassert(ErrorCodes::TypeMismatch,
+                    "Each stage of the pipeline must be an object",
+                    stage.type() == BSONType::Object);
+            pipeline.push_back(stage.Obj().getOwned());
+        }
+
+        const MaterializedView view(CommandHelpers::parseNsCollectionRequired(dbname, cmdObj),
+                                    NamespaceString(dbname, viewOnElem.valueStringData()),
+                                    std::move(pipeline));
+        const auto& viewNss = view.getViewNss();
+        const auto& sourceNss = view.getSourceNss();
+        MaterializedView::Maintainer maintainer(opCtx, view);
+
+        uassert(ErrorCodes::InvalidOptions,
+                str::stream() << "Cannot define a materialized view on the materialized view "
+                              << sourceNss,
+                !MaterializedViewCatalog::get(opCtx)->lookup(sourceNss));
+
+        uassertStatusOK(createCollection(opCtx, dbname, BSON("create" << viewNss.coll())));
+        auto dropViewCollection = makeGuard([&] {
+            BSONObjBuilder unused;
+            dropCollection(opCtx,
+                           viewNss,
+                           unused,
+                           DropCollectionSystemCollectionMode::kDisallowSystemCollectionDrops)
+                .ignore();
+        });
+
+        const auto& definitionsNss = NamespaceString::kMaterializedViewsNamespace;
+        auto status = createCollection(
+            opCtx, definitionsNss.db().toString(), BSON("create" << definitionsNss.coll()));
+        if (status != ErrorCodes::NamespaceExists) {
+            uassertStatusOK(status);
+        }
+
+        {
+            // Holding the source collection in MODE_S until the definition is stored ensures that
+            // no write to it is missed by both the initial computation and the maintenance.
+            AutoGetDb autoDb(opCtx, dbname, MODE_IX);
+            Lock::CollectionLock sourceLock(opCtx, sourceNss, MODE_S);
+            Lock::CollectionLock viewLock(opCtx, viewNss, MODE_IX);
+            AutoGetCollection definitions(opCtx, definitionsNss, MODE_IX);
+
+            uassert(ErrorCodes::NotMaster,
+                    str::stream() << "Not primary while creating materialized view " << viewNss,
+                    repl::ReplicationCoordinator::get(opCtx)->canAcceptWritesFor(opCtx, viewNss));
+
+            const auto& catalog = CollectionCatalog::get(opCtx);
+            auto source = catalog.lookupCollectionByNamespace(opCtx, sourceNss);
+            uassert(ErrorCodes::NamespaceNotFound,
+                    str::stream() << "Source collection " << sourceNss << " does not exist",
+                    source);
+            uassert(ErrorCodes::InvalidOptions,
+                    str::stream() << "The source collection " << sourceNss
+                                  << " of a materialized view must have the recordPreImages "
+                                     "option enabled",
+                    source->getRecordPreImages());
+            uassert(ErrorCodes::InvalidOptions,
+                    str::stream() << "The source collection " << sourceNss
+                                  << " of a materialized view must use the simple collation",
+                    !source->getDefaultCollator());
+
+            auto viewCollection = catalog.lookupCollectionByNamespace(opCtx, viewNss);
+            uassert(ErrorCodes::NamespaceNotFound,
+                    str::stream() << "Materialized view collection " << viewNss
+                                  << " was dropped while the view was being created",
+                    viewCollection);
+            uassert(ErrorCodes::NamespaceNotFound,
+                    str::stream() << definitionsNss << " was dropped while materialized view "
+                                  << viewNss << " was being created",
+                    definitions.getCollection());
+
+            auto exec = InternalPlanner::collectionScan(
+                opCtx, sourceNss.ns(), source, PlanYieldPolicy::YieldPolicy::NO_YIELD);
+            BSONObj doc;
+            while (exec->getNext(&doc, nullptr) == PlanExecutor::ADVANCED) {
+                maintainer.process(doc, 1);
+            }
+
+            writeConflictRetry(opCtx, "createMaterializedView", viewNss.ns(), [&] {
+                WriteUnitOfWork wuow(opCtx);
+                maintainer.write(opCtx, viewCollection);
+                uassertStatusOK(definitions.getCollection()->insertDocument(
+                    opCtx, InsertStatement(view.toBSON()), nullptr));
+                wuow.commit();
+            });
+        }
+
+        dropViewCollection.dismiss();
+        return true;
+    }
+
+} cmdCreateMaterializedView;
+
+}  // namespace
+}  // namespace mongo
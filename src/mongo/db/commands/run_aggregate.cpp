@@ -669,6 +669,12 @@ Status runAggregate(OperationContext* opCtx,
                                                           std::move(attachExecutorCallback.second),
                                                           pipeline.get());
 
+            // An exchange already distributes the pipeline among several cursors, so we only split
+            // up the work of a $group when there is none.
+            if (!request.getExchangeSpec()) {
+                pipeline = PipelineD::parallelizeGroupIfPossible(std::move(pipeline));
+            }
+
             auto pipelines =
                 createExchangePipelinesIfNeeded(opCtx, expCtx, request, std::move(pipeline), uuid);
             for (auto&& pipelineIt : pipelines) {
@@ -72,6 +72,10 @@ public:
         return *_root;
     }
 
+    InclusionNode& getRoot() {
+        return *_root;
+    }
+
     /**
      * Parses the addFields specification given by 'spec', populating internal data structures.
      */
@@ -258,6 +258,22 @@ void ProjectionNode::reportComputedPaths(std::set<std::string>* computedPaths,
     }
 }
 
+void ProjectionNode::visitExpressions(
+    const std::function<void(boost::intrusive_ptr<Expression>*)>& visit) {
+    for (auto&& field : _orderToProcessAdditionsAndChildren) {
+        auto expressionIt = _expressions.find(field);
+        if (expressionIt != _expressions.end()) {
+            visit(&expressionIt->second);
+            continue;
+        }
+
+        auto childIt = _children.find(field);
+        if (childIt != _children.end()) {
+            childIt->second->visitExpressions(visit);
+        }
+    }
+}
+
 void ProjectionNode::optimize() {
     for (auto&& expressionIt : _expressions) {
         _expressions[expressionIt.first] = expressionIt.second->optimize();
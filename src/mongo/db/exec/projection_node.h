@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include "mongo/db/exec/projection_executor.h"
 
 #include "mongo/db/query/projection_policies.h"
@@ -128,6 +130,12 @@ public:
 
     void optimize();
 
+    /**
+     * Calls 'visit' on each computed expression of this node and of its children, in the order in
+     * which they are added to the document. 'visit' may replace the expression it is given.
+     */
+    void visitExpressions(const std::function<void(boost::intrusive_ptr<Expression>*)>& visit);
+
     Document serialize(boost::optional<ExplainOptions::Verbosity> explain) const;
 
     void serialize(boost::optional<ExplainOptions::Verbosity> explain,
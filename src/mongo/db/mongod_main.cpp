@@ -156,6 +156,8 @@
 #include "mongo/db/transaction_participant.h"
 #include "mongo/db/ttl.h"
 #include "mongo/db/unclean_shutdown.h"
+#include "mongo/db/views/materialized_view_catalog.h"
+#include "mongo/db/views/materialized_view_op_observer.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/executor/network_connection_hook.h"
 #include "mongo/executor/network_interface_factory.h"
@@ -577,6 +579,10 @@ ExitCode _initAndListen(ServiceContext* serviceContext, int listenPort) {
     }
     readWriteConcernDefaultsMongodStartupChecks(startupOpCtx.get());
 
+    if (serverGlobalParams.clusterRole == ClusterRole::None) {
+        MaterializedViewCatalog::get(serviceContext)->reload(startupOpCtx.get());
+    }
+
     auto storageEngine = serviceContext->getStorageEngine();
     invariant(storageEngine);
     BackupCursorHooks::initialize(serviceContext, storageEngine);
@@ -993,6 +999,7 @@ void setUpObservers(ServiceContext* serviceContext) {
         opObserverRegistry->addObserver(std::make_unique<ConfigServerOpObserver>());
     } else {
         opObserverRegistry->addObserver(std::make_unique<OpObserverImpl>());
+        opObserverRegistry->addObserver(std::make_unique<MaterializedViewOpObserver>());
     }
     opObserverRegistry->addObserver(std::make_unique<AuthOpObserver>());
 
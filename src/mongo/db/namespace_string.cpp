@@ -89,6 +89,8 @@ const NamespaceString NamespaceString::kConfigSettingsNamespace(NamespaceString:
                                                                 "settings");
 const NamespaceString NamespaceString::kVectorClockNamespace(NamespaceString::kConfigDb,
                                                              "vectorClock");
+const NamespaceString NamespaceString::kMaterializedViewsNamespace(NamespaceString::kConfigDb,
+                                                                   "materializedViews");
 
 
 bool NamespaceString::isListCollectionsCursorNS() const {
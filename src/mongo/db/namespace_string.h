@@ -124,6 +124,9 @@ public:
     // Namespace for vector clock state.
     static const NamespaceString kVectorClockNamespace;
 
+    // Namespace for the definitions of materialized views.
+    static const NamespaceString kMaterializedViewsNamespace;
+
     /**
      * Constructs an empty NamespaceString.
      */
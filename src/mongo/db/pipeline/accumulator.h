@@ -34,12 +34,15 @@
 #include <boost/intrusive_ptr.hpp>
 #include <boost/optional.hpp>
 #include <functional>
+#include <limits>
+#include <memory>
 #include <vector>
 
 #include "mongo/base/init.h"
 #include "mongo/bson/bsontypes.h"
 #include "mongo/db/exec/document_value/value.h"
 #include "mongo/db/exec/document_value/value_comparator.h"
+#include "mongo/db/exec/sort_key_comparator.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/stdx/unordered_set.h"
@@ -47,6 +50,9 @@
 
 namespace mongo {
 
+struct AccumulationExpression;
+class SortKeyGenerator;
+
 /**
  * This enum indicates which documents an accumulator needs to see in order to compute its output.
  */
@@ -370,4 +376,181 @@ private:
     MutableDocument _output;
 };
 
+/**
+ * Estimates the number of distinct values in a group with a HyperLogLog sketch. Up to
+ * 'kMaxSparseHashes' distinct values are counted exactly by remembering their hashes, after which
+ * the hashes are folded into 2^'kPrecision' registers of fixed size. The estimate then has a
+ * standard error of about 1.6%.
+ */
+class AccumulatorApproxCountDistinct final : public AccumulatorState {
+public:
+    static constexpr int kPrecision = 12;
+    static constexpr size_t kNumRegisters = size_t{1} << kPrecision;
+    static constexpr size_t kMaxSparseHashes = kNumRegisters / 16;
+
+    explicit AccumulatorApproxCountDistinct(ExpressionContext* const expCtx);
+
+    void processInternal(const Value& input, bool merging) final;
+    Value getValue(bool toBeMerged) final;
+    const char* getOpName() const final;
+    void reset() final;
+
+    static boost::intrusive_ptr<AccumulatorState> create(ExpressionContext* const expCtx);
+
+    bool isAssociative() const final {
+        return true;
+    }
+
+    bool isCommutative() const final {
+        return true;
+    }
+
+private:
+    void addHash(unsigned long long hash);
+    void addToRegisters(unsigned long long hash);
+    void convertToRegisters();
+
+    // Sorted hashes of the distinct values seen so far, as long as there are few of them.
+    std::vector<unsigned long long> _sparseHashes;
+
+    // The HyperLogLog registers. Empty until '_sparseHashes' grows too large.
+    std::vector<unsigned char> _registers;
+};
+
+/**
+ * Estimates percentiles of the numeric values in a group with a t-digest, which clusters the values
+ * into a bounded number of centroids that are smallest near the extreme percentiles. Non-numeric
+ * values are ignored.
+ *
+ * The syntax is {$approxPercentile: {input: <expression>, p: <number or array of numbers>}}. A
+ * single percentile produces a single number, and an array of percentiles an array of numbers.
+ */
+class AccumulatorApproxPercentile final : public AccumulatorState {
+public:
+    static constexpr auto kAccumulatorName = "$approxPercentile"_sd;
+
+    // Bounds the number of centroids of the digest, and thereby its accuracy and size.
+    static constexpr double kCompression = 100;
+
+    static boost::intrusive_ptr<AccumulatorState> create(ExpressionContext* const expCtx,
+                                                         Value percentiles);
+
+    AccumulatorApproxPercentile(ExpressionContext* const expCtx, Value percentiles);
+
+    void processInternal(const Value& input, bool merging) final;
+    Value getValue(bool toBeMerged) final;
+    const char* getOpName() const final;
+    void reset() final;
+
+    Document serialize(boost::intrusive_ptr<Expression> initializer,
+                       boost::intrusive_ptr<Expression> argument,
+                       bool explain) const final;
+
+    bool isAssociative() const final {
+        return true;
+    }
+
+    bool isCommutative() const final {
+        return true;
+    }
+
+private:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+
+    void add(double mean, double weight);
+    void compress();
+    double quantile(double q) const;
+
+    // Either a number or an array of numbers, each within [0, 1].
+    const Value _percentiles;
+
+    std::vector<Centroid> _centroids;
+    std::vector<Centroid> _unmerged;
+    double _totalWeight = 0;
+    double _min = std::numeric_limits<double>::infinity();
+    double _max = -std::numeric_limits<double>::infinity();
+};
+
+/**
+ * Keeps the values of 'output' for the first ($topN) or last ($bottomN) 'n' documents of a group in
+ * the order given by 'sortBy'. Only 'n' values are ever held, in a heap whose root is the value
+ * which would be evicted next, so that the memory of a group is bounded by 'n' rather than by the
+ * size of the group. Like $push, documents for which 'output' is missing are ignored.
+ *
+ * The syntax is {$topN: {n: <positive integer>, sortBy: <sort pattern>, output: <expression>}}.
+ * The result is an array of the values kept, in the order given by 'sortBy'.
+ */
+class AccumulatorTopBottomN final : public AccumulatorState {
+public:
+    static constexpr auto kTopNName = "$topN"_sd;
+    static constexpr auto kBottomNName = "$bottomN"_sd;
+
+    // The fields of the argument, which pairs the output of a document with the top-level fields
+    // that its sort key is generated from.
+    static constexpr auto kFieldNameOutput = "output"_sd;
+    static constexpr auto kFieldNameSortFields = "sortFields"_sd;
+
+    /**
+     * Builds the accumulation expression of {$topN: {n: 'n', sortBy: 'sortBy', output: 'output'}},
+     * or of a $bottomN if 'bottom' is true. Throws if 'sortBy' is not a valid sort pattern.
+     */
+    static AccumulationExpression makeAccumulationExpression(
+        ExpressionContext* const expCtx,
+        bool bottom,
+        long long n,
+        BSONObj sortBy,
+        boost::intrusive_ptr<Expression> output);
+
+    AccumulatorTopBottomN(ExpressionContext* const expCtx,
+                          bool bottom,
+                          long long n,
+                          BSONObj sortBy,
+                          std::shared_ptr<const SortKeyGenerator> sortKeyGen);
+
+    void processInternal(const Value& input, bool merging) final;
+    Value getValue(bool toBeMerged) final;
+    const char* getOpName() const final;
+    void reset() final;
+
+    Document serialize(boost::intrusive_ptr<Expression> initializer,
+                       boost::intrusive_ptr<Expression> argument,
+                       bool explain) const final;
+
+    bool isAssociative() const final {
+        return true;
+    }
+
+    // Documents with equal sort keys may be kept in any order, as they are by $sort.
+    bool isCommutative() const final {
+        return true;
+    }
+
+private:
+    struct Element {
+        Value sortKey;
+        Value output;
+    };
+
+    /**
+     * Returns whether 'lhs' comes before 'rhs' in the order in which elements are kept, which is
+     * the order of 'sortBy' for a $topN and its reverse for a $bottomN.
+     */
+    bool isBefore(const Element& lhs, const Element& rhs) const;
+
+    void add(Value sortKey, Value output);
+
+    const bool _bottom;
+    const long long _n;
+    const BSONObj _sortBy;
+    const std::shared_ptr<const SortKeyGenerator> _sortKeyGen;
+    const SortKeyComparator _comparator;
+    const int _maxMemUsageBytes;
+
+    // A max-heap with respect to isBefore(), whose root is the element to evict next.
+    std::vector<Element> _heap;
+};
+
 }  // namespace mongo
@@ -0,0 +1,191 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/accumulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/db/exec/document_value/document.h"
+#include "mongo/db/exec/document_value/value.h"
+#include "mongo/db/pipeline/accumulation_statement.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/platform/bits.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+
+REGISTER_ACCUMULATOR(approxCountDistinct,
+                     genericParseSingleExpressionAccumulator<AccumulatorApproxCountDistinct>);
+
+namespace {
+
+/**
+ * Spreads the bits of a Value hash over all 64 bits, as HyperLogLog relies on every bit of the hash
+ * being equally likely to be set. This is the finalizer of MurmurHash3.
+ */
+unsigned long long mixHash(unsigned long long hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb93e53ca4e63ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+}  // namespace
+
+const char* AccumulatorApproxCountDistinct::getOpName() const {
+    return "$approxCountDistinct";
+}
+
+void AccumulatorApproxCountDistinct::processInternal(const Value& input, bool merging) {
+    if (!merging) {
+        if (!input.missing()) {
+            addHash(mixHash(getExpressionContext()->getValueComparator().hash(input)));
+        }
+    } else {
+        // This is what getValue(true) produced below.
+        invariant(input.getType() == Object);
+        const Value hashes = input["hashes"];
+        if (!hashes.missing()) {
+            for (auto&& hash : hashes.getArray()) {
+                addHash(static_cast<unsigned long long>(hash.getLong()));
+            }
+        } else {
+            const BSONBinData registers = input["registers"].getBinData();
+            uassert(4974700,
+                    str::stream() << "$approxCountDistinct cannot merge a sketch of "
+                                  << registers.length << " registers, expected " << kNumRegisters,
+                    static_cast<size_t>(registers.length) == kNumRegisters);
+            convertToRegisters();
+            auto data = static_cast<const unsigned char*>(registers.data);
+            for (size_t i = 0; i < kNumRegisters; ++i) {
+                _registers[i] = std::max(_registers[i], data[i]);
+            }
+        }
+    }
+    _memUsageBytes = sizeof(*this) + _sparseHashes.capacity() * sizeof(unsigned long long) +
+        _registers.capacity();
+}
+
+void AccumulatorApproxCountDistinct::addHash(unsigned long long hash) {
+    if (!_registers.empty()) {
+        addToRegisters(hash);
+        return;
+    }
+
+    auto it = std::lower_bound(_sparseHashes.begin(), _sparseHashes.end(), hash);
+    if (it != _sparseHashes.end() && *it == hash) {
+        return;
+    }
+    _sparseHashes.insert(it, hash);
+    if (_sparseHashes.size() > kMaxSparseHashes) {
+        convertToRegisters();
+    }
+}
+
+void AccumulatorApproxCountDistinct::addToRegisters(unsigned long long hash) {
+    // The first 'kPrecision' bits of the hash select a register, which keeps the largest position
+    // of the first set bit among the remaining bits of the hashes it has seen.
+    const size_t index = hash >> (64 - kPrecision);
+    const unsigned long long remainingBits = hash << kPrecision;
+    const unsigned char rank = remainingBits == 0
+        ? 64 - kPrecision + 1
+        : static_cast<unsigned char>(countLeadingZeros64(remainingBits) + 1);
+    _registers[index] = std::max(_registers[index], rank);
+}
+
+void AccumulatorApproxCountDistinct::convertToRegisters() {
+    if (!_registers.empty()) {
+        return;
+    }
+    _registers.resize(kNumRegisters, 0);
+    for (auto hash : _sparseHashes) {
+        addToRegisters(hash);
+    }
+    _sparseHashes = std::vector<unsigned long long>();
+}
+
+Value AccumulatorApproxCountDistinct::getValue(bool toBeMerged) {
+    if (toBeMerged) {
+        if (_registers.empty()) {
+            std::vector<Value> hashes;
+            hashes.reserve(_sparseHashes.size());
+            for (auto hash : _sparseHashes) {
+                hashes.push_back(Value(static_cast<long long>(hash)));
+            }
+            return Value(DOC("hashes" << Value(std::move(hashes))));
+        }
+        return Value(DOC("registers" << BSONBinData(_registers.data(),
+                                                    static_cast<int>(_registers.size()),
+                                                    BinDataGeneral)));
+    }
+
+    if (_registers.empty()) {
+        return Value(static_cast<long long>(_sparseHashes.size()));
+    }
+
+    // This is the estimate of the original HyperLogLog paper, with its linear counting correction
+    // for small cardinalities. The 64-bit hashes make the correction for large ones unnecessary.
+    const double numRegisters = kNumRegisters;
+    double harmonicSum = 0;
+    size_t numZeroRegisters = 0;
+    for (auto rank : _registers) {
+        harmonicSum += std::ldexp(1.0, -rank);
+        numZeroRegisters += rank == 0;
+    }
+    const double alpha = 0.7213 / (1 + 1.079 / numRegisters);
+    double estimate = alpha * numRegisters * numRegisters / harmonicSum;
+    if (estimate <= 2.5 * numRegisters && numZeroRegisters != 0) {
+        estimate = numRegisters * std::log(numRegisters / numZeroRegisters);
+    }
+    return Value(std::llround(estimate));
+}
+
+AccumulatorApproxCountDistinct::AccumulatorApproxCountDistinct(ExpressionContext* const expCtx)
+    : AccumulatorState(expCtx) {
+    _memUsageBytes = sizeof(*this);
+}
+
+void AccumulatorApproxCountDistinct::reset() {
+    _sparseHashes = std::vector<unsigned long long>();
+    _registers = std::vector<unsigned char>();
+    _memUsageBytes = sizeof(*this);
+}
+
+intrusive_ptr<AccumulatorState> AccumulatorApproxCountDistinct::create(
+    ExpressionContext* const expCtx) {
+    return new AccumulatorApproxCountDistinct(expCtx);
+}
+
+}  // namespace mongo
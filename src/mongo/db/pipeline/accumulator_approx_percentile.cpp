@@ -0,0 +1,280 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/accumulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/db/exec/document_value/document.h"
+#include "mongo/db/exec/document_value/value.h"
+#include "mongo/db/pipeline/accumulation_statement.h"
+#include "mongo/db/pipeline/expression_context.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+
+namespace {
+
+// The number of values which are buffered before they are merged into the centroids.
+constexpr size_t kBufferSize = 5 * static_cast<size_t>(AccumulatorApproxPercentile::kCompression);
+
+void validatePercentile(const Value& percentile) {
+    uassert(4974705,
+            str::stream() << AccumulatorApproxPercentile::kAccumulatorName
+                          << " requires percentiles to be numbers between 0 and 1; found: "
+                          << percentile.toString(),
+            percentile.numeric() && percentile.coerceToDouble() >= 0 &&
+                percentile.coerceToDouble() <= 1);
+}
+
+AccumulationExpression parseApproxPercentile(ExpressionContext* const expCtx,
+                                             BSONElement elem,
+                                             VariablesParseState vps) {
+    const auto kName = AccumulatorApproxPercentile::kAccumulatorName;
+    uassert(4974701,
+            str::stream() << kName << " expects an object as an argument; found: "
+                          << typeName(elem.type()),
+            elem.type() == BSONType::Object);
+
+    intrusive_ptr<Expression> input;
+    Value percentiles;
+    for (auto&& element : elem.embeddedObject()) {
+        auto name = element.fieldNameStringData();
+        if (name == "input") {
+            input = Expression::parseOperand(expCtx, element, vps);
+        } else if (name == "p") {
+            percentiles = Value(element);
+            if (percentiles.isArray()) {
+                uassert(4974702,
+                        str::stream() << kName << " requires at least one percentile",
+                        !percentiles.getArray().empty());
+                for (auto&& percentile : percentiles.getArray()) {
+                    validatePercentile(percentile);
+                }
+            } else {
+                validatePercentile(percentiles);
+            }
+        } else {
+            uasserted(4974703, str::stream() << kName << " got an unexpected field: " << name);
+        }
+    }
+    uassert(4974704, str::stream() << kName << " missing required argument 'input'", input);
+    uassert(4974706,
+            str::stream() << kName << " missing required argument 'p'",
+            !percentiles.missing());
+
+    auto factory = [expCtx, percentiles]() {
+        return AccumulatorApproxPercentile::create(expCtx, percentiles);
+    };
+    auto initializer = ExpressionConstant::create(expCtx, Value(BSONNULL));
+    return {std::move(initializer), std::move(input), std::move(factory)};
+}
+
+}  // namespace
+
+REGISTER_ACCUMULATOR(approxPercentile, parseApproxPercentile);
+
+const char* AccumulatorApproxPercentile::getOpName() const {
+    return kAccumulatorName.rawData();
+}
+
+Document AccumulatorApproxPercentile::serialize(intrusive_ptr<Expression> initializer,
+                                                intrusive_ptr<Expression> argument,
+                                                bool explain) const {
+    return DOC(getOpName() << DOC("input" << argument->serialize(explain) << "p"
+                                          << _percentiles));
+}
+
+void AccumulatorApproxPercentile::processInternal(const Value& input, bool merging) {
+    if (!merging) {
+        // Non-numeric values, and NaN which has no rank, have no impact on the percentiles.
+        if (!input.numeric()) {
+            return;
+        }
+        const double value = input.coerceToDouble();
+        if (std::isnan(value)) {
+            return;
+        }
+        _min = std::min(_min, value);
+        _max = std::max(_max, value);
+        add(value, 1);
+    } else {
+        // This is what getValue(true) produced below.
+        invariant(input.getType() == Object);
+        const auto& means = input["means"].getArray();
+        const auto& weights = input["weights"].getArray();
+        invariant(means.size() == weights.size());
+        if (means.empty()) {
+            return;  // This partition had no data to contribute.
+        }
+        _min = std::min(_min, input["min"].getDouble());
+        _max = std::max(_max, input["max"].getDouble());
+        for (size_t i = 0; i < means.size(); ++i) {
+            add(means[i].getDouble(), weights[i].getDouble());
+        }
+    }
+    _memUsageBytes =
+        sizeof(*this) + (_centroids.capacity() + _unmerged.capacity()) * sizeof(Centroid);
+}
+
+void AccumulatorApproxPercentile::add(double mean, double weight) {
+    _unmerged.push_back({mean, weight});
+    _totalWeight += weight;
+    if (_unmerged.size() >= kBufferSize) {
+        compress();
+    }
+}
+
+void AccumulatorApproxPercentile::compress() {
+    if (_unmerged.empty()) {
+        return;
+    }
+
+    _unmerged.insert(_unmerged.end(), _centroids.begin(), _centroids.end());
+    std::sort(_unmerged.begin(), _unmerged.end(), [](const Centroid& lhs, const Centroid& rhs) {
+        return lhs.mean < rhs.mean;
+    });
+
+    // Neighbouring centroids are merged as long as the merged centroid would not span more than one
+    // unit of the scale function k(q) = compression / (2 * pi) * asin(2q - 1). The function is
+    // steepest at the extremes, which keeps the centroids there small and the percentiles there
+    // accurate. 'weightLimit' is the cumulative weight at which the current unit ends.
+    auto weightLimitAfter = [this](double weightSoFar) {
+        const double q = std::min(weightSoFar / _totalWeight, 1.0);
+        const double k = std::asin(2 * q - 1) + 2 * M_PI / kCompression;
+        return k >= M_PI / 2 ? _totalWeight : _totalWeight * (std::sin(k) + 1) / 2;
+    };
+
+    std::vector<Centroid> merged;
+    double weightSoFar = 0;
+    double weightLimit = weightLimitAfter(weightSoFar);
+    Centroid current = _unmerged.front();
+    for (size_t i = 1; i < _unmerged.size(); ++i) {
+        const Centroid& next = _unmerged[i];
+        if (weightSoFar + current.weight + next.weight <= weightLimit) {
+            current.weight += next.weight;
+            current.mean += (next.mean - current.mean) * next.weight / current.weight;
+        } else {
+            weightSoFar += current.weight;
+            merged.push_back(current);
+            weightLimit = weightLimitAfter(weightSoFar);
+            current = next;
+        }
+    }
+    merged.push_back(current);
+
+    _centroids = std::move(merged);
+    _unmerged.clear();
+}
+
+double AccumulatorApproxPercentile::quantile(double q) const {
+    invariant(!_centroids.empty() && _unmerged.empty());
+
+    // The weight of each centroid is spread evenly around its mean, and the values between the
+    // means of neighbouring centroids are interpolated linearly. The outer halves of the first and
+    // last centroids reach to the smallest and the largest value.
+    const double target = q * _totalWeight;
+    const Centroid& first = _centroids.front();
+    if (target < first.weight / 2) {
+        return _min + (first.mean - _min) * target / (first.weight / 2);
+    }
+
+    double cumulativeWeight = first.weight / 2;
+    for (size_t i = 0; i + 1 < _centroids.size(); ++i) {
+        const Centroid& left = _centroids[i];
+        const Centroid& right = _centroids[i + 1];
+        const double gap = (left.weight + right.weight) / 2;
+        if (target <= cumulativeWeight + gap) {
+            return left.mean + (right.mean - left.mean) * (target - cumulativeWeight) / gap;
+        }
+        cumulativeWeight += gap;
+    }
+
+    const Centroid& last = _centroids.back();
+    const double fraction = std::min((target - cumulativeWeight) / (last.weight / 2), 1.0);
+    return last.mean + (_max - last.mean) * fraction;
+}
+
+Value AccumulatorApproxPercentile::getValue(bool toBeMerged) {
+    compress();
+
+    if (toBeMerged) {
+        std::vector<Value> means;
+        std::vector<Value> weights;
+        means.reserve(_centroids.size());
+        weights.reserve(_centroids.size());
+        for (auto&& centroid : _centroids) {
+            means.push_back(Value(centroid.mean));
+            weights.push_back(Value(centroid.weight));
+        }
+        return Value(DOC("means" << Value(std::move(means)) << "weights"
+                                 << Value(std::move(weights)) << "min" << _min << "max"
+                                 << _max));
+    }
+
+    if (_centroids.empty()) {
+        return Value(BSONNULL);  // Percentiles are not defined without any value.
+    }
+
+    if (!_percentiles.isArray()) {
+        return Value(quantile(_percentiles.coerceToDouble()));
+    }
+    std::vector<Value> results;
+    results.reserve(_percentiles.getArray().size());
+    for (auto&& percentile : _percentiles.getArray()) {
+        results.push_back(Value(quantile(percentile.coerceToDouble())));
+    }
+    return Value(std::move(results));
+}
+
+AccumulatorApproxPercentile::AccumulatorApproxPercentile(ExpressionContext* const expCtx,
+                                                         Value percentiles)
+    : AccumulatorState(expCtx), _percentiles(std::move(percentiles)) {
+    _memUsageBytes = sizeof(*this);
+}
+
+void AccumulatorApproxPercentile::reset() {
+    _centroids = std::vector<Centroid>();
+    _unmerged = std::vector<Centroid>();
+    _totalWeight = 0;
+    _min = std::numeric_limits<double>::infinity();
+    _max = -std::numeric_limits<double>::infinity();
+    _memUsageBytes = sizeof(*this);
+}
+
+intrusive_ptr<AccumulatorState> AccumulatorApproxPercentile::create(ExpressionContext* const expCtx,
+                                                                    Value percentiles) {
+    return new AccumulatorApproxPercentile(expCtx, std::move(percentiles));
+}
+
+}  // namespace mongo
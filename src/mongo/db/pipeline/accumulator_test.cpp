@@ -368,6 +368,224 @@ TEST(Accumulators, PushRespectsMaxMemoryConstraint) {
         ErrorCodes::ExceededMemoryLimit);
 }
 
+TEST(Accumulators, ApproxCountDistinctIsExactForFewValues) {
+    auto expCtx = ExpressionContextForTest{};
+    assertExpectedResults<AccumulatorApproxCountDistinct>(
+        &expCtx,
+        {
+            // No documents evaluated.
+            {{}, Value(0LL)},
+
+            // Equal numbers of different types are not distinct.
+            {{Value(1), Value(1.0), Value(1LL), Value(2)}, Value(2LL)},
+
+            // Null counts as a value, missing does not.
+            {{Value("a"_sd), Value(BSONNULL), Value(), Value("a"_sd)}, Value(2LL)},
+        });
+}
+
+TEST(Accumulators, ApproxCountDistinctRespectsCollation) {
+    auto expCtx = ExpressionContextForTest{};
+    auto collator =
+        std::make_unique<CollatorInterfaceMock>(CollatorInterfaceMock::MockType::kAlwaysEqual);
+    expCtx.setCollator(std::move(collator));
+    assertExpectedResults<AccumulatorApproxCountDistinct>(
+        &expCtx, {{{Value("a"_sd), Value("b"_sd), Value("c"_sd)}, Value(1LL)}});
+}
+
+TEST(Accumulators, ApproxCountDistinctEstimatesManyValuesAndMergesLosslessly) {
+    auto expCtx = ExpressionContextForTest{};
+    const int numValues = 100 * 1000;
+    const int numShards = 4;
+
+    auto accum = AccumulatorApproxCountDistinct::create(&expCtx);
+    std::vector<intrusive_ptr<AccumulatorState>> shards;
+    for (int i = 0; i < numShards; ++i) {
+        shards.push_back(AccumulatorApproxCountDistinct::create(&expCtx));
+    }
+    for (int i = 0; i < numValues; ++i) {
+        // Every value is seen twice, on different shards.
+        accum->process(Value(i), false);
+        accum->process(Value(i), false);
+        shards[i % numShards]->process(Value(i), false);
+        shards[(i + 1) % numShards]->process(Value(i), false);
+    }
+
+    // A shard which saw only a few values sends their hashes rather than its registers.
+    auto smallShard = AccumulatorApproxCountDistinct::create(&expCtx);
+    smallShard->process(Value(0), false);
+    smallShard->process(Value(-1), false);
+    accum->process(Value(-1), false);
+
+    auto merger = AccumulatorApproxCountDistinct::create(&expCtx);
+    for (auto&& shard : shards) {
+        merger->process(shard->getValue(true), true);
+    }
+    merger->process(smallShard->getValue(true), true);
+
+    const long long estimate = accum->getValue(false).getLong();
+    ASSERT_LT(std::abs(estimate - (numValues + 1)), numValues / 20);
+    ASSERT_EQ(merger->getValue(false).getLong(), estimate);
+}
+
+TEST(Accumulators, ApproxPercentileIsExactForFewValues) {
+    auto expCtx = ExpressionContextForTest{};
+    auto percentiles = Value(std::vector<Value>{Value(0), Value(0.5), Value(1)});
+    auto accum = AccumulatorApproxPercentile::create(&expCtx, percentiles);
+    ASSERT_VALUE_EQ(accum->getValue(false), Value(BSONNULL));
+
+    for (auto&& val : {Value(4), Value(2.0), Value("ignored"_sd), Value(5LL), Value(1), Value(3)}) {
+        accum->process(val, false);
+    }
+    ASSERT_VALUE_EQ(accum->getValue(false),
+                    Value(std::vector<Value>{Value(1.0), Value(3.0), Value(5.0)}));
+}
+
+TEST(Accumulators, ApproxPercentileEstimatesManyValuesAcrossShards) {
+    auto expCtx = ExpressionContextForTest{};
+    const int numValues = 100 * 1000;
+    const int numShards = 4;
+    auto percentiles = Value(std::vector<Value>{Value(0), Value(0.01), Value(0.5), Value(0.99)});
+
+    auto accum = AccumulatorApproxPercentile::create(&expCtx, percentiles);
+    std::vector<intrusive_ptr<AccumulatorState>> shards;
+    for (int i = 0; i < numShards; ++i) {
+        shards.push_back(AccumulatorApproxPercentile::create(&expCtx, percentiles));
+    }
+    for (int i = 0; i < numValues; ++i) {
+        // Interleave the values so that the input is not sorted.
+        const int val = (i * 7919) % numValues;
+        accum->process(Value(val), false);
+        shards[i % numShards]->process(Value(val), false);
+    }
+    auto merger = AccumulatorApproxPercentile::create(&expCtx, percentiles);
+    for (auto&& shard : shards) {
+        merger->process(shard->getValue(true), true);
+    }
+
+    for (auto&& result : {accum->getValue(false), merger->getValue(false)}) {
+        const auto& estimates = result.getArray();
+        ASSERT_EQ(estimates.size(), 4U);
+        ASSERT_EQ(estimates[0].getDouble(), 0.0);
+        ASSERT_LT(std::abs(estimates[1].getDouble() - 0.01 * numValues), 0.002 * numValues);
+        ASSERT_LT(std::abs(estimates[2].getDouble() - 0.5 * numValues), 0.01 * numValues);
+        ASSERT_LT(std::abs(estimates[3].getDouble() - 0.99 * numValues), 0.002 * numValues);
+    }
+
+    // The digest stays small however many values it has seen.
+    ASSERT_LT(merger->memUsageForSorter(), 16 * 1024);
+}
+
+TEST(Accumulators, ApproxPercentileParsesAndSerializes) {
+    auto expCtx = ExpressionContextForTest{};
+    auto parse = [&](BSONObj spec) {
+        return AccumulationStatement::parseAccumulationStatement(
+            &expCtx, BSON("x" << spec).firstElement(), expCtx.variablesParseState);
+    };
+
+    auto statement = parse(fromjson("{$approxPercentile: {input: '$a', p: 0.5}}"));
+    ASSERT_DOCUMENT_EQ(statement.makeAccumulator()->serialize(
+                           statement.expr.initializer, statement.expr.argument, false),
+                       Document(fromjson("{$approxPercentile: {input: '$a', p: 0.5}}")));
+    auto accum = statement.makeAccumulator();
+    accum->process(Value(7), false);
+    ASSERT_VALUE_EQ(accum->getValue(false), Value(7.0));
+
+    ASSERT_THROWS_CODE(parse(fromjson("{$approxPercentile: '$a'}")), AssertionException, 4974701);
+    ASSERT_THROWS_CODE(
+        parse(fromjson("{$approxPercentile: {input: '$a', p: []}}")), AssertionException, 4974702);
+    ASSERT_THROWS_CODE(parse(fromjson("{$approxPercentile: {input: '$a', p: 0.5, q: 1}}")),
+                       AssertionException,
+                       4974703);
+    ASSERT_THROWS_CODE(
+        parse(fromjson("{$approxPercentile: {p: 0.5}}")), AssertionException, 4974704);
+    ASSERT_THROWS_CODE(parse(fromjson("{$approxPercentile: {input: '$a', p: [0.5, 1.5]}}")),
+                       AssertionException,
+                       4974705);
+    ASSERT_THROWS_CODE(
+        parse(fromjson("{$approxPercentile: {input: '$a'}}")), AssertionException, 4974706);
+}
+
+TEST(Accumulators, TopNAndBottomNKeepValuesInSortOrder) {
+    auto expCtx = ExpressionContextForTest{};
+    auto parse = [&](BSONObj spec) {
+        return AccumulationStatement::parseAccumulationStatement(
+            &expCtx, BSON("x" << spec).firstElement(), expCtx.variablesParseState);
+    };
+    const std::vector<Document> docs{Document(fromjson("{a: 3, x: 'c'}")),
+                                     Document(fromjson("{a: 1, b: 1, x: 'a2'}")),
+                                     Document(fromjson("{a: 1, b: 2, x: 'a1'}")),
+                                     Document(fromjson("{a: 0}")),
+                                     Document(fromjson("{a: [2, 4], x: 'b'}"))};
+
+    auto top = parse(fromjson("{$topN: {n: 2, sortBy: {a: 1, b: -1}, output: '$x'}}"));
+    auto bottom = parse(fromjson("{$bottomN: {n: 2, sortBy: {a: 1, b: -1}, output: '$x'}}"));
+    for (auto&& [statement, expected] :
+         {std::make_pair(&top, Value(std::vector<Value>{Value("a1"_sd), Value("a2"_sd)})),
+          std::make_pair(&bottom, Value(std::vector<Value>{Value("b"_sd), Value("c"_sd)}))}) {
+        auto accum = statement->makeAccumulator();
+        std::vector<intrusive_ptr<AccumulatorState>> shards{statement->makeAccumulator(),
+                                                            statement->makeAccumulator()};
+        for (size_t i = 0; i < docs.size(); ++i) {
+            auto input = statement->expr.argument->evaluate(docs[i], &expCtx.variables);
+            accum->process(input, false);
+            shards[i % shards.size()]->process(input, false);
+        }
+        ASSERT_VALUE_EQ(accum->getValue(false), expected);
+
+        auto merger = statement->makeAccumulator();
+        for (auto&& shard : shards) {
+            merger->process(shard->getValue(true), true);
+        }
+        ASSERT_VALUE_EQ(merger->getValue(false), expected);
+    }
+}
+
+TEST(Accumulators, TopNParsesAndSerializes) {
+    auto expCtx = ExpressionContextForTest{};
+    auto parse = [&](BSONObj spec) {
+        return AccumulationStatement::parseAccumulationStatement(
+            &expCtx, BSON("x" << spec).firstElement(), expCtx.variablesParseState);
+    };
+
+    auto statement = parse(fromjson("{$topN: {n: 3, sortBy: {a: -1}, output: {v: '$v'}}}"));
+    ASSERT_DOCUMENT_EQ(
+        statement.makeAccumulator()->serialize(
+            statement.expr.initializer, statement.expr.argument, false),
+        Document(fromjson("{$topN: {n: 3, sortBy: {a: -1}, output: {v: '$v'}}}")));
+
+    ASSERT_THROWS_CODE(parse(fromjson("{$topN: '$a'}")), AssertionException, 4975100);
+    ASSERT_THROWS_CODE(parse(fromjson("{$topN: {n: 0, sortBy: {a: 1}, output: '$x'}}")),
+                       AssertionException,
+                       4975101);
+    ASSERT_THROWS_CODE(parse(fromjson("{$topN: {n: 1.5, sortBy: {a: 1}, output: '$x'}}")),
+                       AssertionException,
+                       4975101);
+    ASSERT_THROWS_CODE(parse(fromjson("{$topN: {n: 1, sortBy: 'a', output: '$x'}}")),
+                       AssertionException,
+                       4975102);
+    ASSERT_THROWS_CODE(parse(fromjson("{$topN: {n: 1, sortBy: {a: 1}, output: '$x', y: 1}}")),
+                       AssertionException,
+                       4975103);
+    ASSERT_THROWS_CODE(
+        parse(fromjson("{$bottomN: {sortBy: {a: 1}, output: '$x'}}")), AssertionException, 4975104);
+    ASSERT_THROWS_CODE(
+        parse(fromjson("{$bottomN: {n: 1, output: '$x'}}")), AssertionException, 4975105);
+    ASSERT_THROWS_CODE(
+        parse(fromjson("{$bottomN: {n: 1, sortBy: {a: 1}}}")), AssertionException, 4975106);
+    ASSERT_THROWS_CODE(
+        parse(fromjson("{$topN: {n: 1, sortBy: {s: {$meta: 'textScore'}}, output: '$x'}}")),
+        AssertionException,
+        4975107);
+
+    // Nodes which may have to run this pipeline before they are upgraded cannot parse $topN.
+    expCtx.maxFeatureCompatibilityVersion =
+        ServerGlobalParams::FeatureCompatibility::Version::kFullyDowngradedTo44;
+    ASSERT_THROWS_CODE(parse(fromjson("{$topN: {n: 1, sortBy: {a: 1}, output: '$x'}}")),
+                       AssertionException,
+                       ErrorCodes::QueryFeatureNotAllowed);
+}
+
 /* ------------------------- AccumulatorMergeObjects -------------------------- */
 
 TEST(AccumulatorMergeObjects, MergingZeroObjectsShouldReturnEmptyDocument) {
@@ -0,0 +1,272 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/accumulator.h"
+
+#include <algorithm>
+
+#include "mongo/db/exec/document_value/document.h"
+#include "mongo/db/exec/document_value/value.h"
+#include "mongo/db/index/sort_key_generator.h"
+#include "mongo/db/pipeline/accumulation_statement.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/sort_pattern.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+
+namespace {
+
+// The fields of each element of a partial result.
+constexpr auto kFieldNameSortKey = "sortKey"_sd;
+
+AccumulationExpression parseTopBottomN(ExpressionContext* const expCtx,
+                                       BSONElement elem,
+                                       VariablesParseState vps,
+                                       bool bottom) {
+    const auto name = bottom ? AccumulatorTopBottomN::kBottomNName
+                             : AccumulatorTopBottomN::kTopNName;
+    uassert(4975100,
+            str::stream() << name << " expects an object as an argument; found: "
+                          << typeName(elem.type()),
+            elem.type() == BSONType::Object);
+
+    boost::optional<long long> n;
+    BSONObj sortBy;
+    intrusive_ptr<Expression> output;
+    for (auto&& element : elem.embeddedObject()) {
+        auto fieldName = element.fieldNameStringData();
+        if (fieldName == "n") {
+            Value value(element);
+            uassert(4975101,
+                    str::stream() << name << " requires 'n' to be a positive integer; found: "
+                                  << value.toString(),
+                    value.integral64Bit() && value.coerceToLong() > 0);
+            n = value.coerceToLong();
+        } else if (fieldName == "sortBy") {
+            uassert(4975102,
+                    str::stream() << name << " requires 'sortBy' to be an object; found: "
+                                  << typeName(element.type()),
+                    element.type() == BSONType::Object);
+            sortBy = element.embeddedObject().getOwned();
+        } else if (fieldName == AccumulatorTopBottomN::kFieldNameOutput) {
+            output = Expression::parseOperand(expCtx, element, vps);
+        } else {
+            uasserted(4975103, str::stream() << name << " got an unexpected field: " << fieldName);
+        }
+    }
+    uassert(4975104, str::stream() << name << " missing required argument 'n'", n);
+    uassert(4975105,
+            str::stream() << name << " missing required argument 'sortBy'",
+            !sortBy.isEmpty());
+    uassert(4975106, str::stream() << name << " missing required argument 'output'", output);
+
+    return AccumulatorTopBottomN::makeAccumulationExpression(
+        expCtx, bottom, *n, std::move(sortBy), std::move(output));
+}
+
+AccumulationExpression parseTopN(ExpressionContext* const expCtx,
+                                 BSONElement elem,
+                                 VariablesParseState vps) {
+    return parseTopBottomN(expCtx, elem, std::move(vps), false);
+}
+
+AccumulationExpression parseBottomN(ExpressionContext* const expCtx,
+                                    BSONElement elem,
+                                    VariablesParseState vps) {
+    return parseTopBottomN(expCtx, elem, std::move(vps), true);
+}
+
+}  // namespace
+
+REGISTER_ACCUMULATOR_WITH_MIN_VERSION(
+    topN, parseTopN, ServerGlobalParams::FeatureCompatibility::Version::kVersion451);
+REGISTER_ACCUMULATOR_WITH_MIN_VERSION(
+    bottomN, parseBottomN, ServerGlobalParams::FeatureCompatibility::Version::kVersion451);
+
+AccumulationExpression AccumulatorTopBottomN::makeAccumulationExpression(
+    ExpressionContext* const expCtx,
+    bool bottom,
+    long long n,
+    BSONObj sortBy,
+    intrusive_ptr<Expression> output) {
+    SortPattern sortPattern(sortBy, intrusive_ptr<ExpressionContext>(expCtx));
+
+    // The sort key of a document is generated from the top-level fields of its sort paths alone,
+    // which is all the argument needs to carry besides the output.
+    std::vector<std::pair<std::string, intrusive_ptr<Expression>>> sortFields;
+    for (auto&& part : sortPattern) {
+        uassert(4975107,
+                str::stream() << (bottom ? kBottomNName : kTopNName)
+                              << " does not support $meta in 'sortBy'",
+                part.fieldPath);
+        auto fieldName = part.fieldPath->getFieldName(0).toString();
+        if (std::none_of(sortFields.begin(), sortFields.end(), [&](const auto& field) {
+                return field.first == fieldName;
+            })) {
+            sortFields.emplace_back(fieldName, ExpressionFieldPath::create(expCtx, fieldName));
+        }
+    }
+
+    std::vector<std::pair<std::string, intrusive_ptr<Expression>>> fields;
+    fields.emplace_back(kFieldNameOutput.toString(), std::move(output));
+    fields.emplace_back(kFieldNameSortFields.toString(),
+                        ExpressionObject::create(expCtx, std::move(sortFields)));
+    auto argument = ExpressionObject::create(expCtx, std::move(fields));
+
+    auto sortKeyGen =
+        std::make_shared<const SortKeyGenerator>(std::move(sortPattern), expCtx->getCollator());
+    auto factory = [expCtx, bottom, n, sortBy, sortKeyGen]() -> intrusive_ptr<AccumulatorState> {
+        return new AccumulatorTopBottomN(expCtx, bottom, n, sortBy, sortKeyGen);
+    };
+    auto initializer = ExpressionConstant::create(expCtx, Value(BSONNULL));
+    return {std::move(initializer), std::move(argument), std::move(factory)};
+}
+
+AccumulatorTopBottomN::AccumulatorTopBottomN(ExpressionContext* const expCtx,
+                                             bool bottom,
+                                             long long n,
+                                             BSONObj sortBy,
+                                             std::shared_ptr<const SortKeyGenerator> sortKeyGen)
+    : AccumulatorState(expCtx),
+      _bottom(bottom),
+      _n(n),
+      _sortBy(std::move(sortBy)),
+      _sortKeyGen(std::move(sortKeyGen)),
+      _comparator(_sortBy),
+      _maxMemUsageBytes(internalQueryMaxPushBytes.load()) {
+    _memUsageBytes = sizeof(*this);
+}
+
+const char* AccumulatorTopBottomN::getOpName() const {
+    return (_bottom ? kBottomNName : kTopNName).rawData();
+}
+
+Document AccumulatorTopBottomN::serialize(intrusive_ptr<Expression> initializer,
+                                          intrusive_ptr<Expression> argument,
+                                          bool explain) const {
+    // The argument of a merging $group is the field holding the partial results instead.
+    auto output = argument;
+    if (auto object = dynamic_cast<ExpressionObject*>(argument.get())) {
+        for (auto&& [fieldName, child] : object->getChildExpressions()) {
+            if (fieldName == kFieldNameOutput) {
+                output = child;
+            }
+        }
+    }
+    return DOC(getOpName() << DOC("n" << _n << "sortBy" << _sortBy << kFieldNameOutput
+                                      << output->serialize(explain)));
+}
+
+bool AccumulatorTopBottomN::isBefore(const Element& lhs, const Element& rhs) const {
+    const int cmp = _comparator(lhs.sortKey, rhs.sortKey);
+    return _bottom ? cmp > 0 : cmp < 0;
+}
+
+void AccumulatorTopBottomN::add(Value sortKey, Value output) {
+    Element element{std::move(sortKey), std::move(output)};
+    auto isBefore = [this](const Element& lhs, const Element& rhs) {
+        return this->isBefore(lhs, rhs);
+    };
+
+    if (_heap.size() == static_cast<size_t>(_n)) {
+        if (!isBefore(element, _heap.front())) {
+            return;
+        }
+        std::pop_heap(_heap.begin(), _heap.end(), isBefore);
+        _memUsageBytes -=
+            _heap.back().sortKey.getApproximateSize() + _heap.back().output.getApproximateSize();
+        _heap.pop_back();
+    }
+
+    _memUsageBytes += element.sortKey.getApproximateSize() + element.output.getApproximateSize();
+    uassert(ErrorCodes::ExceededMemoryLimit,
+            str::stream() << getOpName()
+                          << " used too much memory and cannot spill to disk. Memory limit: "
+                          << _maxMemUsageBytes << " bytes",
+            _memUsageBytes < _maxMemUsageBytes);
+    _heap.push_back(std::move(element));
+    std::push_heap(_heap.begin(), _heap.end(), isBefore);
+}
+
+void AccumulatorTopBottomN::processInternal(const Value& input, bool merging) {
+    if (!merging) {
+        auto output = input[kFieldNameOutput];
+        if (output.missing()) {
+            return;
+        }
+        add(_sortKeyGen->computeSortKeyFromDocument(input[kFieldNameSortFields].getDocument()),
+            std::move(output));
+        return;
+    }
+
+    // This is what getValue(true) produced below. A merging $group which was parsed back from its
+    // serialized form wraps it into the argument object, as the output.
+    const Value partial = input.getType() == Object ? input[kFieldNameOutput] : input;
+    invariant(partial.getType() == Array);
+    for (auto&& element : partial.getArray()) {
+        add(element[kFieldNameSortKey], element[kFieldNameOutput]);
+    }
+}
+
+Value AccumulatorTopBottomN::getValue(bool toBeMerged) {
+    std::vector<Value> result;
+    result.reserve(_heap.size());
+    if (toBeMerged) {
+        for (auto&& element : _heap) {
+            result.emplace_back(
+                Document{{kFieldNameSortKey, element.sortKey}, {kFieldNameOutput, element.output}});
+        }
+        return Value(std::move(result));
+    }
+
+    auto sorted = _heap;
+    std::sort(sorted.begin(), sorted.end(), [this](const Element& lhs, const Element& rhs) {
+        return isBefore(lhs, rhs);
+    });
+    if (_bottom) {
+        // The elements of a $bottomN are kept in reverse order.
+        std::reverse(sorted.begin(), sorted.end());
+    }
+    for (auto&& element : sorted) {
+        result.push_back(element.output);
+    }
+    return Value(std::move(result));
+}
+
+void AccumulatorTopBottomN::reset() {
+    std::vector<Element>().swap(_heap);
+    _memUsageBytes = sizeof(*this);
+}
+
+}  // namespace mongo
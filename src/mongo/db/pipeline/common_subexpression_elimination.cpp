@@ -0,0 +1,458 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/common_subexpression_elimination.h"
+
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mongo/db/exec/add_fields_projection_executor.h"
+#include "mongo/db/exec/inclusion_projection_executor.h"
+#include "mongo/db/matcher/expression_algo.h"
+#include "mongo/db/pipeline/document_source_add_fields.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/document_source_match.h"
+#include "mongo/db/pipeline/document_source_single_document_transformation.h"
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/expression_function.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+
+using ExpressionSlot = boost::intrusive_ptr<Expression>*;
+using TransformerType = TransformerInterface::TransformerType;
+
+// The prefix of the internal fields holding the values of the rewritten expressions.
+constexpr StringData kFieldPrefix = "__cse"_sd;
+
+/**
+ * Returns how many of the leading arguments of 'expr' it evaluates for every document. Taking an
+ * argument out of an expression which only evaluates it under some condition would evaluate it,
+ * and possibly fail, for documents which never needed it.
+ */
+size_t numUnconditionalArguments(const Expression* expr) {
+    if (dynamic_cast<const ExpressionAnd*>(expr) || dynamic_cast<const ExpressionOr*>(expr) ||
+        dynamic_cast<const ExpressionCond*>(expr) || dynamic_cast<const ExpressionIfNull*>(expr)) {
+        return 1;
+    }
+    if (dynamic_cast<const ExpressionDateToString*>(expr)) {
+        // The last argument, 'onNull', is only evaluated when the date is null or missing.
+        return expr->getChildren().size() - 1;
+    }
+    if (dynamic_cast<const ExpressionSwitch*>(expr) || dynamic_cast<const ExpressionZip*>(expr) ||
+        dynamic_cast<const ExpressionMap*>(expr) || dynamic_cast<const ExpressionFilter*>(expr) ||
+        dynamic_cast<const ExpressionReduce*>(expr) ||
+        dynamic_cast<const ExpressionDateFromString*>(expr) ||
+        dynamic_cast<const ExpressionConvert*>(expr)) {
+        return 0;
+    }
+    return expr->getChildren().size();
+}
+
+bool isDeterministic(const Expression* expr) {
+    if (dynamic_cast<const ExpressionRandom*>(expr) ||
+        dynamic_cast<const ExpressionFunction*>(expr)) {
+        return false;
+    }
+    for (auto&& child : expr->getChildren()) {
+        if (child && !isDeterministic(child.get())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns whether 'expr' is a single arithmetic or comparison operator over field paths and
+ * constants. Evaluating it again costs less than the extra $addFields computing it into a field.
+ */
+bool isCheap(const Expression* expr) {
+    if (!dynamic_cast<const ExpressionAdd*>(expr) &&
+        !dynamic_cast<const ExpressionSubtract*>(expr) &&
+        !dynamic_cast<const ExpressionMultiply*>(expr) &&
+        !dynamic_cast<const ExpressionCompare*>(expr) &&
+        !dynamic_cast<const ExpressionNot*>(expr)) {
+        return false;
+    }
+    for (auto&& child : expr->getChildren()) {
+        if (!dynamic_cast<const ExpressionFieldPath*>(child.get()) &&
+            !dynamic_cast<const ExpressionConstant*>(child.get())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isRunStage(const DocumentSource* stage) {
+    if (dynamic_cast<const DocumentSourceMatch*>(stage)) {
+        return true;
+    }
+    auto transformation = dynamic_cast<const DocumentSourceSingleDocumentTransformation*>(stage);
+    return transformation && transformation->getType() == TransformerType::kComputedProjection;
+}
+
+bool isRunEnd(const DocumentSource* stage) {
+    if (dynamic_cast<const DocumentSourceGroup*>(stage)) {
+        return true;
+    }
+    auto transformation = dynamic_cast<const DocumentSourceSingleDocumentTransformation*>(stage);
+    return transformation && transformation->getType() == TransformerType::kInclusionProjection;
+}
+
+/**
+ * Returns whether reading the fields 'fields' reads any of the paths 'paths' or their subfields.
+ */
+bool readsAnyOf(const std::set<std::string>& fields, const std::set<std::string>& paths) {
+    for (auto&& field : fields) {
+        for (auto&& path : paths) {
+            if (field == path || expression::isPathPrefixOf(field, path) ||
+                expression::isPathPrefixOf(path, field)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * Eliminates the common subexpressions of one run of stages, from 'begin' to 'end' inclusive.
+ */
+class RunRewriter {
+public:
+    RunRewriter(Pipeline::SourceContainer* container,
+                const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                size_t* nextFieldId)
+        : _container(container), _expCtx(expCtx), _nextFieldId(nextFieldId) {}
+
+    void rewrite(Pipeline::SourceContainer::iterator begin,
+                 Pipeline::SourceContainer::iterator end) {
+        for (auto it = begin;; ++it) {
+            if (!addStage(it)) {
+                return;
+            }
+            if (it == end) {
+                break;
+            }
+        }
+
+        countOccurrences();
+        chooseExpressions();
+        if (_chosen.empty()) {
+            return;
+        }
+        replaceOccurrences();
+    }
+
+private:
+    struct Stage {
+        Pipeline::SourceContainer::iterator it;
+
+        // The expression of a $match whose predicate is a single $expr. The stage is rebuilt from
+        // it if it gets rewritten, so that its predicate remains in sync with its expression.
+        boost::intrusive_ptr<Expression> matchExpression;
+
+        // Whether any expression of this stage was replaced.
+        bool rewritten = false;
+    };
+
+    /**
+     * Adds the stage at 'it' to the run. Returns false if the internal fields would be visible
+     * to the run, which cannot be rewritten then.
+     */
+    bool addStage(Pipeline::SourceContainer::iterator it) {
+        DepsTracker deps;
+        (*it)->getDependencies(&deps);
+        if (deps.needWholeDocument) {
+            return false;
+        }
+        for (auto&& field : deps.fields) {
+            if (StringData(field).startsWith(kFieldPrefix)) {
+                return false;
+            }
+        }
+        auto modifiedPaths = (*it)->getModifiedPaths();
+        for (auto&& path : modifiedPaths.paths) {
+            if (StringData(path).startsWith(kFieldPrefix)) {
+                return false;
+            }
+        }
+
+        Stage stage{it};
+        // A leading $match may be pushed down to the query layer, in front of any stage, so its
+        // expression is left alone.
+        auto match = dynamic_cast<DocumentSourceMatch*>(it->get());
+        if (match && it != _container->begin()) {
+            auto query = match->getQuery();
+            if (query.nFields() == 1 && query.firstElementFieldNameStringData() == "$expr"_sd) {
+                stage.matchExpression =
+                    Expression::parseOperand(
+                        _expCtx.get(), query.firstElement(), _expCtx->variablesParseState)
+                        ->optimize();
+            }
+        }
+        _stages.push_back(std::move(stage));
+        return true;
+    }
+
+    void visitStageExpressions(Stage& stage, const std::function<void(ExpressionSlot)>& visit) {
+        auto source = stage.it->get();
+        if (dynamic_cast<DocumentSourceMatch*>(source)) {
+            if (stage.matchExpression) {
+                visit(&stage.matchExpression);
+            }
+        } else if (auto group = dynamic_cast<DocumentSourceGroup*>(source)) {
+            group->visitInputExpressions(visit);
+        } else {
+            auto transformation = static_cast<DocumentSourceSingleDocumentTransformation*>(source);
+            if (transformation->getType() == TransformerType::kComputedProjection) {
+                static_cast<projection_executor::AddFieldsProjectionExecutor&>(
+                    transformation->getTransformer())
+                    .getRoot()
+                    .visitExpressions(visit);
+            } else if (transformation->getType() == TransformerType::kInclusionProjection) {
+                static_cast<projection_executor::InclusionProjectionExecutor&>(
+                    transformation->getTransformer())
+                    .getRoot()
+                    ->visitExpressions(visit);
+            }
+        }
+    }
+
+    /**
+     * Returns whether 'expr' may be computed into an internal field.
+     */
+    bool isCandidate(Expression* expr, DepsTracker* deps) {
+        if (dynamic_cast<ExpressionConstant*>(expr) || dynamic_cast<ExpressionFieldPath*>(expr) ||
+            isCheap(expr) || !isDeterministic(expr)) {
+            return false;
+        }
+        expr->addDependencies(deps);
+        return !deps->needWholeDocument && deps->vars.empty();
+    }
+
+    /**
+     * Identifies each candidate subexpression by its serialization and the number of times a
+     * field it reads was modified before it, and counts the occurrences of each.
+     */
+    void countOccurrences() {
+        std::map<std::string, std::set<std::string>> fieldsByKey;
+        std::map<std::string, int> generations;
+
+        std::function<void(ExpressionSlot)> count = [&](ExpressionSlot slot) {
+            auto expr = slot->get();
+            if (!expr) {
+                return;
+            }
+
+            DepsTracker deps;
+            if (isCandidate(expr, &deps)) {
+                BSONObjBuilder builder;
+                expr->serialize(false).addToBsonObj(&builder, "");
+                auto serialized = builder.obj();
+                std::string key(serialized.objdata(), serialized.objsize());
+
+                std::string id = str::stream() << generations[key] << ':' << key;
+                _ids[expr] = id;
+                ++_counts[id];
+                fieldsByKey[key] = std::move(deps.fields);
+            }
+
+            auto& children = expr->getChildren();
+            const auto numChildren = numUnconditionalArguments(expr);
+            for (size_t i = 0; i < numChildren; ++i) {
+                count(&children[i]);
+            }
+        };
+
+        for (auto&& stage : _stages) {
+            visitStageExpressions(stage, count);
+
+            // An expression which reads a field modified by this stage has a different value in
+            // the stages which follow.
+            auto modifiedPaths = stage.it->get()->getModifiedPaths();
+            auto& paths = modifiedPaths.paths;
+            for (auto&& rename : modifiedPaths.renames) {
+                paths.insert(rename.first);
+            }
+            const bool modifiesAnyPath =
+                modifiedPaths.type != DocumentSource::GetModPathsReturn::Type::kFiniteSet;
+            for (auto&& [key, fields] : fieldsByKey) {
+                if (modifiesAnyPath || readsAnyOf(fields, paths)) {
+                    ++generations[key];
+                }
+            }
+        }
+    }
+
+    /**
+     * Walks the expressions of the run without descending into the chosen ones, calling 'onChosen'
+     * with the index of the stage and the slot of each occurrence of a chosen expression reached.
+     */
+    void walkChosen(
+        const std::function<void(size_t, ExpressionSlot, const std::string&)>& onChosen) {
+        for (size_t stageIndex = 0; stageIndex < _stages.size(); ++stageIndex) {
+            std::function<void(ExpressionSlot)> walk = [&](ExpressionSlot slot) {
+                auto expr = slot->get();
+                if (!expr) {
+                    return;
+                }
+
+                auto idIt = _ids.find(expr);
+                if (idIt != _ids.end() && _chosen.count(idIt->second)) {
+                    onChosen(stageIndex, slot, idIt->second);
+                    return;
+                }
+
+                auto& children = expr->getChildren();
+                const auto numChildren = numUnconditionalArguments(expr);
+                for (size_t i = 0; i < numChildren; ++i) {
+                    walk(&children[i]);
+                }
+            };
+            visitStageExpressions(_stages[stageIndex], walk);
+        }
+    }
+
+    /**
+     * Chooses the expressions to compute into internal fields: those which are still evaluated at
+     * least twice once the occurrences nested in other chosen expressions are left alone, and
+     * which are first evaluated by a stage the internal fields can be computed before.
+     */
+    void chooseExpressions() {
+        for (auto&& [id, count] : _counts) {
+            if (count >= 2) {
+                _chosen.insert(id);
+            }
+        }
+
+        // Rejecting an expression exposes the occurrences nested in it, so repeat until no more
+        // expressions are rejected.
+        bool rejectedAny = true;
+        while (rejectedAny) {
+            std::map<std::string, int> reached;
+            walkChosen([&](size_t, ExpressionSlot, const std::string& id) { ++reached[id]; });
+
+            rejectedAny = false;
+            for (auto it = _chosen.begin(); it != _chosen.end();) {
+                if (reached[*it] < 2) {
+                    it = _chosen.erase(it);
+                    rejectedAny = true;
+                } else {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    void replaceOccurrences() {
+        std::map<std::string, std::string> fieldNames;
+        std::vector<BSONObjBuilder> computedFields(_stages.size());
+        walkChosen([&](size_t stageIndex, ExpressionSlot slot, const std::string& id) {
+            auto fieldNameIt = fieldNames.find(id);
+            if (fieldNameIt == fieldNames.end()) {
+                std::string fieldName = str::stream() << kFieldPrefix << '_' << (*_nextFieldId)++;
+                auto serialized = (*slot)->serialize(false);
+                if (dynamic_cast<ExpressionObject*>(slot->get())) {
+                    // $addFields would parse an object literal as a nested projection, which merges
+                    // into an existing field of the same name rather than replace it.
+                    serialized = Value(DOC("$mergeObjects" << DOC_ARRAY(serialized)));
+                }
+                serialized.addToBsonObj(&computedFields[stageIndex], fieldName);
+                fieldNameIt = fieldNames.emplace(id, fieldName).first;
+            }
+            *slot = ExpressionFieldPath::create(_expCtx.get(), fieldNameIt->second);
+            _stages[stageIndex].rewritten = true;
+        });
+
+        for (size_t stageIndex = 0; stageIndex < _stages.size(); ++stageIndex) {
+            auto& stage = _stages[stageIndex];
+            if (stage.matchExpression && stage.rewritten) {
+                *stage.it = DocumentSourceMatch::create(
+                                BSON("$expr" << stage.matchExpression->serialize(false)), _expCtx)
+                                ->optimize();
+            }
+
+            auto spec = computedFields[stageIndex].obj();
+            if (!spec.isEmpty()) {
+                _container->insert(stage.it, DocumentSourceAddFields::create(spec, _expCtx));
+            }
+        }
+    }
+
+    Pipeline::SourceContainer* _container;
+    boost::intrusive_ptr<ExpressionContext> _expCtx;
+    size_t* _nextFieldId;
+
+    std::vector<Stage> _stages;
+
+    // The identifier of each candidate subexpression, and the number of occurrences of each.
+    stdx::unordered_map<const Expression*, std::string> _ids;
+    std::map<std::string, int> _counts;
+
+    // The identifiers of the subexpressions to compute into internal fields.
+    std::set<std::string> _chosen;
+};
+
+}  // namespace
+
+void eliminateCommonSubexpressions(Pipeline::SourceContainer* container,
+                                   const boost::intrusive_ptr<ExpressionContext>& expCtx) {
+    if (!internalPipelineEliminateCommonSubexpressions.load()) {
+        return;
+    }
+
+    size_t nextFieldId = 0;
+    for (auto end = container->begin(); end != container->end(); ++end) {
+        if (!isRunEnd(end->get())) {
+            continue;
+        }
+
+        auto begin = end;
+        while (begin != container->begin() && isRunStage(std::prev(begin)->get())) {
+            --begin;
+        }
+
+        // A $group can share expressions between its own _id and accumulators, while a $project
+        // needs stages before it to share them with.
+        if (begin != end || dynamic_cast<DocumentSourceGroup*>(end->get())) {
+            RunRewriter(container, expCtx, &nextFieldId).rewrite(begin, end);
+        }
+    }
+}
+
+}  // namespace mongo
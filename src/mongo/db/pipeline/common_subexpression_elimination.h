@@ -0,0 +1,55 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/intrusive_ptr.hpp>
+
+#include "mongo/db/pipeline/pipeline.h"
+
+namespace mongo {
+
+class ExpressionContext;
+
+/**
+ * Finds the runs of $addFields and $match stages which end in a $group or an inclusion $project,
+ * and makes each expression that such a run evaluates several times for the same document be
+ * evaluated only once: a new $addFields stage stores its value in an internal field right before
+ * the stage which first evaluates it, and every occurrence is replaced with a reference to that
+ * field. The $group or $project which ends the run discards the internal fields.
+ *
+ * Only expressions which are deterministic, which do not refer to variables other than the
+ * current document and the system variables, and which each stage evaluates for every document
+ * rather than conditionally, are rewritten. Two occurrences are only treated as the same
+ * expression when no stage between them modifies a field that the expression reads.
+ */
+void eliminateCommonSubexpressions(Pipeline::SourceContainer* container,
+                                   const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
+}  // namespace mongo
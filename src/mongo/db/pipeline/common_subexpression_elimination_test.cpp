@@ -0,0 +1,204 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <deque>
+#include <vector>
+
+#include "mongo/bson/json.h"
+#include "mongo/db/exec/document_value/document.h"
+#include "mongo/db/exec/document_value/document_value_test_util.h"
+#include "mongo/db/pipeline/aggregation_context_fixture.h"
+#include "mongo/db/pipeline/document_source_mock.h"
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+class CommonSubexpressionEliminationTest : public AggregationContextFixture {
+protected:
+    std::unique_ptr<Pipeline, PipelineDeleter> makeOptimizedPipeline(const std::string& json,
+                                                                     bool eliminate) {
+        const auto original = internalPipelineEliminateCommonSubexpressions.load();
+        internalPipelineEliminateCommonSubexpressions.store(eliminate);
+        ON_BLOCK_EXIT([&] { internalPipelineEliminateCommonSubexpressions.store(original); });
+
+        std::vector<BSONObj> rawPipeline;
+        for (auto&& stage : fromjson("{pipeline: " + json + "}")["pipeline"].Array()) {
+            rawPipeline.push_back(stage.Obj().getOwned());
+        }
+        auto pipeline = Pipeline::parse(rawPipeline, getExpCtx());
+        pipeline->optimizePipeline();
+        return pipeline;
+    }
+
+    /**
+     * Asserts that 'input' optimizes to the pipeline 'expected' would optimize to without the
+     * elimination of common subexpressions.
+     */
+    void assertOptimizesTo(const std::string& input, const std::string& expected) {
+        ASSERT_VALUE_EQ(Value(makeOptimizedPipeline(input, true)->serialize()),
+                        Value(makeOptimizedPipeline(expected, false)->serialize()));
+    }
+
+    void assertUnchanged(const std::string& input) {
+        assertOptimizesTo(input, input);
+    }
+
+    std::vector<Document> execute(const std::string& json,
+                                  const std::vector<Document>& inputs,
+                                  bool eliminate) {
+        auto pipeline = makeOptimizedPipeline(json, eliminate);
+        std::deque<DocumentSource::GetNextResult> results;
+        for (auto&& input : inputs) {
+            results.emplace_back(Document(input));
+        }
+        pipeline->addInitialSource(DocumentSourceMock::createForTest(results, getExpCtx()));
+
+        std::vector<Document> outputs;
+        while (auto next = pipeline->getNext()) {
+            outputs.push_back(*next);
+        }
+        return outputs;
+    }
+};
+
+TEST_F(CommonSubexpressionEliminationTest, SharesExpressionRepeatedWithinGroup) {
+    assertOptimizesTo(
+        "[{$group: {_id: {$toUpper: '$name'}, first: {$first: {$toUpper: '$name'}}}}]",
+        "[{$addFields: {__cse_0: {$toUpper: '$name'}}},"
+        " {$group: {_id: '$__cse_0', first: {$first: '$__cse_0'}}}]");
+}
+
+TEST_F(CommonSubexpressionEliminationTest, SharesExpressionRepeatedAcrossStages) {
+    assertOptimizesTo(
+        "[{$addFields: {upper: {$toUpper: '$name'}}},"
+        " {$match: {$expr: {$eq: [{$toUpper: '$name'}, '$upper']}}},"
+        " {$group: {_id: {$toUpper: '$name'}, n: {$sum: 1}}}]",
+        "[{$addFields: {__cse_0: {$toUpper: '$name'}}},"
+        " {$addFields: {upper: '$__cse_0'}},"
+        " {$match: {$expr: {$eq: ['$__cse_0', '$upper']}}},"
+        " {$group: {_id: '$__cse_0', n: {$sum: 1}}}]");
+}
+
+TEST_F(CommonSubexpressionEliminationTest, SharesOutermostRepeatedExpression) {
+    assertOptimizesTo(
+        "[{$addFields: {a: {$strLenCP: {$toUpper: '$name'}}}},"
+        " {$project: {_id: 0, a: 1, b: {$strLenCP: {$toUpper: '$name'}}}}]",
+        "[{$addFields: {__cse_0: {$strLenCP: {$toUpper: '$name'}}}},"
+        " {$addFields: {a: '$__cse_0'}},"
+        " {$project: {_id: 0, a: 1, b: '$__cse_0'}}]");
+}
+
+TEST_F(CommonSubexpressionEliminationTest, DoesNotShareAcrossModificationOfInput) {
+    assertUnchanged(
+        "[{$addFields: {a: {$toUpper: '$name'}}},"
+        " {$addFields: {name: 'x'}},"
+        " {$group: {_id: {$toUpper: '$name'}, a: {$first: '$a'}}}]");
+}
+
+TEST_F(CommonSubexpressionEliminationTest, DoesNotShareConditionallyEvaluatedExpression) {
+    assertUnchanged(
+        "[{$group: {_id: {$cond: [{$gt: ['$x', 0]}, {$toUpper: '$name'}, null]},"
+        " all: {$push: {$toUpper: '$name'}}}}]");
+}
+
+TEST_F(CommonSubexpressionEliminationTest, DoesNotRewriteRunUsingWholeDocument) {
+    assertUnchanged(
+        "[{$group: {_id: {$toUpper: '$name'}, first: {$first: {$toUpper: '$name'}},"
+        " docs: {$push: '$$ROOT'}}}]");
+}
+
+TEST_F(CommonSubexpressionEliminationTest, DoesNotShareNonDeterministicExpression) {
+    assertUnchanged(
+        "[{$group: {_id: {$multiply: [{$rand: {}}, 10]},"
+        " n: {$sum: {$multiply: [{$rand: {}}, 10]}}}}]");
+}
+
+TEST_F(CommonSubexpressionEliminationTest, DoesNotShareCheapExpression) {
+    assertUnchanged("[{$group: {_id: {$add: ['$a', 1]}, n: {$sum: {$add: ['$a', 1]}}}}]");
+}
+
+TEST_F(CommonSubexpressionEliminationTest, ComputesSharedObjectAsExpression) {
+    assertOptimizesTo(
+        "[{$group: {_id: null, first: {$first: {a: {$toUpper: '$name'}}},"
+        " last: {$last: {a: {$toUpper: '$name'}}}}}]",
+        "[{$addFields: {__cse_0: {$mergeObjects: [{a: {$toUpper: '$name'}}]}}},"
+        " {$group: {_id: null, first: {$first: '$__cse_0'}, last: {$last: '$__cse_0'}}}]");
+}
+
+TEST_F(CommonSubexpressionEliminationTest, LeavesLeadingMatchAlone) {
+    assertOptimizesTo(
+        "[{$match: {$expr: {$eq: [{$toUpper: '$name'}, 'A']}}},"
+        " {$group: {_id: {$toUpper: '$name'}, first: {$first: {$toUpper: '$name'}}}}]",
+        "[{$match: {$expr: {$eq: [{$toUpper: '$name'}, 'A']}}},"
+        " {$addFields: {__cse_0: {$toUpper: '$name'}}},"
+        " {$group: {_id: '$__cse_0', first: {$first: '$__cse_0'}}}]");
+}
+
+TEST_F(CommonSubexpressionEliminationTest, ProducesSameResults) {
+    const std::string pipeline =
+        "[{$addFields: {upper: {$toUpper: '$name'}}},"
+        " {$match: {$expr: {$eq: [{$toUpper: '$name'}, '$upper']}}},"
+        " {$group: {_id: {$toUpper: '$name'}, n: {$sum: 1},"
+        "  len: {$avg: {$strLenCP: {$toUpper: '$name'}}}}},"
+        " {$sort: {_id: 1}}]";
+    const std::vector<Document> inputs{Document{{"name", "ab"_sd}},
+                                       Document{{"name", "AB"_sd}},
+                                       Document{{"name", "c"_sd}},
+                                       Document{{"other", 1}}};
+
+    auto expected = execute(pipeline, inputs, false);
+    auto actual = execute(pipeline, inputs, true);
+    ASSERT_EQ(actual.size(), 3U);
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        ASSERT_DOCUMENT_EQ(actual[i], expected[i]);
+    }
+}
+
+TEST_F(CommonSubexpressionEliminationTest, SharedObjectReplacesExistingInternalField) {
+    const std::string pipeline =
+        "[{$group: {_id: null, first: {$first: {a: {$toUpper: '$name'}}},"
+        " last: {$last: {a: {$toUpper: '$name'}}}}}]";
+    const std::vector<Document> inputs{
+        Document{{"name", "ab"_sd}, {"__cse_0", std::vector<Value>{Value(1), Value(2)}}}};
+
+    auto actual = execute(pipeline, inputs, true);
+    ASSERT_EQ(actual.size(), 1U);
+    ASSERT_DOCUMENT_EQ(actual[0], execute(pipeline, inputs, false)[0]);
+    ASSERT_VALUE_EQ(actual[0]["first"], Value(Document{{"a", "AB"_sd}}));
+}
+
+}  // namespace
+}  // namespace mongo
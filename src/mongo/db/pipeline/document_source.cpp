@@ -111,6 +111,18 @@ const char* DocumentSource::getSourceName() const {
     return unknown;
 }
 
+boost::optional<DocumentSource::GetNextResult> DocumentSource::doGetNextBatch(
+    size_t maxBatchSize, std::vector<Document>* batch) {
+    for (size_t i = 0; i < maxBatchSize; ++i) {
+        auto next = doGetNext();
+        if (!next.isAdvanced()) {
+            return next;
+        }
+        batch->push_back(next.releaseDocument());
+    }
+    return boost::none;
+}
+
 intrusive_ptr<DocumentSource> DocumentSource::optimize() {
     return this;
 }
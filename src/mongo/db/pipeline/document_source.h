@@ -275,6 +275,40 @@ public:
         return next;
     }
 
+    /**
+     * Batched variant of getNext(). Appends up to 'maxBatchSize' results of this DocumentSource to
+     * 'batch', so that a consumer can process several documents per call rather than pay for a
+     * virtual call chain through the pipeline for each of them.
+     *
+     * Returns the kEOF or kPauseExecution result which ended the batch early, if any, or
+     * boost::none if 'maxBatchSize' documents were appended. Note that the documents appended
+     * before the batch was ended must still be processed by the caller before it acts on the
+     * returned result.
+     */
+    boost::optional<GetNextResult> getNextBatch(size_t maxBatchSize, std::vector<Document>* batch) {
+        pExpCtx->checkForInterrupt();
+
+        if (MONGO_likely(!pExpCtx->shouldCollectDocumentSourceExecStats())) {
+            return doGetNextBatch(maxBatchSize, batch);
+        }
+
+        auto serviceCtx = pExpCtx->opCtx->getServiceContext();
+        invariant(serviceCtx);
+        auto fcs = serviceCtx->getFastClockSource();
+        invariant(fcs);
+
+        invariant(_commonStats.executionTimeMillis);
+        ScopedTimer timer(fcs, _commonStats.executionTimeMillis.get_ptr());
+
+        // Account for the batch as if each of its results had been returned by getNext().
+        const size_t oldSize = batch->size();
+        auto end = doGetNextBatch(maxBatchSize, batch);
+        const size_t numAdvanced = batch->size() - oldSize;
+        _commonStats.works += numAdvanced + (end ? 1 : 0);
+        _commonStats.advanced += numAdvanced;
+        return end;
+    }
+
     /**
      * Returns a struct containing information about any special constraints imposed on using this
      * stage. Input parameter Pipeline::SplitState is used by stages whose requirements change
@@ -513,6 +547,14 @@ protected:
      */
     virtual GetNextResult doGetNext() = 0;
 
+    /**
+     * The batched execution API of a DocumentSource. See comment at getNextBatch(). The default
+     * implementation repeatedly calls doGetNext(); stages which can do better by working on a whole
+     * batch at once should override it.
+     */
+    virtual boost::optional<GetNextResult> doGetNextBatch(size_t maxBatchSize,
+                                                          std::vector<Document>* batch);
+
     /**
      * Attempt to perform an optimization with the following source in the pipeline. 'container'
      * refers to the entire pipeline, and 'itr' points to this stage within the pipeline.
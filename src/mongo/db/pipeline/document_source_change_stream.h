@@ -236,6 +236,11 @@ public:
         MONGO_UNREACHABLE;
     }
 
+    boost::optional<GetNextResult> doGetNextBatch(size_t maxBatchSize,
+                                                  std::vector<Document>* batch) final {
+        MONGO_UNREACHABLE;
+    }
+
     StageConstraints constraints(Pipeline::SplitState pipeState) const final;
 
     Value serialize(boost::optional<ExplainOptions::Verbosity> explain) const final;
@@ -56,6 +56,11 @@ const char* DocumentSourceCursor::getSourceName() const {
     return kStageName.rawData();
 }
 
+bool DocumentSourceCursor::providesSortOrder() const {
+    auto cq = _exec ? _exec->getCanonicalQuery() : nullptr;
+    return cq && !cq->getQueryRequest().getSort().isEmpty();
+}
+
 bool DocumentSourceCursor::Batch::isEmpty() const {
     switch (_type) {
         case CursorType::kRegular:
@@ -111,6 +111,12 @@ public:
         return _planSummaryStats.usedDisk;
     }
 
+    /**
+     * Returns whether the documents are returned in an order requested from the query, for
+     * example after a $sort was pushed down into it, which later stages may depend on.
+     */
+    virtual bool providesSortOrder() const;
+
 protected:
     DocumentSourceCursor(Collection* collection,
                          std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> exec,
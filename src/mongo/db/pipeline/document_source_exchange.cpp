@@ -459,6 +459,11 @@ void Exchange::dispose(OperationContext* opCtx, size_t consumerId) {
     unblockLoading(consumerId);
 }
 
+void Exchange::inspectPipeline(const std::function<void(const Pipeline&)>& fn) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    fn(*_pipeline);
+}
+
 DocumentSource::GetNextResult Exchange::ExchangeBuffer::getNext() {
     invariant(!_buffer.empty());
 
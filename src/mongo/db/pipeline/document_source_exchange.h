@@ -30,6 +30,7 @@
 #pragma once
 
 #include <deque>
+#include <functional>
 #include <vector>
 
 #include "mongo/bson/ordering.h"
@@ -95,6 +96,11 @@ public:
 
     void dispose(OperationContext* opCtx, size_t consumerId);
 
+    /**
+     * Calls 'fn' with the input pipeline while no consumer is loading documents from it.
+     */
+    void inspectPipeline(const std::function<void(const Pipeline&)>& fn);
+
     /**
      * Unblocks the loading thread (a producer) if the loading is blocked by a consumer identified
      * by consumerId. Note that there is no such thing as being blocked by multiple consumers. It is
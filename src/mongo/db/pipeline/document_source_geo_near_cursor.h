@@ -69,6 +69,13 @@ public:
 
     const char* getSourceName() const final;
 
+    /**
+     * The documents are always returned in order of their distance.
+     */
+    bool providesSortOrder() const final {
+        return true;
+    }
+
 private:
     DocumentSourceGeoNearCursor(Collection*,
                                 std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>,
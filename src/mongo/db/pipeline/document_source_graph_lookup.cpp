@@ -31,6 +31,7 @@
 
 #include "mongo/db/pipeline/document_source_graph_lookup.h"
 
+#include <boost/filesystem/operations.hpp>
 #include <memory>
 
 #include "mongo/base/init.h"
@@ -44,6 +45,7 @@
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/util/destructor_guard.h"
 
 namespace mongo {
 
@@ -51,6 +53,17 @@ namespace {
 bool foreignShardedLookupAllowed() {
     return getTestCommandsEnabled() && internalQueryAllowShardedLookup.load();
 }
+
+/**
+ * Generates a new file name on each call using a static, atomic and monotonically increasing
+ * number. See the equivalent function in document_source_group.cpp for why each user of the Sorter
+ * must provide its own.
+ */
+std::string nextFileName() {
+    static AtomicWord<unsigned> documentSourceGraphLookUpFileCounter;
+    return "extsort-doc-graphlookup." +
+        std::to_string(documentSourceGraphLookUpFileCounter.fetchAndAdd(1));
+}
 }  // namespace
 
 using boost::intrusive_ptr;
@@ -106,11 +119,9 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::doGetNext() {
     performSearch();
 
     std::vector<Value> results;
-    while (!_visited.empty()) {
+    while (hasVisitedResults()) {
         // Remove elements one at a time to avoid consuming more memory.
-        auto it = _visited.begin();
-        results.push_back(Value(it->second));
-        _visited.erase(it);
+        results.push_back(Value(popVisitedResult()));
     }
 
     MutableDocument output(*_input);
@@ -129,7 +140,7 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
     // If the unwind is not preserving empty arrays, we might have to process multiple inputs before
     // we get one that will produce an output.
     while (true) {
-        if (_visited.empty()) {
+        if (!hasVisitedResults()) {
             // No results are left for the current input, so we should move on to the next one and
             // perform a new search.
 
@@ -145,7 +156,7 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
         }
         MutableDocument unwound(*_input);
 
-        if (_visited.empty()) {
+        if (!hasVisitedResults()) {
             if ((*_unwind)->preserveNullAndEmptyArrays()) {
                 // Since "preserveNullAndEmptyArrays" was specified, output a document even though
                 // we had no result.
@@ -159,13 +170,11 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
                 continue;
             }
         } else {
-            auto it = _visited.begin();
-            unwound.setNestedField(_as, Value(it->second));
+            unwound.setNestedField(_as, Value(popVisitedResult()));
             if (indexPath) {
                 unwound.setNestedField(*indexPath, Value(_outputIndex));
                 ++_outputIndex;
             }
-            _visited.erase(it);
         }
 
         return unwound.freeze();
@@ -176,6 +185,7 @@ void DocumentSourceGraphLookUp::doDispose() {
     _cache.clear();
     _frontier.clear();
     _visited.clear();
+    resetSpilledVisited();
 }
 
 void DocumentSourceGraphLookUp::doBreadthFirstSearch() {
@@ -239,12 +249,70 @@ void DocumentSourceGraphLookUp::doBreadthFirstSearch() {
 
     _frontier.clear();
     _frontierUsageBytes = 0;
+
+    // The spilled '_id' values are only needed to de-duplicate during the search.
+    _spilledVisitedIds.clear();
+    _spilledVisitedIdsUsageBytes = 0;
+}
+
+bool DocumentSourceGraphLookUp::isVisited(const Value& id) const {
+    return _visited.find(id) != _visited.end() ||
+        _spilledVisitedIds.find(id) != _spilledVisitedIds.end();
+}
+
+Document DocumentSourceGraphLookUp::popVisitedResult() {
+    if (!_visited.empty()) {
+        auto it = _visited.begin();
+        Document result = std::move(it->second);
+        _visited.erase(it);
+        return result;
+    }
+
+    invariant(_numSpilledVisited > 0);
+    while (!_spilledVisited.back()->more()) {
+        _spilledVisited.pop_back();
+    }
+    --_numSpilledVisited;
+    return _spilledVisited.back()->next().second.getDocument();
+}
+
+void DocumentSourceGraphLookUp::spillVisited() {
+    invariant(_allowDiskUse);
+    _usedDisk = true;
+
+    // The runs are read back one after the other and never merged, so they need not be sorted.
+    SortedFileWriter<Value, Value> writer(
+        SortOptions().TempDir(pExpCtx->tempDir), _spillFileName, _nextSpillFileOffset);
+    for (auto&& [id, doc] : _visited) {
+        writer.addAlreadySorted(id, Value(doc));
+        _spilledVisitedIdsUsageBytes += id.getApproximateSize();
+        _spilledVisitedIds.insert(id);
+    }
+    _numSpilledVisited += _visited.size();
+
+    _visited.clear();
+    _visitedUsageBytes = 0;
+
+    _spilledVisited.emplace_back(writer.done());
+    _nextSpillFileOffset = writer.getFileEndOffset();
+}
+
+void DocumentSourceGraphLookUp::resetSpilledVisited() {
+    _spilledVisited.clear();
+    _numSpilledVisited = 0;
+    _spilledVisitedIds.clear();
+    _spilledVisitedIdsUsageBytes = 0;
+
+    if (_nextSpillFileOffset != std::streampos(0)) {
+        boost::filesystem::remove(_spillFileName);
+        _nextSpillFileOffset = 0;
+    }
 }
 
 bool DocumentSourceGraphLookUp::addToVisitedAndFrontier(Document result, long long depth) {
     auto id = result.getField("_id");
 
-    if (_visited.find(id) != _visited.end()) {
+    if (isVisited(id)) {
         // We've already seen this object, don't repeat any work.
         return false;
     }
@@ -344,6 +412,9 @@ void DocumentSourceGraphLookUp::performSearch() {
     // Make sure _input is set before calling performSearch().
     invariant(_input);
 
+    // Every result of the previous input has been returned, so its spilled runs can be dropped.
+    resetSpilledVisited();
+
     Value startingValue = _startWith->evaluate(*_input, &pExpCtx->variables);
 
     // If _startWith evaluates to an array, treat each value as a separate starting point.
@@ -403,11 +474,19 @@ Pipeline::SourceContainer::iterator DocumentSourceGraphLookUp::doOptimizeAt(
 }
 
 void DocumentSourceGraphLookUp::checkMemoryUsage() {
-    // TODO SERVER-23980: Implement spilling to disk if allowDiskUse is specified.
+    if (_allowDiskUse && !_visited.empty() &&
+        (_visitedUsageBytes + _spilledVisitedIdsUsageBytes + _frontierUsageBytes) >=
+            _maxMemoryUsageBytes) {
+        spillVisited();
+    }
+
+    // The frontier and the '_id' values of the spilled documents are always kept in memory.
+    const size_t usageBytes =
+        _visitedUsageBytes + _spilledVisitedIdsUsageBytes + _frontierUsageBytes;
     uassert(40099,
             "$graphLookup reached maximum memory consumption",
-            (_visitedUsageBytes + _frontierUsageBytes) < _maxMemoryUsageBytes);
-    _cache.evictDownTo(_maxMemoryUsageBytes - _frontierUsageBytes - _visitedUsageBytes);
+            usageBytes < _maxMemoryUsageBytes);
+    _cache.evictDownTo(_maxMemoryUsageBytes - usageBytes);
 }
 
 void DocumentSourceGraphLookUp::serializeToArray(
@@ -477,8 +556,11 @@ DocumentSourceGraphLookUp::DocumentSourceGraphLookUp(
       _additionalFilter(additionalFilter),
       _depthField(depthField),
       _maxDepth(maxDepth),
+      _maxMemoryUsageBytes(internalDocumentSourceGraphLookupMaxMemoryBytes.load()),
+      _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos),
       _frontier(pExpCtx->getValueComparator().makeUnorderedValueSet()),
       _visited(ValueComparator::kInstance.makeUnorderedValueMap<Document>()),
+      _spilledVisitedIds(ValueComparator::kInstance.makeUnorderedValueSet()),
       _cache(pExpCtx->getValueComparator()),
       _unwind(unwindSrc),
       _variables(expCtx->variables),
@@ -491,6 +573,16 @@ DocumentSourceGraphLookUp::DocumentSourceGraphLookUp(
     _fromPipeline = resolvedNamespace.pipeline;
     _fromPipeline.reserve(_fromPipeline.size() + 1);
     _fromPipeline.push_back(BSON("$match" << BSONObj()));
+
+    if (_allowDiskUse) {
+        _spillFileName = pExpCtx->tempDir + "/" + nextFileName();
+    }
+}
+
+DocumentSourceGraphLookUp::~DocumentSourceGraphLookUp() {
+    if (_usedDisk) {
+        DESTRUCTOR_GUARD(boost::filesystem::remove(_spillFileName));
+    }
 }
 
 intrusive_ptr<DocumentSourceGraphLookUp> DocumentSourceGraphLookUp::create(
@@ -626,3 +718,6 @@ void DocumentSourceGraphLookUp::addInvolvedCollections(
     }
 }
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
@@ -34,6 +34,7 @@
 #include "mongo/db/pipeline/document_source_unwind.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/lookup_set_cache.h"
+#include "mongo/db/sorter/sorter.h"
 
 namespace mongo {
 
@@ -41,6 +42,8 @@ class DocumentSourceGraphLookUp final : public DocumentSource {
 public:
     static constexpr StringData kStageName = "$graphLookup"_sd;
 
+    ~DocumentSourceGraphLookUp();
+
     class LiteParsed : public LiteParsedDocumentSourceForeignCollection {
     public:
         LiteParsed(std::string parseTimeName, NamespaceString foreignNss)
@@ -95,7 +98,7 @@ public:
         StageConstraints constraints(StreamType::kStreaming,
                                      PositionRequirement::kNone,
                                      HostTypeRequirement::kPrimaryShard,
-                                     DiskUseRequirement::kNoDiskUse,
+                                     DiskUseRequirement::kWritesTmpData,
                                      FacetRequirement::kAllowed,
                                      TransactionRequirement::kAllowed,
                                      LookupRequirement::kAllowed,
@@ -117,6 +120,10 @@ public:
 
     void addInvolvedCollections(stdx::unordered_set<NamespaceString>* collectionNames) const final;
 
+    bool usedDisk() final {
+        return _usedDisk;
+    }
+
     void detachFromOperationContext() final;
 
     void reattachToOperationContext(OperationContext* opCtx) final;
@@ -201,10 +208,41 @@ private:
 
     /**
      * Assert that '_visited' and '_frontier' have not exceeded the maximum meory usage, and then
-     * evict from '_cache' until this source is using less than '_maxMemoryUsageBytes'.
+     * evict from '_cache' until this source is using less than '_maxMemoryUsageBytes'. If disk use
+     * is allowed, '_visited' is spilled first when the limit has been reached.
      */
     void checkMemoryUsage();
 
+    /**
+     * Writes the documents in '_visited' to a new run in the spill file, keeping only their '_id'
+     * values in memory so that the search can keep de-duplicating against them.
+     */
+    void spillVisited();
+
+    /**
+     * Returns true if the document with '_id' equal to 'id' has been visited for the current input,
+     * whether it is still in '_visited' or has been spilled.
+     */
+    bool isVisited(const Value& id) const;
+
+    /**
+     * Returns true if some visited documents have not been returned yet for the current input.
+     */
+    bool hasVisitedResults() const {
+        return !_visited.empty() || _numSpilledVisited > 0;
+    }
+
+    /**
+     * Removes one of the visited documents that have not been returned yet and returns it. Only
+     * legal if hasVisitedResults() is true.
+     */
+    Document popVisitedResult();
+
+    /**
+     * Discards the spilled documents of the previous input and truncates the spill file.
+     */
+    void resetSpilledVisited();
+
     /**
      * Process 'result', adding it to '_visited' with the given 'depth', and updating '_frontier'
      * with the object's 'connectTo' values.
@@ -230,12 +268,24 @@ private:
     // The aggregation pipeline to perform against the '_from' namespace.
     std::vector<BSONObj> _fromPipeline;
 
-    size_t _maxMemoryUsageBytes = 100 * 1024 * 1024;
+    size_t _maxMemoryUsageBytes;
 
     // Track memory usage to ensure we don't exceed '_maxMemoryUsageBytes'.
     size_t _visitedUsageBytes = 0;
+    size_t _spilledVisitedIdsUsageBytes = 0;
     size_t _frontierUsageBytes = 0;
 
+    // Whether '_visited' may be spilled to disk once it no longer fits in '_maxMemoryUsageBytes'.
+    const bool _allowDiskUse;
+
+    // Keeps track of whether this $graphLookup spilled to disk.
+    bool _usedDisk = false;
+
+    // The file holding the spilled runs of visited documents, and the offset at which the next run
+    // starts. The file is truncated before the search for each input document.
+    std::string _spillFileName;
+    std::streampos _nextSpillFileOffset = 0;
+
     // Only used during the breadth-first search, tracks the set of values on the current frontier.
     ValueUnorderedSet _frontier;
 
@@ -244,6 +294,15 @@ private:
     // using the simple collation.
     ValueUnorderedMap<Document> _visited;
 
+    // The '_id' values of visited documents which have been spilled for the current input. Only
+    // needed while searching, and compared using the simple collation like the keys of '_visited'.
+    ValueUnorderedSet _spilledVisitedIds;
+
+    // The spilled runs of visited documents, keyed by '_id', and the number of documents in them
+    // which have not been returned yet. They are returned after the documents still in '_visited'.
+    std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _spilledVisited;
+    size_t _numSpilledVisited = 0;
+
     // Caches query results to avoid repeating any work. This structure is maintained across calls
     // to getNext().
     LookupSetCache _cache;
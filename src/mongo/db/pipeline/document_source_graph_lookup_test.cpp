@@ -38,8 +38,11 @@
 #include "mongo/db/pipeline/document_source_graph_lookup.h"
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/process_interface/stub_mongo_process_interface.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 
 namespace mongo {
@@ -478,6 +481,111 @@ TEST_F(DocumentSourceGraphLookUpTest, GraphLookupWithComparisonExpressionForStar
     ASSERT_DOCUMENT_EQ(actualResult, expectedResult);
 }
 
+/**
+ * Returns the documents of a chain 0 -> 1 -> ... -> 'length' - 1, each padded so that the whole
+ * chain does not fit in a small memory limit.
+ */
+std::deque<DocumentSource::GetNextResult> makePaddedChain(int length) {
+    const std::string padding(1024, 'x');
+    std::deque<DocumentSource::GetNextResult> chain;
+    for (int i = 0; i < length; ++i) {
+        chain.emplace_back(Document{{"_id", i}, {"to", i + 1}, {"padding", padding}});
+    }
+    return chain;
+}
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldFailWhenExceedingMemoryLimitWithoutAllowDiskUse) {
+    const auto originalMaxMemoryBytes = internalDocumentSourceGraphLookupMaxMemoryBytes.load();
+    internalDocumentSourceGraphLookupMaxMemoryBytes.store(16 * 1024);
+    ON_BLOCK_EXIT(
+        [&] { internalDocumentSourceGraphLookupMaxMemoryBytes.store(originalMaxMemoryBytes); });
+
+    auto expCtx = getExpCtx();
+    std::deque<DocumentSource::GetNextResult> inputs{Document{{"_id", 0}}};
+    auto inputMock = DocumentSourceMock::createForTest(std::move(inputs), expCtx);
+
+    NamespaceString fromNs("test", "graph_lookup");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+    expCtx->mongoProcessInterface = std::make_shared<MockMongoInterface>(makePaddedChain(100));
+    auto graphLookupStage =
+        DocumentSourceGraphLookUp::create(expCtx,
+                                          fromNs,
+                                          "results",
+                                          "to",
+                                          "_id",
+                                          ExpressionFieldPath::create(expCtx.get(), "_id"),
+                                          boost::none,
+                                          boost::none,
+                                          boost::none,
+                                          boost::none);
+    graphLookupStage->setSource(inputMock.get());
+
+    ASSERT_THROWS_CODE(graphLookupStage->getNext(), AssertionException, 40099);
+}
+
+TEST_F(DocumentSourceGraphLookUpTest, ShouldSpillVisitedDocumentsWithAllowDiskUse) {
+    const auto originalMaxMemoryBytes = internalDocumentSourceGraphLookupMaxMemoryBytes.load();
+    internalDocumentSourceGraphLookupMaxMemoryBytes.store(16 * 1024);
+    ON_BLOCK_EXIT(
+        [&] { internalDocumentSourceGraphLookupMaxMemoryBytes.store(originalMaxMemoryBytes); });
+
+    const int kChainLength = 100;
+    auto expCtx = getExpCtx();
+    unittest::TempDir tempDir("DocumentSourceGraphLookUpTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+
+    // Search from two inputs to verify that the spilled documents of the first one are not
+    // returned for the second.
+    std::deque<DocumentSource::GetNextResult> inputs{Document{{"_id", 0}},
+                                                     Document{{"_id", kChainLength - 2}}};
+    auto inputMock = DocumentSourceMock::createForTest(std::move(inputs), expCtx);
+
+    NamespaceString fromNs("test", "graph_lookup");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+    expCtx->mongoProcessInterface =
+        std::make_shared<MockMongoInterface>(makePaddedChain(kChainLength));
+    auto graphLookupStage =
+        DocumentSourceGraphLookUp::create(expCtx,
+                                          fromNs,
+                                          "results",
+                                          "to",
+                                          "_id",
+                                          ExpressionFieldPath::create(expCtx.get(), "_id"),
+                                          boost::none,
+                                          boost::none,
+                                          boost::none,
+                                          boost::none);
+    graphLookupStage->setSource(inputMock.get());
+
+    auto collectIds = [](const Document& output) {
+        std::vector<int> ids;
+        for (auto&& result : output.getField("results").getArray()) {
+            ids.push_back(result.getDocument().getField("_id").getInt());
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    };
+
+    auto next = graphLookupStage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_TRUE(graphLookupStage->usedDisk());
+    auto ids = collectIds(next.getDocument());
+    ASSERT_EQ(static_cast<size_t>(kChainLength), ids.size());
+    for (int i = 0; i < kChainLength; ++i) {
+        ASSERT_EQ(i, ids[i]);
+    }
+
+    next = graphLookupStage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT(collectIds(next.getDocument()) ==
+           std::vector<int>({kChainLength - 2, kChainLength - 1}));
+
+    ASSERT(graphLookupStage->getNext().isEOF());
+}
+
 TEST_F(DocumentSourceGraphLookUpTest, ShouldExpandArraysAtEndOfConnectFromField) {
     auto expCtx = getExpCtx();
 
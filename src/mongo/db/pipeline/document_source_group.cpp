@@ -31,6 +31,7 @@
 
 #include <boost/filesystem/operations.hpp>
 #include <memory>
+#include <set>
 
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/value.h"
@@ -47,6 +48,9 @@ namespace mongo {
 
 namespace {
 
+// The number of input documents which an unsorted $group consumes and evaluates at a time.
+constexpr size_t kInputBatchSize = 128;
+
 /**
  * Generates a new file name on each call using a static, atomic and monotonically increasing
  * number.
@@ -132,6 +136,10 @@ const char* DocumentSourceGroup::getSourceName() const {
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::doGetNext() {
+    if (_streaming) {
+        return getNextStreaming();
+    }
+
     if (!_initialized) {
         const auto initializationResult = initialize();
         if (initializationResult.isPaused()) {
@@ -209,10 +217,94 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
     return std::move(out);
 }
 
+DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
+    const size_t numAccumulators = _accumulatedFields.size();
+
+    std::vector<Document> batch;
+    std::vector<Value> ids;
+    std::vector<std::vector<Value>> arguments(numAccumulators);
+    while (_readyGroups.empty()) {
+        if (_streamingInputExhausted) {
+            return GetNextResult::makeEOF();
+        }
+
+        batch.clear();
+        auto batchEnd = pSource->getNextBatch(kInputBatchSize, &batch);
+
+        ids.clear();
+        computeIds(batch, &ids);
+        for (size_t i = 0; i < numAccumulators; i++) {
+            arguments[i].clear();
+            _accumulatedFields[i].expr.argument->evaluateBatch(
+                batch, &pExpCtx->variables, &arguments[i]);
+        }
+
+        for (size_t row = 0; row < batch.size(); ++row) {
+            const Value& id = ids[row];
+
+            // The sort considers null and missing to be equal, so documents whose group keys differ
+            // only in that respect may be interleaved. They are grouped together until the key
+            // changes in some other way.
+            Value streamingKey = id;
+            if (_idExpressions.size() > 1) {
+                std::vector<Value> components = id.getArray();
+                for (auto&& component : components) {
+                    if (component.missing()) {
+                        component = Value(BSONNULL);
+                    }
+                }
+                streamingKey = Value(std::move(components));
+            }
+
+            if (!_groups->empty() &&
+                pExpCtx->getValueComparator().evaluate(_streamingKey != streamingKey)) {
+                flushStreamingGroups();
+            }
+            _streamingKey = std::move(streamingKey);
+
+            accumulate(id, arguments, row);
+
+            uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
+                    "Exceeded memory limit for $group, but didn't allow external sort."
+                    " Pass allowDiskUse:true to opt in.",
+                    _memoryUsageBytes <= _maxMemoryUsageBytes || _allowDiskUse);
+        }
+
+        if (!batchEnd) {
+            continue;
+        }
+        if (batchEnd->isPaused()) {
+            if (_readyGroups.empty()) {
+                return std::move(*batchEnd);
+            }
+            // Groups which are already complete take precedence over the pause. The input is
+            // asked again for more documents once they have been returned.
+            break;
+        }
+        invariant(batchEnd->isEOF());
+        flushStreamingGroups();
+        _streamingInputExhausted = true;
+    }
+
+    Document out = std::move(_readyGroups.front());
+    _readyGroups.pop_front();
+    return std::move(out);
+}
+
+void DocumentSourceGroup::flushStreamingGroups() {
+    for (auto&& group : *_groups) {
+        _readyGroups.push_back(makeDocument(group.first, group.second, pExpCtx->needsMerge));
+    }
+    _groups->clear();
+    _memoryUsageBytes = 0;
+}
+
 void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
     _sorterIterator.reset();
+    _readyGroups.clear();
+    _streamingInputExhausted = true;
 
     // Make us look done.
     groupsIterator = _groups->end();
@@ -321,6 +413,23 @@ const std::vector<AccumulationStatement>& DocumentSourceGroup::getAccumulatedFie
     return _accumulatedFields;
 }
 
+void DocumentSourceGroup::visitInputExpressions(
+    const std::function<void(boost::intrusive_ptr<Expression>*)>& visit) {
+    for (auto&& idExpression : _idExpressions) {
+        visit(&idExpression);
+    }
+    for (auto&& accumulatedField : _accumulatedFields) {
+        auto& argument = accumulatedField.expr.argument;
+        if (auto object = dynamic_cast<ExpressionObject*>(argument.get())) {
+            for (auto&& field : object->getChildExpressions()) {
+                visit(&field.second);
+            }
+        } else {
+            visit(&argument);
+        }
+    }
+}
+
 intrusive_ptr<DocumentSourceGroup> DocumentSourceGroup::create(
     const intrusive_ptr<ExpressionContext>& pExpCtx,
     const boost::intrusive_ptr<Expression>& groupByExpression,
@@ -364,6 +473,18 @@ void DocumentSourceGroup::addAccumulator(AccumulationStatement accumulationState
     _accumulatedFields.push_back(accumulationStatement);
 }
 
+void DocumentSourceGroup::replaceAccumulator(AccumulationStatement accumulationStatement) {
+    // An AccumulationStatement cannot be assigned to, so the list is rebuilt around the new one.
+    std::vector<AccumulationStatement> accumulatedFields;
+    accumulatedFields.reserve(_accumulatedFields.size());
+    for (auto&& accumulatedField : _accumulatedFields) {
+        accumulatedFields.push_back(accumulatedField.fieldName == accumulationStatement.fieldName
+                                        ? accumulationStatement
+                                        : accumulatedField);
+    }
+    _accumulatedFields = std::move(accumulatedFields);
+}
+
 namespace {
 
 intrusive_ptr<Expression> parseIdExpression(const intrusive_ptr<ExpressionContext>& expCtx,
@@ -479,74 +600,55 @@ private:
 DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     const size_t numAccumulators = _accumulatedFields.size();
 
-    // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
-    GetNextResult input = pSource->getNext();
-    for (; input.isAdvanced(); input = pSource->getNext()) {
-        if (_memoryUsageBytes > _maxMemoryUsageBytes) {
-            uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
-                    "Exceeded memory limit for $group, but didn't allow external sort."
-                    " Pass allowDiskUse:true to opt in.",
-                    _allowDiskUse);
-            _sortedFiles.push_back(spill());
-            _memoryUsageBytes = 0;
+    // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'. The input is
+    // consumed in batches so that the group keys and accumulator arguments can be evaluated a batch
+    // at a time.
+    std::vector<Document> batch;
+    std::vector<Value> ids;
+    std::vector<std::vector<Value>> arguments(numAccumulators);
+    boost::optional<GetNextResult> batchEnd;
+    do {
+        // We release the previous batch here so that its documents do not outlive the loop
+        // iteration which processed them. Not releasing could lead to an array copy when this group
+        // follows an unwind.
+        batch.clear();
+        batchEnd = pSource->getNextBatch(kInputBatchSize, &batch);
+
+        ids.clear();
+        computeIds(batch, &ids);
+        for (size_t i = 0; i < numAccumulators; i++) {
+            arguments[i].clear();
+            _accumulatedFields[i].expr.argument->evaluateBatch(
+                batch, &pExpCtx->variables, &arguments[i]);
         }
 
-        // We release the result document here so that it does not outlive the end of this loop
-        // iteration. Not releasing could lead to an array copy when this group follows an unwind.
-        auto rootDocument = input.releaseDocument();
-        Value id = computeId(rootDocument);
-
-        // Look for the _id value in the map. If it's not there, add a new entry with a blank
-        // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
-        // looking it up in '_groups' multiple times.
-        const size_t oldSize = _groups->size();
-        vector<intrusive_ptr<AccumulatorState>>& group = (*_groups)[id];
-        const bool inserted = _groups->size() != oldSize;
-
-        if (inserted) {
-            _memoryUsageBytes += id.getApproximateSize();
-
-            // Initialize and add the accumulators
-            Value expandedId = expandId(id);
-            Document idDoc =
-                expandedId.getType() == BSONType::Object ? expandedId.getDocument() : Document();
-            group.reserve(numAccumulators);
-            for (auto&& accumulatedField : _accumulatedFields) {
-                auto accum = accumulatedField.makeAccumulator();
-                Value initializerValue =
-                    accumulatedField.expr.initializer->evaluate(idDoc, &pExpCtx->variables);
-                accum->startNewGroup(initializerValue);
-                group.push_back(accum);
-            }
-        } else {
-            for (auto&& groupObj : group) {
-                // subtract old mem usage. New usage added back after processing.
-                _memoryUsageBytes -= groupObj->memUsageForSorter();
+        for (size_t row = 0; row < batch.size(); ++row) {
+            if (_memoryUsageBytes > _maxMemoryUsageBytes) {
+                uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
+                        "Exceeded memory limit for $group, but didn't allow external sort."
+                        " Pass allowDiskUse:true to opt in.",
+                        _allowDiskUse);
+                _sortedFiles.push_back(spill());
+                _memoryUsageBytes = 0;
             }
-        }
-
-        /* tickle all the accumulators for the group we found */
-        dassert(numAccumulators == group.size());
 
-        for (size_t i = 0; i < numAccumulators; i++) {
-            group[i]->process(
-                _accumulatedFields[i].expr.argument->evaluate(rootDocument, &pExpCtx->variables),
-                _doingMerge);
-
-            _memoryUsageBytes += group[i]->memUsageForSorter();
-        }
+            const bool inserted = accumulate(ids[row], arguments, row);
 
-        if (kDebugBuild && !storageGlobalParams.readOnly) {
-            // In debug mode, spill every time we have a duplicate id to stress merge logic.
-            if (!inserted &&                 // is a dup
-                !pExpCtx->inMongos &&        // can't spill to disk in mongos
-                !_allowDiskUse &&            // don't change behavior when testing external sort
-                _sortedFiles.size() < 20) {  // don't open too many FDs
+            if (kDebugBuild && !storageGlobalParams.readOnly) {
+                // In debug mode, spill every time we have a duplicate id to stress merge logic.
+                if (!inserted &&                 // is a dup
+                    !pExpCtx->inMongos &&        // can't spill to disk in mongos
+                    !_allowDiskUse &&            // don't change behavior when testing external sort
+                    _sortedFiles.size() < 20) {  // don't open too many FDs
 
-                _sortedFiles.push_back(spill());
+                    _sortedFiles.push_back(spill());
+                }
             }
         }
-    }
+    } while (!batchEnd);
+
+    batch.clear();
+    GetNextResult input = std::move(*batchEnd);
 
     switch (input.getStatus()) {
         case DocumentSource::GetNextResult::ReturnStatus::kAdvanced: {
@@ -595,6 +697,52 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     MONGO_UNREACHABLE;
 }
 
+bool DocumentSourceGroup::accumulate(const Value& id,
+                                     const std::vector<std::vector<Value>>& arguments,
+                                     size_t row) {
+    const size_t numAccumulators = _accumulatedFields.size();
+
+    // Look for the _id value in the map. If it's not there, add a new entry with a blank
+    // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and looking it
+    // up in '_groups' multiple times.
+    const size_t oldSize = _groups->size();
+    vector<intrusive_ptr<AccumulatorState>>& group = (*_groups)[id];
+    const bool inserted = _groups->size() != oldSize;
+
+    if (inserted) {
+        _memoryUsageBytes += id.getApproximateSize();
+
+        // Initialize and add the accumulators
+        Value expandedId = expandId(id);
+        Document idDoc =
+            expandedId.getType() == BSONType::Object ? expandedId.getDocument() : Document();
+        group.reserve(numAccumulators);
+        for (auto&& accumulatedField : _accumulatedFields) {
+            auto accum = accumulatedField.makeAccumulator();
+            Value initializerValue =
+                accumulatedField.expr.initializer->evaluate(idDoc, &pExpCtx->variables);
+            accum->startNewGroup(initializerValue);
+            group.push_back(accum);
+        }
+    } else {
+        for (auto&& groupObj : group) {
+            // subtract old mem usage. New usage added back after processing.
+            _memoryUsageBytes -= groupObj->memUsageForSorter();
+        }
+    }
+
+    /* tickle all the accumulators for the group we found */
+    dassert(numAccumulators == group.size());
+
+    for (size_t i = 0; i < numAccumulators; i++) {
+        group[i]->process(arguments[i][row], _doingMerge);
+
+        _memoryUsageBytes += group[i]->memUsageForSorter();
+    }
+
+    return inserted;
+}
+
 bool DocumentSourceGroup::usedDisk() {
     return _usedDisk;
 }
@@ -643,20 +791,34 @@ shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
     return shared_ptr<Sorter<Value, Value>::Iterator>(iteratorPtr);
 }
 
-Value DocumentSourceGroup::computeId(const Document& root) {
-    // If only one expression, return result directly
+void DocumentSourceGroup::computeIds(const std::vector<Document>& roots,
+                                     std::vector<Value>* ids) {
+    // If only one expression, use its results directly
     if (_idExpressions.size() == 1) {
-        Value retValue = _idExpressions[0]->evaluate(root, &pExpCtx->variables);
-        return retValue.missing() ? Value(BSONNULL) : std::move(retValue);
+        const size_t firstId = ids->size();
+        _idExpressions[0]->evaluateBatch(roots, &pExpCtx->variables, ids);
+        for (size_t i = firstId; i < ids->size(); ++i) {
+            if ((*ids)[i].missing()) {
+                (*ids)[i] = Value(BSONNULL);
+            }
+        }
+        return;
     }
 
     // Multiple expressions get results wrapped in a vector
-    vector<Value> vals;
-    vals.reserve(_idExpressions.size());
+    std::vector<std::vector<Value>> columns(_idExpressions.size());
     for (size_t i = 0; i < _idExpressions.size(); i++) {
-        vals.push_back(_idExpressions[i]->evaluate(root, &pExpCtx->variables));
+        _idExpressions[i]->evaluateBatch(roots, &pExpCtx->variables, &columns[i]);
+    }
+    ids->reserve(ids->size() + roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        vector<Value> vals;
+        vals.reserve(_idExpressions.size());
+        for (auto&& column : columns) {
+            vals.push_back(std::move(column[row]));
+        }
+        ids->push_back(Value(std::move(vals)));
     }
-    return Value(std::move(vals));
 }
 
 Value DocumentSourceGroup::expandId(const Value& val) {
@@ -736,6 +898,35 @@ bool DocumentSourceGroup::pathIncludedInGroupKeys(const std::string& dottedPath)
         });
 }
 
+bool DocumentSourceGroup::groupsAreContiguousWhenSortedBy(const SortPattern& sortPattern) const {
+    if (_doingMerge) {
+        return false;
+    }
+
+    std::set<std::string> idPaths;
+    for (auto&& idExpression : _idExpressions) {
+        auto fieldExp = dynamic_cast<ExpressionFieldPath*>(idExpression.get());
+        if (!fieldExp || fieldExp->getVariableId() != Variables::kRootId ||
+            fieldExp->getFieldPath().getPathLength() < 2) {
+            return false;
+        }
+        idPaths.insert(fieldExp->getFieldPathWithoutCurrentPrefix().fullPath());
+    }
+
+    if (idPaths.empty() || sortPattern.size() < idPaths.size()) {
+        return false;
+    }
+
+    std::set<std::string> sortPaths;
+    for (size_t i = 0; i < idPaths.size(); ++i) {
+        if (!sortPattern[i].fieldPath) {
+            return false;
+        }
+        sortPaths.insert(sortPattern[i].fieldPath->fullPath());
+    }
+    return sortPaths == idPaths;
+}
+
 bool DocumentSourceGroup::canRunInParallelBeforeWriteStage(
     const std::set<std::string>& nameOfShardKeyFieldsUponEntryToStage) const {
     if (_doingMerge) {
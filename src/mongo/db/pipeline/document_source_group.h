@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <deque>
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -36,6 +38,7 @@
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/transformer_interface.h"
+#include "mongo/db/query/sort_pattern.h"
 #include "mongo/db/sorter/sorter.h"
 
 namespace mongo {
@@ -101,6 +104,15 @@ public:
     StringMap<boost::intrusive_ptr<Expression>> getIdFields() const;
     const std::vector<AccumulationStatement>& getAccumulatedFields() const;
 
+    /**
+     * Calls 'visit' on each expression which is evaluated against every input document, namely
+     * the _id expressions and the arguments of the accumulators. 'visit' may replace the
+     * expression it is given. An argument which is an object is visited field by field, since
+     * accumulators like $topN serialize those fields back into their own syntax.
+     */
+    void visitInputExpressions(
+        const std::function<void(boost::intrusive_ptr<Expression>*)>& visit);
+
     /**
      * Convenience method for creating a new $group stage. If maxMemoryUsageBytes is boost::none,
      * then it will actually use the value of internalDocumentSourceGroupMaxMemoryBytes.
@@ -136,6 +148,11 @@ public:
      */
     void addAccumulator(AccumulationStatement accumulationStatement);
 
+    /**
+     * Replaces the accumulator of the field named like 'accumulationStatement' by it.
+     */
+    void replaceAccumulator(AccumulationStatement accumulationStatement);
+
     /**
      * Sets the expression to use to determine the group id of each document.
      */
@@ -156,6 +173,43 @@ public:
         _doingMerge = doingMerge;
     }
 
+    size_t getMaxMemoryUsageBytes() const {
+        return _maxMemoryUsageBytes;
+    }
+
+    /**
+     * Sets the memory this stage may use before it spills to disk, or fails if it may not.
+     */
+    void setMaxMemoryUsageBytes(size_t maxMemoryUsageBytes) {
+        _maxMemoryUsageBytes = maxMemoryUsageBytes;
+    }
+
+    /**
+     * Returns true if, when the input of this stage is sorted by 'sortPattern', all documents with
+     * the same group key arrive one after another. This is the case when the group key consists
+     * only of field paths and 'sortPattern' begins with exactly those paths, in any order and
+     * direction.
+     *
+     * The caller is responsible for ensuring that the sort does not order documents by the
+     * elements of arrays, since the group key of such documents is the array itself.
+     */
+    bool groupsAreContiguousWhenSortedBy(const SortPattern& sortPattern) const;
+
+    /**
+     * Tells this source that documents with the same group key arrive one after another (see
+     * groupsAreContiguousWhenSortedBy()), so that it can return each group as soon as the input
+     * moves on to the next one instead of consuming all of its input first. Must be called before
+     * the first call to getNext().
+     */
+    void setStreaming(bool streaming) {
+        invariant(!_initialized && !_streamingInputExhausted);
+        _streaming = streaming;
+    }
+
+    bool isStreaming() const {
+        return _streaming;
+    }
+
     /**
      * Returns true if this $group stage used disk during execution and false otherwise.
      */
@@ -194,6 +248,7 @@ private:
      */
     GetNextResult getNextSpilled();
     GetNextResult getNextStandard();
+    GetNextResult getNextStreaming();
 
     /**
      * Before returning anything, this source must prepare itself. In a streaming $group,
@@ -207,6 +262,19 @@ private:
      */
     GetNextResult initialize();
 
+    /**
+     * Finds the group for 'id' in '_groups', creating it if it does not exist yet, and feeds its
+     * accumulators the arguments at position 'row' of 'arguments'. Returns true if the group was
+     * created.
+     */
+    bool accumulate(const Value& id, const std::vector<std::vector<Value>>& arguments, size_t row);
+
+    /**
+     * Moves every group in '_groups' to '_readyGroups' in their final form. Only used when
+     * '_streaming' is true.
+     */
+    void flushStreamingGroups();
+
     /**
      * Spill groups map to disk and returns an iterator to the file. Note: Since a sorted $group
      * does not exhaust the previous stage before returning, and thus does not maintain as large a
@@ -217,9 +285,10 @@ private:
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
     /**
-     * Computes the internal representation of the group key.
+     * Computes the internal representation of the group key of each document of 'roots', appending
+     * them to 'ids'.
      */
-    Value computeId(const Document& root);
+    void computeIds(const std::vector<Document>& roots, std::vector<Value>* ids);
 
     /**
      * Converts the internal representation of the group key to the _id shape specified by the
@@ -266,6 +335,15 @@ private:
     const bool _allowDiskUse;
 
     std::pair<Value, Value> _firstPartOfNextGroup;
+
+    bool _streaming = false;
+
+    // Only used when '_streaming' is true. '_groups' then holds only the groups whose key equals
+    // '_streamingKey' once null and missing components are considered equal, as the sort does.
+    // Finished groups wait in '_readyGroups' until they are returned.
+    Value _streamingKey;
+    std::deque<Document> _readyGroups;
+    bool _streamingInputExhausted = false;
 };
 
 }  // namespace mongo
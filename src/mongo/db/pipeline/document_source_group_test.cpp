@@ -244,6 +244,101 @@ TEST_F(DocumentSourceGroupTest, ShouldNotReportDottedGroupKeyAsARename) {
     ASSERT_EQ(modifiedPathsRet.renames.size(), 0UL);
 }
 
+TEST_F(DocumentSourceGroupTest, ShouldDetectWhenSortKeepsGroupsContiguous) {
+    auto expCtx = getExpCtx();
+    auto groupOn = [&](BSONObj spec) {
+        return static_cast<DocumentSourceGroup*>(
+            DocumentSourceGroup::createFromBson(BSON("$group" << spec).firstElement(), expCtx)
+                .get());
+    };
+    auto sortedBy = [&](BSONObj pattern) { return SortPattern(pattern, expCtx); };
+
+    auto singleKey = groupOn(fromjson("{_id: '$a', n: {$sum: 1}}"));
+    ASSERT_TRUE(singleKey->groupsAreContiguousWhenSortedBy(sortedBy(BSON("a" << 1))));
+    ASSERT_TRUE(singleKey->groupsAreContiguousWhenSortedBy(sortedBy(BSON("a" << -1 << "b" << 1))));
+    ASSERT_FALSE(singleKey->groupsAreContiguousWhenSortedBy(sortedBy(BSON("b" << 1 << "a" << 1))));
+    ASSERT_FALSE(singleKey->groupsAreContiguousWhenSortedBy(sortedBy(BSON("a.b" << 1))));
+
+    auto compoundKey = groupOn(fromjson("{_id: {x: '$a', y: '$b.c'}}"));
+    ASSERT_TRUE(
+        compoundKey->groupsAreContiguousWhenSortedBy(sortedBy(BSON("b.c" << 1 << "a" << -1))));
+    ASSERT_FALSE(compoundKey->groupsAreContiguousWhenSortedBy(sortedBy(BSON("a" << 1))));
+    ASSERT_FALSE(
+        compoundKey->groupsAreContiguousWhenSortedBy(sortedBy(BSON("a" << 1 << "d" << 1))));
+
+    auto computedKey = groupOn(fromjson("{_id: {$toUpper: '$a'}}"));
+    ASSERT_FALSE(computedKey->groupsAreContiguousWhenSortedBy(sortedBy(BSON("a" << 1))));
+
+    auto constantKey = groupOn(fromjson("{_id: null}"));
+    ASSERT_FALSE(constantKey->groupsAreContiguousWhenSortedBy(sortedBy(BSON("a" << 1))));
+}
+
+TEST_F(DocumentSourceGroupTest, StreamingGroupReturnsEachGroupOnceItIsComplete) {
+    auto expCtx = getExpCtx();
+    auto group = DocumentSourceGroup::createFromBson(
+        fromjson("{$group: {_id: '$a', n: {$sum: 1}}}").firstElement(), expCtx);
+    static_cast<DocumentSourceGroup*>(group.get())->setStreaming(true);
+    auto mock =
+        DocumentSourceMock::createForTest({Document{{"a", 1}},
+                                           Document{{"a", 1}},
+                                           DocumentSource::GetNextResult::makePauseExecution(),
+                                           Document{{"a", 1}},
+                                           Document{{"a", 2}},
+                                           DocumentSource::GetNextResult::makePauseExecution(),
+                                           Document{{"a", 3}},
+                                           Document{{"a", 3}}},
+                                          expCtx);
+    group->setSource(mock.get());
+
+    // The first group is not known to be complete until a document of the second one arrives.
+    ASSERT_TRUE(group->getNext().isPaused());
+
+    auto next = group->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"_id", 1}, {"n", 3}}));
+
+    // The second pause is not reported, since a complete group could be returned instead.
+    next = group->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"_id", 2}, {"n", 1}}));
+
+    next = group->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(), (Document{{"_id", 3}, {"n", 2}}));
+
+    ASSERT_TRUE(group->getNext().isEOF());
+    ASSERT_TRUE(group->getNext().isEOF());
+}
+
+TEST_F(DocumentSourceGroupTest, StreamingGroupKeepsNullAndMissingKeyComponentsApart) {
+    auto expCtx = getExpCtx();
+    auto group = DocumentSourceGroup::createFromBson(
+        fromjson("{$group: {_id: {a: '$a', b: '$b'}, n: {$sum: 1}}}").firstElement(), expCtx);
+    static_cast<DocumentSourceGroup*>(group.get())->setStreaming(true);
+
+    // A sort on {a: 1, b: 1} may interleave documents where 'b' is null with ones where it is
+    // missing.
+    auto mock = DocumentSourceMock::createForTest({Document{{"a", 1}, {"b", BSONNULL}},
+                                                   Document{{"a", 1}},
+                                                   Document{{"a", 1}, {"b", BSONNULL}},
+                                                   Document{{"a", 2}, {"b", 1}}},
+                                                  expCtx);
+    group->setSource(mock.get());
+
+    std::map<std::string, int> counts;
+    for (auto next = group->getNext(); next.isAdvanced(); next = group->getNext()) {
+        auto doc = next.releaseDocument();
+        counts[doc["_id"].getDocument().toString()] = doc["n"].getInt();
+    }
+    const auto nullKey = Document{{"a", 1}, {"b", BSONNULL}}.toString();
+    const auto missingKey = Document{{"a", 1}}.toString();
+    const auto otherKey = Document{{"a", 2}, {"b", 1}}.toString();
+    ASSERT_EQ(counts.size(), 3U);
+    ASSERT_EQ(counts[nullKey], 2);
+    ASSERT_EQ(counts[missingKey], 1);
+    ASSERT_EQ(counts[otherKey], 1);
+}
+
 BSONObj toBson(const intrusive_ptr<DocumentSource>& source) {
     vector<Value> arr;
     source->serializeToArray(arr);
@@ -31,11 +31,13 @@
 
 #include "mongo/db/pipeline/document_source_lookup.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "mongo/base/init.h"
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/value.h"
+#include "mongo/db/field_ref.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression_algo.h"
 #include "mongo/db/pipeline/document_path_support.h"
@@ -247,6 +249,52 @@ void lookupPipeValidator(const Pipeline& pipeline) {
 bool foreignShardedLookupAllowed() {
     return getTestCommandsEnabled() && internalQueryAllowShardedLookup.load();
 }
+
+// If lookup on a sharded collection is disallowed and the foreign collection is sharded, throw a
+// custom exception.
+void assertForeignCollectionUnshardedIfRequired(
+    const ExceptionForCat<ErrorCategory::StaleShardVersionError>& ex) {
+    if (auto staleInfo = ex.extraInfo<StaleConfigInfo>()) {
+        uassert(51069,
+                "Cannot run $lookup with sharded foreign collection",
+                foreignShardedLookupAllowed() || !staleInfo->getVersionWanted() ||
+                    staleInfo->getVersionWanted() == ChunkVersion::UNSHARDED());
+    }
+}
+
+// Adds the size of 'result' to 'objsize', the size of the foreign documents joining with one input
+// document.
+void addToLookupResultsSize(const NamespaceString& fromNs,
+                            const Document& result,
+                            long long* objsize) {
+    const auto maxBytes = internalLookupStageIntermediateDocumentMaxSizeBytes.load();
+    long long safeSum = 0;
+    bool hasOverflowed = overflow::add(*objsize, result.getApproximateSize(), &safeSum);
+    uassert(4568,
+            str::stream() << "Total size of documents in " << fromNs.coll()
+                          << " matching pipeline's $lookup stage exceeds " << maxBytes << " bytes",
+            !hasOverflowed && *objsize <= maxBytes);
+    *objsize = safeSum;
+}
+
+// Returns whether foreign documents can be joined with the local join key 'value' by hashing the
+// foreign join keys. A null value also matches foreign documents without the join key, an array
+// may match a foreign array as a whole, and a regular expression only matches other regular
+// expressions, so these are always looked up with their own query.
+bool isHashJoinable(const Value& value) {
+    switch (value.getType()) {
+        case BSONType::jstNULL:
+        case BSONType::Undefined:
+        case BSONType::Array:
+        case BSONType::RegEx:
+            return false;
+        default:
+            return true;
+    }
+}
+
+// Bounds the size of the $in list of join keys sent with the query for one batch.
+constexpr int kMaxBatchJoinKeysBytes = BSONObjMaxUserSize / 2;
 }  // namespace
 
 DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
@@ -254,7 +302,7 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
         return unwindResult();
     }
 
-    auto nextInput = pSource->getNext();
+    auto nextInput = getNextInput();
     if (!nextInput.isAdvanced()) {
         return nextInput;
     }
@@ -265,6 +313,12 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
     // '_unwindSrc' would be non-null, and we would not have made it here.
     invariant(!_matchSrc);
 
+    if (auto results = batchedLookupResults(inputDoc)) {
+        MutableDocument output(std::move(inputDoc));
+        output.setNestedField(_as, Value(std::move(*results)));
+        return output.freeze();
+    }
+
     if (!wasConstructedWithPipelineSyntax()) {
         auto matchStage =
             makeMatchStageFromInput(inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
@@ -276,31 +330,14 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
     try {
         pipeline = buildPipeline(inputDoc);
     } catch (const ExceptionForCat<ErrorCategory::StaleShardVersionError>& ex) {
-        // If lookup on a sharded collection is disallowed and the foreign collection is sharded,
-        // throw a custom exception.
-        if (auto staleInfo = ex.extraInfo<StaleConfigInfo>()) {
-            uassert(51069,
-                    "Cannot run $lookup with sharded foreign collection",
-                    foreignShardedLookupAllowed() || !staleInfo->getVersionWanted() ||
-                        staleInfo->getVersionWanted() == ChunkVersion::UNSHARDED());
-        }
+        assertForeignCollectionUnshardedIfRequired(ex);
         throw;
     }
 
     std::vector<Value> results;
     long long objsize = 0;
-    const auto maxBytes = internalLookupStageIntermediateDocumentMaxSizeBytes.load();
-
     while (auto result = pipeline->getNext()) {
-        long long safeSum = 0;
-        bool hasOverflowed = overflow::add(objsize, result->getApproximateSize(), &safeSum);
-        uassert(4568,
-                str::stream() << "Total size of documents in " << _fromNs.coll()
-                              << " matching pipeline's $lookup stage exceeds " << maxBytes
-                              << " bytes",
-
-                !hasOverflowed && objsize <= maxBytes);
-        objsize = safeSum;
+        addToLookupResultsSize(_fromNs, *result, &objsize);
         results.emplace_back(std::move(*result));
     }
     _usedDisk = _usedDisk || pipeline->usedDisk();
@@ -373,6 +410,155 @@ std::unique_ptr<Pipeline, PipelineDeleter> DocumentSourceLookUp::buildPipeline(
     return pipeline;
 }
 
+DocumentSource::GetNextResult DocumentSourceLookUp::getNextInput() {
+    if (_batchedInput.empty()) {
+        if (_batchedInputEnd) {
+            auto end = std::move(*_batchedInputEnd);
+            _batchedInputEnd.reset();
+            return end;
+        }
+
+        // A numeric path component may select an array element, which the foreign join keys
+        // hashed by readBatch() would not account for.
+        bool canBatch = !wasConstructedWithPipelineSyntax() && !_batchingAbandoned &&
+            internalDocumentSourceLookupBatchSize.load() > 0;
+        for (size_t i = 0; canBatch && i < _foreignField->getPathLength(); ++i) {
+            canBatch = !FieldRef::isNumericPathComponentLenient(_foreignField->getFieldName(i));
+        }
+        if (!canBatch) {
+            _batchForeignDocs.clear();
+            _batchForeignDocsByKey.reset();
+            return pSource->getNext();
+        }
+
+        readBatch();
+        if (_batchedInput.empty()) {
+            return getNextInput();
+        }
+    }
+
+    auto next = std::move(_batchedInput.front());
+    _batchedInput.pop_front();
+    return next;
+}
+
+void DocumentSourceLookUp::readBatch() {
+    invariant(_batchedInput.empty() && !_batchedInputEnd);
+    _batchForeignDocs.clear();
+    _batchForeignDocsByKey.reset();
+
+    const auto& valueComparator = _fromExpCtx->getValueComparator();
+    auto joinKeys = valueComparator.makeUnorderedValueSet();
+    BSONArrayBuilder joinKeysBuilder;
+    const size_t batchSize = internalDocumentSourceLookupBatchSize.load();
+    while (_batchedInput.size() < batchSize && joinKeysBuilder.len() < kMaxBatchJoinKeysBytes) {
+        auto nextInput = pSource->getNext();
+        if (!nextInput.isAdvanced()) {
+            _batchedInputEnd = std::move(nextInput);
+            break;
+        }
+
+        _batchedInput.push_back(nextInput.releaseDocument());
+        document_path_support::visitAllValuesAtPath(
+            _batchedInput.back(), *_localField, [&](const Value& value) {
+                if (isHashJoinable(value) && joinKeys.insert(value).second) {
+                    joinKeysBuilder << value;
+                }
+            });
+    }
+
+    if (joinKeys.empty()) {
+        // Every input document of the batch is looked up with its own query.
+        return;
+    }
+
+    // The foreign documents go through the same view and filter as those of the individual
+    // lookups, so the $in list of the join keys replaces the placeholder for their $match.
+    BSONObjBuilder match;
+    {
+        BSONObjBuilder query(match.subobjStart("$match"));
+        BSONArrayBuilder andObj(query.subarrayStart("$and"));
+        andObj << BSON(_foreignField->fullPath() << BSON("$in" << joinKeysBuilder.arr()));
+        andObj << _additionalFilter.value_or(BSONObj());
+    }
+    _resolvedPipeline.back() = match.obj();
+
+    std::unique_ptr<Pipeline, PipelineDeleter> pipeline;
+    try {
+        pipeline = buildPipeline(_batchedInput.front());
+    } catch (const ExceptionForCat<ErrorCategory::StaleShardVersionError>& ex) {
+        assertForeignCollectionUnshardedIfRequired(ex);
+        throw;
+    }
+
+    auto foreignDocsByKey = valueComparator.makeUnorderedValueMap<std::vector<size_t>>();
+    const auto maxBytes = internalDocumentSourceLookupBatchMaxBytes.load();
+    long long bytes = 0;
+    while (auto foreignDoc = pipeline->getNext()) {
+        bytes += foreignDoc->getApproximateSize();
+        if (bytes > maxBytes) {
+            // The join keys match too many foreign documents to hold them in memory. Look up this
+            // batch and all later input documents one by one.
+            _batchingAbandoned = true;
+            _batchForeignDocs.clear();
+            _usedDisk = _usedDisk || pipeline->usedDisk();
+            return;
+        }
+
+        const auto index = _batchForeignDocs.size();
+        document_path_support::visitAllValuesAtPath(
+            *foreignDoc, *_foreignField, [&](const Value& value) {
+                auto& indexes = foreignDocsByKey[value];
+                if (indexes.empty() || indexes.back() != index) {
+                    indexes.push_back(index);
+                }
+            });
+        _batchForeignDocs.push_back(std::move(*foreignDoc));
+    }
+    _usedDisk = _usedDisk || pipeline->usedDisk();
+    _batchForeignDocsByKey = std::move(foreignDocsByKey);
+}
+
+boost::optional<std::vector<Value>> DocumentSourceLookUp::batchedLookupResults(
+    const Document& inputDoc) const {
+    if (!_batchForeignDocsByKey) {
+        return boost::none;
+    }
+
+    // The local values are joined as in makeMatchStageFromInput(). A missing local value is
+    // treated as null.
+    std::vector<size_t> indexes;
+    bool hasValues = false;
+    bool isJoinable = true;
+    document_path_support::visitAllValuesAtPath(inputDoc, *_localField, [&](const Value& value) {
+        hasValues = true;
+        if (!isHashJoinable(value)) {
+            isJoinable = false;
+            return;
+        }
+        auto it = _batchForeignDocsByKey->find(value);
+        if (it != _batchForeignDocsByKey->end()) {
+            indexes.insert(indexes.end(), it->second.begin(), it->second.end());
+        }
+    });
+    if (!hasValues || !isJoinable) {
+        return boost::none;
+    }
+
+    // Return the foreign documents in the order of the query, without the duplicates of foreign
+    // documents matching several local values.
+    std::sort(indexes.begin(), indexes.end());
+    indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+
+    std::vector<Value> results;
+    long long objsize = 0;
+    for (auto index : indexes) {
+        addToLookupResultsSize(_fromNs, _batchForeignDocs[index], &objsize);
+        results.emplace_back(_batchForeignDocs[index]);
+    }
+    return results;
+}
+
 DocumentSource::GetModPathsReturn DocumentSourceLookUp::getModifiedPaths() const {
     std::set<std::string> modifiedPaths{_as.fullPath()};
     if (_unwindSrc) {
@@ -514,6 +700,10 @@ void DocumentSourceLookUp::doDispose() {
         _pipeline->dispose(pExpCtx->opCtx);
         _pipeline.reset();
     }
+    _batchedInput.clear();
+    _batchForeignDocs.clear();
+    _batchForeignDocsByKey.reset();
+    _batchedResultsToUnwind.clear();
 }
 
 BSONObj DocumentSourceLookUp::makeMatchStageFromInput(const Document& input,
@@ -606,36 +796,43 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
     // Loop until we get a document that has at least one match.
     // Note we may return early from this loop if our source stage is exhausted or if the unwind
     // source was asked to return empty arrays and we get a document without a match.
-    while (!_pipeline || !_nextValue) {
-        auto nextInput = pSource->getNext();
+    while (!_nextValue) {
+        auto nextInput = getNextInput();
         if (!nextInput.isAdvanced()) {
             return nextInput;
         }
 
         _input = nextInput.releaseDocument();
 
-        if (!wasConstructedWithPipelineSyntax()) {
-            BSONObj filter = _additionalFilter.value_or(BSONObj());
-            auto matchStage =
-                makeMatchStageFromInput(*_input, *_localField, _foreignField->fullPath(), filter);
-            // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
-            _resolvedPipeline.back() = matchStage;
-        }
-
         if (_pipeline) {
             _usedDisk = _usedDisk || _pipeline->usedDisk();
             _pipeline->dispose(pExpCtx->opCtx);
+            _pipeline.reset();
         }
 
-        _pipeline = buildPipeline(*_input);
+        if (auto results = batchedLookupResults(*_input)) {
+            _batchedResultsToUnwind.assign(std::make_move_iterator(results->begin()),
+                                           std::make_move_iterator(results->end()));
+        } else {
+            if (!wasConstructedWithPipelineSyntax()) {
+                BSONObj filter = _additionalFilter.value_or(BSONObj());
+                auto matchStage = makeMatchStageFromInput(
+                    *_input, *_localField, _foreignField->fullPath(), filter);
+                // We've already allocated space for the trailing $match stage in
+                // '_resolvedPipeline'.
+                _resolvedPipeline.back() = matchStage;
+            }
 
-        // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
-        // potentially be used by multiple OperationContexts, and the $lookup stage is part of an
-        // outer Pipeline that will propagate dispose() calls before being destroyed.
-        _pipeline.get_deleter().dismissDisposal();
+            _pipeline = buildPipeline(*_input);
+
+            // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
+            // potentially be used by multiple OperationContexts, and the $lookup stage is part of
+            // an outer Pipeline that will propagate dispose() calls before being destroyed.
+            _pipeline.get_deleter().dismissDisposal();
+        }
 
         _cursorIndex = 0;
-        _nextValue = _pipeline->getNext();
+        _nextValue = nextResultToUnwind();
 
         if (_unwindSrc->preserveNullAndEmptyArrays() && !_nextValue) {
             // There were no results for this cursor, but the $unwind was asked to preserve empty
@@ -653,7 +850,7 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
 
     invariant(bool(_input) && bool(_nextValue));
     auto currentValue = *_nextValue;
-    _nextValue = _pipeline->getNext();
+    _nextValue = nextResultToUnwind();
 
     // Move input document into output if this is the last or only result, otherwise perform a copy.
     MutableDocument output(_nextValue ? *_input : std::move(*_input));
@@ -667,6 +864,18 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
     return output.freeze();
 }
 
+boost::optional<Document> DocumentSourceLookUp::nextResultToUnwind() {
+    if (_pipeline) {
+        return _pipeline->getNext();
+    }
+    if (_batchedResultsToUnwind.empty()) {
+        return boost::none;
+    }
+    auto next = _batchedResultsToUnwind.front().getDocument();
+    _batchedResultsToUnwind.pop_front();
+    return next;
+}
+
 void DocumentSourceLookUp::resolveLetVariables(const Document& localDoc, Variables* variables) {
     invariant(variables);
 
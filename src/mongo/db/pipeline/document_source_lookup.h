@@ -30,6 +30,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <deque>
 
 #include "mongo/db/exec/document_value/value_comparator.h"
 #include "mongo/db/pipeline/document_source.h"
@@ -259,6 +260,30 @@ private:
      */
     std::unique_ptr<Pipeline, PipelineDeleter> buildPipeline(const Document& inputDoc);
 
+    /**
+     * Returns the next input document. If lookups are batched, this reads the next batch of input
+     * documents and the foreign documents joining with them once the current batch is consumed.
+     */
+    GetNextResult getNextInput();
+
+    /**
+     * Reads up to 'internalDocumentSourceLookupBatchSize' input documents into '_batchedInput' and,
+     * with a single query whose $match holds the $in list of their join keys, the foreign
+     * documents joining with any of them.
+     */
+    void readBatch();
+
+    /**
+     * Returns the foreign documents joining with 'inputDoc', an input document of the current
+     * batch, or boost::none if 'inputDoc' must be looked up with its own query.
+     */
+    boost::optional<std::vector<Value>> batchedLookupResults(const Document& inputDoc) const;
+
+    /**
+     * Returns the next foreign document joining with '_input' when '_unwindSrc' is not null.
+     */
+    boost::optional<Document> nextResultToUnwind();
+
     /**
      * Reinitialize the cache with a new max size. May only be called if this DSLookup was created
      * with pipeline syntax, the cache has not been frozen or abandoned, and no data has been added
@@ -280,6 +305,16 @@ private:
     boost::optional<FieldPath> _localField;
     boost::optional<FieldPath> _foreignField;
 
+    // When lookups on localField/foreignField are batched, the input documents read ahead, the
+    // result which ended the batch early, if any, and the foreign documents read for the batch,
+    // indexed by their join keys. The index is not set if the input documents must be looked up
+    // one by one.
+    std::deque<Document> _batchedInput;
+    boost::optional<GetNextResult> _batchedInputEnd;
+    std::vector<Document> _batchForeignDocs;
+    boost::optional<ValueUnorderedMap<std::vector<size_t>>> _batchForeignDocsByKey;
+    bool _batchingAbandoned = false;
+
     // Holds 'let' defined variables defined both in this stage and in parent pipelines. These are
     // copied to the '_fromExpCtx' ExpressionContext's 'variables' and 'variablesParseState' for use
     // in foreign pipeline execution.
@@ -317,6 +352,7 @@ private:
     std::unique_ptr<Pipeline, PipelineDeleter> _pipeline;
     boost::optional<Document> _input;
     boost::optional<Document> _nextValue;
+    std::deque<Value> _batchedResultsToUnwind;
 };
 
 }  // namespace mongo
@@ -31,6 +31,7 @@
 
 #include "mongo/db/pipeline/document_source_match.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "mongo/db/exec/document_value/document.h"
@@ -86,14 +87,7 @@ DocumentSource::GetNextResult DocumentSourceMatch::doGetNext() {
 
     auto nextInput = pSource->getNext();
     for (; nextInput.isAdvanced(); nextInput = pSource->getNext()) {
-        // MatchExpression only takes BSON documents, so we have to make one. As an optimization,
-        // only serialize the fields we need to do the match.
-        BSONObj toMatch = _dependencies.needWholeDocument
-            ? nextInput.getDocument().toBson()
-            : document_path_support::documentToBsonWithPaths(nextInput.getDocument(),
-                                                             _dependencies.fields);
-
-        if (_expression->matchesBSON(toMatch)) {
+        if (matches(nextInput.getDocument())) {
             return nextInput;
         }
 
@@ -108,6 +102,37 @@ DocumentSource::GetNextResult DocumentSourceMatch::doGetNext() {
     return nextInput;
 }
 
+boost::optional<DocumentSource::GetNextResult> DocumentSourceMatch::doGetNextBatch(
+    size_t maxBatchSize, std::vector<Document>* batch) {
+    // The user facing error should have been generated earlier.
+    massert(4963500,
+            "Should never call getNextBatch on a $match stage with $text clause",
+            !_isTextQuery);
+
+    const size_t batchStart = batch->size();
+    boost::optional<GetNextResult> end;
+    while (!end && batch->size() == batchStart) {
+        end = pSource->getNextBatch(maxBatchSize, batch);
+
+        // Filter the documents of the input batch in place, moving the ones that match to the
+        // front of the appended range.
+        auto kept = std::remove_if(batch->begin() + batchStart,
+                                   batch->end(),
+                                   [&](const Document& document) { return !matches(document); });
+        batch->erase(kept, batch->end());
+    }
+    return end;
+}
+
+bool DocumentSourceMatch::matches(const Document& document) const {
+    // MatchExpression only takes BSON documents, so we have to make one. As an optimization, only
+    // serialize the fields we need to do the match.
+    BSONObj toMatch = _dependencies.needWholeDocument
+        ? document.toBson()
+        : document_path_support::documentToBsonWithPaths(document, _dependencies.fields);
+    return _expression->matchesBSON(toMatch);
+}
+
 Pipeline::SourceContainer::iterator DocumentSourceMatch::doOptimizeAt(
     Pipeline::SourceContainer::iterator itr, Pipeline::SourceContainer* container) {
     invariant(*itr == this);
@@ -184,12 +184,19 @@ protected:
               other.pExpCtx) {}
 
     GetNextResult doGetNext() override;
+    boost::optional<GetNextResult> doGetNextBatch(size_t maxBatchSize,
+                                                  std::vector<Document>* batch) override;
     DocumentSourceMatch(const BSONObj& query,
                         const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
     BSONObj _predicate;
 
 private:
+    /**
+     * Returns whether 'document' passes this $match.
+     */
+    bool matches(const Document& document) const;
+
     std::unique_ptr<MatchExpression> _expression;
 
     bool _isTextQuery;
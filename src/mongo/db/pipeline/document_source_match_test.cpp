@@ -503,6 +503,60 @@ TEST_F(DocumentSourceMatchTest, ShouldPropagatePauses) {
     ASSERT_TRUE(match->getNext().isEOF());
 }
 
+TEST_F(DocumentSourceMatchTest, ShouldReturnMatchingDocumentsInBatches) {
+    auto match = DocumentSourceMatch::create(BSON("a" << 1), getExpCtx());
+    auto mock = DocumentSourceMock::createForTest({Document{{"a", 1}, {"b", 1}},
+                                                   Document{{"a", 2}, {"b", 2}},
+                                                   Document{{"a", 1}, {"b", 3}},
+                                                   Document{{"a", 2}, {"b", 4}},
+                                                   Document{{"a", 2}, {"b", 5}},
+                                                   Document{{"a", 1}, {"b", 6}}},
+                                                  getExpCtx());
+    match->setSource(mock.get());
+
+    // The first input batch of two documents holds one match.
+    std::vector<Document> batch;
+    ASSERT_FALSE(match->getNextBatch(2, &batch));
+    ASSERT_EQ(batch.size(), 1U);
+    ASSERT_DOCUMENT_EQ(batch[0], (Document{{"a", 1}, {"b", 1}}));
+
+    // An input batch without any match is skipped rather than returned empty.
+    batch.clear();
+    ASSERT_FALSE(match->getNextBatch(2, &batch));
+    ASSERT_EQ(batch.size(), 1U);
+    ASSERT_DOCUMENT_EQ(batch[0], (Document{{"a", 1}, {"b", 3}}));
+    batch.clear();
+    ASSERT_FALSE(match->getNextBatch(2, &batch));
+    ASSERT_EQ(batch.size(), 1U);
+    ASSERT_DOCUMENT_EQ(batch[0], (Document{{"a", 1}, {"b", 6}}));
+
+    batch.clear();
+    auto end = match->getNextBatch(2, &batch);
+    ASSERT_TRUE(end && end->isEOF());
+    ASSERT_TRUE(batch.empty());
+}
+
+TEST_F(DocumentSourceMatchTest, ShouldPropagatePausesWithBatches) {
+    auto match = DocumentSourceMatch::create(BSON("a" << 1), getExpCtx());
+    auto mock =
+        DocumentSourceMock::createForTest({Document{{"a", 1}},
+                                           Document{{"a", 2}},
+                                           DocumentSource::GetNextResult::makePauseExecution(),
+                                           Document{{"a", 1}}},
+                                          getExpCtx());
+    match->setSource(mock.get());
+
+    // The documents which precede a pause are returned along with it.
+    std::vector<Document> batch;
+    auto end = match->getNextBatch(10, &batch);
+    ASSERT_TRUE(end && end->isPaused());
+    ASSERT_EQ(batch.size(), 1U);
+
+    end = match->getNextBatch(10, &batch);
+    ASSERT_TRUE(end && end->isEOF());
+    ASSERT_EQ(batch.size(), 2U);
+}
+
 TEST_F(DocumentSourceMatchTest, ShouldCorrectlyJoinWithSubsequentMatch) {
     const auto match = DocumentSourceMatch::create(BSON("a" << 1), getExpCtx());
     const auto secondMatch = DocumentSourceMatch::create(BSON("b" << 1), getExpCtx());
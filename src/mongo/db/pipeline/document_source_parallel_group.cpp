@@ -0,0 +1,222 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_parallel_group.h"
+
+#include <algorithm>
+
+#include "mongo/db/client.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+#include "mongo/logv2/log.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+namespace {
+
+// The maximum number of worker results waiting to be returned by this stage.
+constexpr size_t kMaxQueuedResults = 1024;
+
+MultiProducerSingleConsumerQueue<Document>::Options makeResultsQueueOptions() {
+    MultiProducerSingleConsumerQueue<Document>::Options options;
+    options.maxQueueDepth = kMaxQueuedResults;
+    return options;
+}
+
+}  // namespace
+
+boost::intrusive_ptr<DocumentSourceParallelGroup> DocumentSourceParallelGroup::create(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    boost::intrusive_ptr<Exchange> exchange,
+    std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> workerPipelines) {
+    return new DocumentSourceParallelGroup(expCtx, std::move(exchange), std::move(workerPipelines));
+}
+
+DocumentSourceParallelGroup::DocumentSourceParallelGroup(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    boost::intrusive_ptr<Exchange> exchange,
+    std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> workerPipelines)
+    : DocumentSource(kStageName, expCtx),
+      _numWorkers(workerPipelines.size()),
+      _exchange(std::move(exchange)),
+      _workerPipelines(std::move(workerPipelines)),
+      _results(makeResultsQueueOptions()) {
+    invariant(_numWorkers > 0);
+    _serializedWorkerPipeline = _workerPipelines.front()->serialize();
+}
+
+DocumentSourceParallelGroup::~DocumentSourceParallelGroup() {
+    stopWorkers();
+}
+
+const char* DocumentSourceParallelGroup::getSourceName() const {
+    return kStageName.rawData();
+}
+
+Value DocumentSourceParallelGroup::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    return Value(DOC(getSourceName() << DOC("workers" << static_cast<long long>(_numWorkers)
+                                                      << "pipeline" << _serializedWorkerPipeline)));
+}
+
+DocumentSource::GetNextResult DocumentSourceParallelGroup::doGetNext() {
+    if (!_workersStarted) {
+        if (!_workerPipelines.front()) {
+            // We were disposed of before running.
+            return GetNextResult::makeEOF();
+        }
+
+        _workersStarted = true;
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            _numRunningWorkers = _numWorkers;
+        }
+        auto serviceContext = pExpCtx->opCtx->getServiceContext();
+        for (size_t workerId = 0; workerId < _numWorkers; ++workerId) {
+            _workerThreads.emplace_back(
+                [this, serviceContext, workerId] { runWorker(serviceContext, workerId); });
+        }
+    }
+
+    try {
+        return _results.pop(pExpCtx->opCtx);
+    } catch (const ExceptionFor<ErrorCodes::ProducerConsumerQueueConsumed>&) {
+        // Every worker has finished and all of their results have been returned.
+    } catch (const ExceptionFor<ErrorCodes::ProducerConsumerQueueEndClosed>&) {
+        // A worker failed, or we were disposed of.
+    }
+
+    stopWorkers();
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    uassertStatusOK(_workerStatus);
+    return GetNextResult::makeEOF();
+}
+
+void DocumentSourceParallelGroup::runWorker(ServiceContext* serviceContext, size_t workerId) {
+    Client::initKillableThread("parallelGroupWorker", serviceContext);
+    auto opCtx = cc().makeOperationContext();
+    auto& pipeline = _workerPipelines[workerId];
+
+    bool stopping;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _workerOpCtxs.push_back(opCtx.get());
+        stopping = _stopping;
+    }
+
+    ON_BLOCK_EXIT([&] {
+        const bool usedDisk = pipeline->usedDisk();
+        pipeline->dispose(opCtx.get());
+        pipeline.get_deleter().dismissDisposal();
+        pipeline.reset();
+
+        stdx::lock_guard<Latch> lk(_mutex);
+        _workersUsedDisk = _workersUsedDisk || usedDisk;
+        _workerOpCtxs.erase(std::find(_workerOpCtxs.begin(), _workerOpCtxs.end(), opCtx.get()));
+        if (--_numRunningWorkers == 0) {
+            _results.closeProducerEnd();
+        }
+    });
+
+    pipeline->reattachToOperationContext(opCtx.get());
+    try {
+        while (!stopping) {
+            auto next = pipeline->getNext();
+            if (!next) {
+                break;
+            }
+            _results.push(std::move(*next), opCtx.get());
+        }
+    } catch (const ExceptionFor<ErrorCodes::ProducerConsumerQueueEndClosed>&) {
+        // Another worker failed, or we were disposed of.
+    } catch (...) {
+        auto status = exceptionToStatus();
+        LOGV2_DEBUG(4972100,
+                    1,
+                    "Parallel $group worker failed",
+                    "workerId"_attr = workerId,
+                    "error"_attr = redact(status));
+
+        _results.closeConsumerEnd();
+        stdx::lock_guard<Latch> lk(_mutex);
+        if (_workerStatus.isOK()) {
+            _workerStatus = status;
+        }
+    }
+}
+
+bool DocumentSourceParallelGroup::usedDisk() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _workersUsedDisk;
+}
+
+void DocumentSourceParallelGroup::stopWorkers() {
+    if (_workerThreads.empty()) {
+        return;
+    }
+
+    _results.closeConsumerEnd();
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _stopping = true;
+        for (auto workerOpCtx : _workerOpCtxs) {
+            stdx::lock_guard<Client> clientLock(*workerOpCtx->getClient());
+            workerOpCtx->getServiceContext()->killOperation(
+                clientLock, workerOpCtx, ErrorCodes::Interrupted);
+        }
+    }
+
+    for (auto&& workerThread : _workerThreads) {
+        workerThread.join();
+    }
+    _workerThreads.clear();
+}
+
+void DocumentSourceParallelGroup::doDispose() {
+    if (_workersStarted) {
+        stopWorkers();
+        return;
+    }
+
+    for (auto&& pipeline : _workerPipelines) {
+        if (pipeline) {
+            pipeline->dispose(pExpCtx->opCtx);
+            pipeline.get_deleter().dismissDisposal();
+            pipeline.reset();
+        }
+    }
+}
+
+}  // namespace mongo
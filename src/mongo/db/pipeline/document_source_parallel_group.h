@@ -0,0 +1,179 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/document_source_exchange.h"
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/producer_consumer_queue.h"
+
+namespace mongo {
+
+/**
+ * Runs several copies of the leading part of a pipeline, each on its own thread, and returns the
+ * union of their results. The copies read their input from a shared Exchange, so that a pipeline
+ * such as [$cursor, $match, $group] can run as N partial [$match, $group] pipelines over disjoint
+ * subsets of the documents from the $cursor, followed by a $group which merges their results.
+ *
+ * The worker threads are started by the first call to getNext() and run to completion, or until
+ * this stage is disposed of. Each worker has its own Client and OperationContext, and the worker
+ * pipelines must not share an ExpressionContext with each other or with the pipeline containing
+ * this stage.
+ */
+class DocumentSourceParallelGroup final : public DocumentSource {
+public:
+    static constexpr StringData kStageName = "$_internalParallelGroup"_sd;
+
+    /**
+     * Creates a stage which runs each of 'workerPipelines' on its own thread. The pipelines must be
+     * detached from any operation context, and read their input from 'exchange'.
+     */
+    static boost::intrusive_ptr<DocumentSourceParallelGroup> create(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        boost::intrusive_ptr<Exchange> exchange,
+        std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> workerPipelines);
+
+    ~DocumentSourceParallelGroup();
+
+    StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        StageConstraints constraints(StreamType::kStreaming,
+                                     PositionRequirement::kFirst,
+                                     HostTypeRequirement::kNone,
+                                     DiskUseRequirement::kNoDiskUse,
+                                     FacetRequirement::kNotAllowed,
+                                     TransactionRequirement::kNotAllowed,
+                                     LookupRequirement::kNotAllowed,
+                                     UnionRequirement::kNotAllowed);
+
+        constraints.requiresInputDocSource = false;
+        return constraints;
+    }
+
+    boost::optional<DistributedPlanLogic> distributedPlanLogic() final {
+        return boost::none;
+    }
+
+    const char* getSourceName() const final;
+
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
+
+    /**
+     * The worker pipelines run under their own operation contexts, so there is nothing to detach.
+     */
+    void detachFromOperationContext() final {}
+    void reattachToOperationContext(OperationContext* opCtx) final {}
+
+    size_t getNumWorkers() const {
+        return _numWorkers;
+    }
+
+    /**
+     * Calls 'fn' with the pipeline whose documents are shared among the workers, such as the
+     * [$cursor] pipeline reading the collection, while no worker is reading from it. Its plan
+     * summary and stats are those of the whole parallel $group.
+     */
+    void inspectInputPipeline(const std::function<void(const Pipeline&)>& fn) const {
+        _exchange->inspectPipeline(fn);
+    }
+
+    /**
+     * Returns whether any of the finished workers spilled to disk.
+     */
+    bool usedDisk() final;
+
+    /**
+     * Returns the pipeline of the worker 'workerId', which must not have been started yet.
+     */
+    const Pipeline* getWorkerPipeline_forTest(size_t workerId) const {
+        invariant(!_workersStarted);
+        return _workerPipelines[workerId].get();
+    }
+
+private:
+    DocumentSourceParallelGroup(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        boost::intrusive_ptr<Exchange> exchange,
+        std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> workerPipelines);
+
+    GetNextResult doGetNext() final;
+
+    void doDispose() final;
+
+    /**
+     * Runs the worker pipeline at 'workerId' to completion on the calling thread, pushing its
+     * results to '_results'.
+     */
+    void runWorker(ServiceContext* serviceContext, size_t workerId);
+
+    /**
+     * Stops the worker threads, if they were started, and waits for them to finish.
+     */
+    void stopWorkers();
+
+    const size_t _numWorkers;
+
+    const boost::intrusive_ptr<Exchange> _exchange;
+
+    // Each worker pipeline is disposed of and reset by the thread which ran it, or by doDispose()
+    // if the workers were never started.
+    std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> _workerPipelines;
+
+    // Serialized form of a worker pipeline, kept for explain and $currentOp since the worker
+    // pipelines themselves are disposed of by the worker threads.
+    std::vector<Value> _serializedWorkerPipeline;
+
+    MultiProducerSingleConsumerQueue<Document> _results;
+
+    std::vector<stdx::thread> _workerThreads;
+    bool _workersStarted = false;
+
+    // Protects the members below, which are written by the worker threads.
+    Mutex _mutex = MONGO_MAKE_LATCH("DocumentSourceParallelGroup::_mutex");
+
+    // The operation contexts of the running workers, so that they can be interrupted when this
+    // stage is disposed of before they finish.
+    std::vector<OperationContext*> _workerOpCtxs;
+    bool _stopping = false;
+
+    size_t _numRunningWorkers = 0;
+
+    // Whether any of the finished workers spilled to disk.
+    bool _workersUsedDisk = false;
+
+    // The first error encountered by any of the workers.
+    Status _workerStatus = Status::OK();
+};
+
+}  // namespace mongo
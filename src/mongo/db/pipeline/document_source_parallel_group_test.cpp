@@ -0,0 +1,237 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/document_value/document_value_test_util.h"
+#include "mongo/db/pipeline/aggregation_context_fixture.h"
+#include "mongo/db/pipeline/document_source_exchange.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/document_source_mock.h"
+#include "mongo/db/pipeline/document_source_parallel_group.h"
+#include "mongo/db/pipeline/document_source_sort.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/pipeline/pipeline_d.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+class DocumentSourceParallelGroupTest : public AggregationContextFixture {
+protected:
+    /**
+     * Returns a stage which runs 'numWorkers' partial groups of 'groupSpec' over the documents of
+     * 'source', distributed among them by an Exchange. If 'spillDir' is given, the partial groups
+     * spill to it as soon as they hold more than a few bytes.
+     */
+    boost::intrusive_ptr<DocumentSourceParallelGroup> makeParallelGroup(
+        boost::intrusive_ptr<DocumentSourceMock> source,
+        size_t numWorkers,
+        BSONObj groupSpec,
+        boost::optional<std::string> spillDir = boost::none) {
+        ExchangeSpec spec;
+        spec.setPolicy(ExchangePolicyEnum::kRoundRobin);
+        spec.setConsumers(numWorkers);
+        spec.setBufferSize(1024);
+        boost::intrusive_ptr<Exchange> exchange =
+            new Exchange(spec, Pipeline::create({source}, source->getContext()));
+
+        std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> workerPipelines;
+        for (size_t workerId = 0; workerId < numWorkers; ++workerId) {
+            boost::intrusive_ptr<ExpressionContext> workerExpCtx =
+                new ExpressionContextForTest(getOpCtx(), getExpCtx()->ns);
+            workerExpCtx->needsMerge = true;
+            auto group = boost::static_pointer_cast<DocumentSourceGroup>(
+                DocumentSourceGroup::createFromBson(groupSpec.firstElement(), workerExpCtx));
+            if (spillDir) {
+                workerExpCtx->tempDir = *spillDir;
+                workerExpCtx->allowDiskUse = true;
+                group->setMaxMemoryUsageBytes(100);
+            }
+            workerPipelines.push_back(Pipeline::create(
+                {new DocumentSourceExchange(workerExpCtx, exchange, workerId, nullptr), group},
+                workerExpCtx));
+            workerPipelines.back()->detachFromOperationContext();
+        }
+        return DocumentSourceParallelGroup::create(
+            getExpCtx(), std::move(exchange), std::move(workerPipelines));
+    }
+
+    boost::intrusive_ptr<DocumentSourceMock> makeSource(int numDocs) {
+        // The source needs an ExpressionContext of its own, as the workers attach it to their
+        // operation contexts.
+        boost::intrusive_ptr<ExpressionContext> sourceExpCtx =
+            new ExpressionContextForTest(getOpCtx(), getExpCtx()->ns);
+        auto source = DocumentSourceMock::createForTest(sourceExpCtx);
+        for (int i = 0; i < numDocs; ++i) {
+            source->emplace_back(Document{{"a", i % 10}, {"b", i}});
+        }
+        return source;
+    }
+};
+
+TEST_F(DocumentSourceParallelGroupTest, MergedPartialGroupsMatchSerialGroup) {
+    const int numDocs = 1000;
+    const auto groupSpec =
+        BSON("$group" << BSON("_id"
+                              << "$a"
+                              << "total" << BSON("$sum"
+                                                 << "$b")
+                              << "avg" << BSON("$avg"
+                                               << "$b")));
+
+    auto parallelGroup = makeParallelGroup(makeSource(numDocs), 4, groupSpec);
+    ASSERT_EQ(parallelGroup->getNumWorkers(), 4U);
+
+    auto mergingGroup = DocumentSourceGroup::createFromBson(groupSpec.firstElement(), getExpCtx())
+                            ->distributedPlanLogic()
+                            ->mergingStage;
+    auto pipeline = Pipeline::create({parallelGroup, mergingGroup}, getExpCtx());
+
+    std::map<int, Document> results;
+    while (auto next = pipeline->getNext()) {
+        results.emplace(next->getField("_id").getInt(), *next);
+    }
+
+    ASSERT_EQ(results.size(), 10U);
+    for (int a = 0; a < 10; ++a) {
+        // The documents with 'a' equal to this key have 'b' values a, a + 10, ..., a + 990.
+        const int total = 100 * a + 10 * (99 * 100 / 2);
+        ASSERT_DOCUMENT_EQ(results[a],
+                           (Document{{"_id", a}, {"total", total}, {"avg", total / 100.0}}));
+    }
+    pipeline->dispose(getOpCtx());
+}
+
+TEST_F(DocumentSourceParallelGroupTest, ParallelizeGroupRewritesPipeline) {
+    auto source = makeSource(1000);
+    const auto stageSpecs = {fromjson("{$match: {b: {$gte: 0}}}"),
+                             fromjson("{$group: {_id: '$a', total: {$sum: '$b'}}}"),
+                             fromjson("{$sort: {total: -1}}"),
+                             fromjson("{$limit: 3}")};
+    auto pipeline = Pipeline::parse(stageSpecs, source->getContext());
+    pipeline->addInitialSource(source);
+    pipeline->optimizePipeline();
+
+    pipeline = PipelineD::parallelizeGroup(std::move(pipeline), 4);
+
+    // The merging $group is followed by the $sort, which has absorbed the $limit again.
+    const auto& sources = pipeline->getSources();
+    ASSERT_EQ(sources.size(), 3U);
+    auto parallelGroup = dynamic_cast<DocumentSourceParallelGroup*>(sources.front().get());
+    ASSERT(parallelGroup);
+    ASSERT_EQ(parallelGroup->getNumWorkers(), 4U);
+    ASSERT(dynamic_cast<DocumentSourceGroup*>(std::next(sources.begin())->get()));
+    auto sort = dynamic_cast<DocumentSourceSort*>(sources.back().get());
+    ASSERT(sort);
+    ASSERT(sort->hasLimit());
+    ASSERT_EQ(*sort->getLimit(), 3);
+
+    // The partial groups share the memory limit of the $group.
+    for (size_t workerId = 0; workerId < 4; ++workerId) {
+        auto workerGroup = dynamic_cast<DocumentSourceGroup*>(
+            parallelGroup->getWorkerPipeline_forTest(workerId)->getSources().back().get());
+        ASSERT(workerGroup);
+        ASSERT_EQ(workerGroup->getMaxMemoryUsageBytes(),
+                  static_cast<size_t>(internalDocumentSourceGroupMaxMemoryBytes.load()) / 4);
+    }
+
+    // The totals of the keys 9, 8 and 7 are the largest.
+    for (int a : {9, 8, 7}) {
+        auto next = pipeline->getNext();
+        ASSERT(next);
+        ASSERT_DOCUMENT_EQ(*next, (Document{{"_id", a}, {"total", 100 * a + 10 * (99 * 100 / 2)}}));
+    }
+    ASSERT_FALSE(pipeline->getNext());
+    pipeline->dispose(getOpCtx());
+}
+
+TEST_F(DocumentSourceParallelGroupTest, ParallelizeGroupKeepsOrderDependentAccumulatorsSerial) {
+    auto source = makeSource(100);
+    const auto stageSpecs = {
+        fromjson("{$group: {_id: '$a', total: {$sum: '$b'}, first: {$first: '$b'}}}")};
+    auto pipeline = Pipeline::parse(stageSpecs, source->getContext());
+    pipeline->addInitialSource(source);
+
+    // The source may return its documents in an order which $first depends on.
+    pipeline = PipelineD::parallelizeGroup(std::move(pipeline), 4);
+    const auto& sources = pipeline->getSources();
+    ASSERT_EQ(sources.size(), 2U);
+    ASSERT_EQ(sources.front(), source);
+    ASSERT(dynamic_cast<DocumentSourceGroup*>(sources.back().get()));
+    pipeline->dispose(getOpCtx());
+}
+
+TEST_F(DocumentSourceParallelGroupTest, ReportsInputPipelineAndWorkerDiskUse) {
+    const auto groupSpec = BSON("$group" << BSON("_id"
+                                                 << "$b"));
+    unittest::TempDir tempDir("DocumentSourceParallelGroupTest");
+
+    auto source = makeSource(1000);
+    auto parallelGroup = makeParallelGroup(source, 4, groupSpec, tempDir.path());
+    parallelGroup->inspectInputPipeline([&](const Pipeline& inputPipeline) {
+        ASSERT_EQ(inputPipeline.getSources().size(), 1U);
+        ASSERT_EQ(inputPipeline.getSources().front(), source);
+    });
+    ASSERT_FALSE(parallelGroup->usedDisk());
+
+    size_t numResults = 0;
+    while (parallelGroup->getNext().isAdvanced()) {
+        ++numResults;
+    }
+    ASSERT_EQ(numResults, 1000U);
+    ASSERT_TRUE(parallelGroup->usedDisk());
+    parallelGroup->dispose();
+}
+
+TEST_F(DocumentSourceParallelGroupTest, WorkerErrorIsReported) {
+    const auto groupSpec = BSON("$group" << BSON("_id"
+                                                 << "$a"
+                                                 << "total"
+                                                 << BSON("$sum" << BSON("$divide" << BSON_ARRAY(
+                                                                            1 << "$a")))));
+
+    auto parallelGroup = makeParallelGroup(makeSource(100), 3, groupSpec);
+    ASSERT_THROWS_CODE(parallelGroup->getNext(), AssertionException, 16608);
+    parallelGroup->dispose();
+}
+
+TEST_F(DocumentSourceParallelGroupTest, CanBeDisposedOfBeforeRunning) {
+    const auto groupSpec = BSON("$group" << BSON("_id"
+                                                 << "$a"));
+
+    auto parallelGroup = makeParallelGroup(makeSource(100), 3, groupSpec);
+    parallelGroup->dispose();
+    ASSERT_TRUE(parallelGroup->getNext().isEOF());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -68,6 +68,20 @@ DocumentSource::GetNextResult DocumentSourceSingleDocumentTransformation::doGetN
     return _parsedTransform->applyTransformation(input.releaseDocument());
 }
 
+boost::optional<DocumentSource::GetNextResult>
+DocumentSourceSingleDocumentTransformation::doGetNextBatch(size_t maxBatchSize,
+                                                           std::vector<Document>* batch) {
+    const size_t batchStart = batch->size();
+    auto end = pSource->getNextBatch(maxBatchSize, batch);
+
+    // Replace each input document of the batch with its transformed version.
+    for (size_t i = batchStart; i < batch->size(); ++i) {
+        auto input = std::move((*batch)[i]);
+        (*batch)[i] = _parsedTransform->applyTransformation(input);
+    }
+    return end;
+}
+
 intrusive_ptr<DocumentSource> DocumentSourceSingleDocumentTransformation::optimize() {
     _parsedTransform->optimize();
     return this;
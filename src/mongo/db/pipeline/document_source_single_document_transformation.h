@@ -94,8 +94,14 @@ public:
         return *_parsedTransform;
     }
 
+    auto& getTransformer() {
+        return *_parsedTransform;
+    }
+
 protected:
     GetNextResult doGetNext() final;
+    boost::optional<GetNextResult> doGetNextBatch(size_t maxBatchSize,
+                                                  std::vector<Document>* batch) final;
     void doDispose() final;
 
     Pipeline::SourceContainer::iterator doOptimizeAt(Pipeline::SourceContainer::iterator itr,
@@ -32,16 +32,27 @@
 #include "mongo/db/pipeline/document_source_sort.h"
 
 #include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <limits>
 
 #include "mongo/base/exact_cast.h"
+#include "mongo/db/exec/add_fields_projection_executor.h"
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/value.h"
+#include "mongo/db/exec/inclusion_projection_executor.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/matcher/expression_algo.h"
+#include "mongo/db/pipeline/accumulation_statement.h"
+#include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/document_source_single_document_transformation.h"
 #include "mongo/db/pipeline/document_source_skip.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/query/collation/collation_index_key.h"
+#include "mongo/db/server_options.h"
 #include "mongo/platform/overflow_arithmetic.h"
 #include "mongo/s/query/document_source_merge_cursors.h"
 
@@ -159,6 +170,167 @@ boost::optional<long long> DocumentSourceSort::extractLimitForPushdown(
     return minLimit;
 }
 
+namespace {
+
+using TransformerType = TransformerInterface::TransformerType;
+
+/**
+ * Returns the count 'n' if 'expr' is {$slice: ["$<fieldName>", <n>]}.
+ */
+boost::optional<long long> getSliceCountOfField(const Expression* expr,
+                                                const std::string& fieldName) {
+    auto slice = dynamic_cast<const ExpressionSlice*>(expr);
+    if (!slice || slice->getChildren().size() != 2) {
+        return boost::none;
+    }
+    auto array = dynamic_cast<const ExpressionFieldPath*>(slice->getChildren()[0].get());
+    auto count = dynamic_cast<const ExpressionConstant*>(slice->getChildren()[1].get());
+    if (!array || !count || !array->isRootFieldPath() ||
+        array->getFieldPath().getPathLength() != 2 ||
+        array->getFieldPath().getFieldName(1) != fieldName) {
+        return boost::none;
+    }
+    const auto value = count->getValue();
+    if (!value.integral64Bit() || value.coerceToLong() == 0 ||
+        value.coerceToLong() == std::numeric_limits<long long>::min()) {
+        return boost::none;
+    }
+    return value.coerceToLong();
+}
+
+/**
+ * Returns the count 'n' of largest magnitude if 'stage' reads the field 'fieldName' only through
+ * {$slice: ["$<fieldName>", <n>]} expressions whose counts all have the same sign, and does not
+ * let the field itself through. Only the first 'n' elements of the field, or the last '-n' ones,
+ * are then ever observed.
+ */
+boost::optional<long long> getSliceCountOfField(DocumentSource* stage,
+                                                const std::string& fieldName) {
+    auto transformation = dynamic_cast<DocumentSourceSingleDocumentTransformation*>(stage);
+    if (!transformation) {
+        return boost::none;
+    }
+
+    projection_executor::InclusionNode* root = nullptr;
+    if (transformation->getType() == TransformerType::kComputedProjection) {
+        // An $addFields lets the field through unless it overwrites it.
+        auto modifiedPaths = stage->getModifiedPaths();
+        if (modifiedPaths.type != DocumentSource::GetModPathsReturn::Type::kFiniteSet ||
+            (!modifiedPaths.paths.count(fieldName) && !modifiedPaths.renames.count(fieldName))) {
+            return boost::none;
+        }
+        root = &static_cast<projection_executor::AddFieldsProjectionExecutor&>(
+                    transformation->getTransformer())
+                    .getRoot();
+    } else if (transformation->getType() == TransformerType::kInclusionProjection) {
+        root = static_cast<projection_executor::InclusionProjectionExecutor&>(
+                   transformation->getTransformer())
+                   .getRoot();
+    } else {
+        return boost::none;
+    }
+
+    std::vector<std::pair<intrusive_ptr<Expression>*, long long>> slices;
+    std::function<void(intrusive_ptr<Expression>*)> findSlices = [&](auto slot) {
+        if (auto count = getSliceCountOfField(slot->get(), fieldName)) {
+            slices.emplace_back(slot, *count);
+            return;
+        }
+        for (auto&& child : (*slot)->getChildren()) {
+            if (child) {
+                findSlices(&child);
+            }
+        }
+    };
+    root->visitExpressions(findSlices);
+    if (slices.empty()) {
+        return boost::none;
+    }
+
+    long long count = slices.front().second;
+    for (auto&& slice : slices) {
+        if ((slice.second > 0) != (count > 0)) {
+            return boost::none;
+        }
+        if (std::abs(slice.second) > std::abs(count)) {
+            count = slice.second;
+        }
+    }
+
+    // Any other read of the field shows up in the dependencies of the stage once the $slice
+    // expressions are taken out of it.
+    std::vector<intrusive_ptr<Expression>> originals;
+    for (auto&& slice : slices) {
+        originals.push_back(*slice.first);
+        *slice.first = ExpressionConstant::create(stage->getContext().get(), Value());
+    }
+    DepsTracker deps;
+    stage->getDependencies(&deps);
+    for (size_t i = 0; i < slices.size(); ++i) {
+        *slices[i].first = originals[i];
+    }
+
+    if (deps.needWholeDocument) {
+        return boost::none;
+    }
+    for (auto&& field : deps.fields) {
+        if (field == fieldName || expression::isPathPrefixOf(field, fieldName) ||
+            expression::isPathPrefixOf(fieldName, field)) {
+            return boost::none;
+        }
+    }
+    return count;
+}
+
+/**
+ * Replaces each $push of 'group' whose result 'next' only reads through a $slice by a $topN, or a
+ * $bottomN for a negative $slice, over 'sortPattern'. The accumulator then keeps only the elements
+ * which the $slice retains rather than whole groups. Returns whether 'group' no longer depends on
+ * the order of its input, so that the $sort in front of it can be dropped.
+ */
+bool rewritePushesAsTopBottomN(const SortPattern& sortPattern,
+                               DocumentSourceGroup* group,
+                               DocumentSource* next) {
+    if (group->doingMerge()) {
+        return false;
+    }
+    for (auto&& part : sortPattern) {
+        if (!part.fieldPath) {
+            return false;
+        }
+    }
+
+    const auto sortBy =
+        sortPattern.serialize(SortPattern::SortKeySerialization::kForPipelineSerialization)
+            .toBson();
+    auto expCtx = group->getContext().get();
+    bool rewroteAny = false;
+    bool orderInsensitive = true;
+
+    // Iterate over a copy, since replacing an accumulator rebuilds the list of the $group.
+    const auto accumulatedFields = group->getAccumulatedFields();
+    for (auto&& accumulatedField : accumulatedFields) {
+        auto accumulator = accumulatedField.makeAccumulator();
+        if (StringData(accumulator->getOpName()) == "$push"_sd) {
+            if (auto count = getSliceCountOfField(next, accumulatedField.fieldName)) {
+                group->replaceAccumulator({accumulatedField.fieldName,
+                                           AccumulatorTopBottomN::makeAccumulationExpression(
+                                               expCtx,
+                                               *count < 0,
+                                               std::abs(*count),
+                                               sortBy,
+                                               accumulatedField.expr.argument)});
+                rewroteAny = true;
+                continue;
+            }
+        }
+        orderInsensitive = orderInsensitive && accumulator->isCommutative();
+    }
+    return rewroteAny && orderInsensitive;
+}
+
+}  // namespace
+
 Pipeline::SourceContainer::iterator DocumentSourceSort::doOptimizeAt(
     Pipeline::SourceContainer::iterator itr, Pipeline::SourceContainer* container) {
     invariant(*itr == this);
@@ -173,6 +345,21 @@ Pipeline::SourceContainer::iterator DocumentSourceSort::doOptimizeAt(
         return container->end();
     }
 
+    // The idiom {$sort}, {$group: {<field>: {$push: ...}}}, {$project: {<field>: {$slice: ...}}}
+    // keeps the first elements of each group in the order of the $sort, which a $topN does while
+    // holding only those elements. Nodes older than 4.5.1 cannot parse $topN, so the rewritten
+    // $group must not be sent to them.
+    auto group = dynamic_cast<DocumentSourceGroup*>(std::next(itr)->get());
+    const bool canUseTopBottomN = serverGlobalParams.featureCompatibility.isVersion(
+        ServerGlobalParams::FeatureCompatibility::Version::kVersion451);
+    if (group && canUseTopBottomN && !_sortExecutor->getLimit() &&
+        std::next(itr, 2) != container->end() &&
+        rewritePushesAsTopBottomN(getSortKeyPattern(), group, std::next(itr, 2)->get())) {
+        Pipeline::SourceContainer::iterator ret = std::next(itr);
+        container->erase(itr);
+        return ret;
+    }
+
     if (auto nextSort = dynamic_cast<DocumentSourceSort*>((*std::next(itr)).get())) {
         // If subsequent $sort stage exists, optimize by erasing the initial one.
         // Since $sort is not guaranteed to be stable, we can blindly remove the first $sort.
@@ -205,6 +205,26 @@ DocumentSource::GetNextResult DocumentSourceUnwind::doGetNext() {
     return nextOut;
 }
 
+boost::optional<DocumentSource::GetNextResult> DocumentSourceUnwind::doGetNextBatch(
+    size_t maxBatchSize, std::vector<Document>* batch) {
+    // Unlike the stages which map each input to at most one output, an input document here may
+    // produce any number of outputs, so inputs are pulled one at a time as the unwinder drains.
+    const size_t batchEnd = batch->size() + maxBatchSize;
+    while (batch->size() < batchEnd) {
+        auto nextOut = _unwinder->getNext();
+        if (nextOut.isEOF()) {
+            auto nextInput = pSource->getNext();
+            if (!nextInput.isAdvanced()) {
+                return nextInput;
+            }
+            _unwinder->resetDocument(nextInput.releaseDocument());
+            continue;
+        }
+        batch->push_back(nextOut.releaseDocument());
+    }
+    return boost::none;
+}
+
 DocumentSource::GetModPathsReturn DocumentSourceUnwind::getModifiedPaths() const {
     std::set<std::string> modifiedFields{_unwindPath.fullPath()};
     if (_indexPath) {
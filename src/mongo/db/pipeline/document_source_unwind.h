@@ -99,6 +99,8 @@ private:
                          const boost::optional<FieldPath>& includeArrayIndex);
 
     GetNextResult doGetNext() final;
+    boost::optional<GetNextResult> doGetNextBatch(size_t maxBatchSize,
+                                                  std::vector<Document>* batch) final;
 
     // Configuration state.
     const FieldPath _unwindPath;
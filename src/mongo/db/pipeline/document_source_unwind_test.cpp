@@ -708,6 +708,36 @@ TEST_F(UnwindStageTest, ShouldPropagatePauses) {
     ASSERT_TRUE(unwind->getNext().isEOF());
 }
 
+TEST_F(UnwindStageTest, ShouldSplitUnwoundArraysAcrossBatches) {
+    const bool includeNullIfEmptyOrMissing = false;
+    const boost::optional<std::string> includeArrayIndex = boost::none;
+    auto unwind = DocumentSourceUnwind::create(
+        getExpCtx(), "array", includeNullIfEmptyOrMissing, includeArrayIndex);
+    auto source = DocumentSourceMock::createForTest(
+        {Document{{"array", vector<Value>{Value(1), Value(2), Value(3)}}},
+         Document{{"array", vector<Value>{}}},
+         DocumentSource::GetNextResult::makePauseExecution(),
+         Document{{"array", vector<Value>{Value(4)}}}},
+        getExpCtx());
+    unwind->setSource(source.get());
+
+    vector<Document> batch;
+    ASSERT_FALSE(unwind->getNextBatch(2, &batch));
+    ASSERT_EQ(batch.size(), 2U);
+
+    // The rest of the first array is returned along with the pause that follows it.
+    auto end = unwind->getNextBatch(2, &batch);
+    ASSERT_TRUE(end && end->isPaused());
+    ASSERT_EQ(batch.size(), 3U);
+
+    end = unwind->getNextBatch(2, &batch);
+    ASSERT_TRUE(end && end->isEOF());
+    ASSERT_EQ(batch.size(), 4U);
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_DOCUMENT_EQ(batch[i], (Document{{"array", i + 1}}));
+    }
+}
+
 TEST_F(UnwindStageTest, UnwindOnlyModifiesUnwoundPathWhenNotIncludingIndex) {
     const bool includeNullIfEmptyOrMissing = false;
     const boost::optional<std::string> includeArrayIndex = boost::none;
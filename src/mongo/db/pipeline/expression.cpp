@@ -35,6 +35,7 @@
 #include <algorithm>
 #include <boost/algorithm/string.hpp>
 #include <cstdio>
+#include <numeric>
 #include <pcrecpp.h>
 #include <utility>
 #include <vector>
@@ -191,6 +192,15 @@ bool Expression::isExpressionName(StringData name) {
     return parserMap.find(name) != parserMap.end();
 }
 
+void Expression::evaluateBatch(const std::vector<Document>& roots,
+                               Variables* variables,
+                               std::vector<Value>* results) const {
+    results->reserve(results->size() + roots.size());
+    for (auto&& root : roots) {
+        results->push_back(evaluate(root, variables));
+    }
+}
+
 namespace {
 /**
  * UTF-8 multi-byte code points consist of one leading byte of the form 11xxxxxx, and potentially
@@ -262,78 +272,151 @@ const char* ExpressionAbs::getOpName() const {
 
 /* ------------------------- ExpressionAdd ----------------------------- */
 
-Value ExpressionAdd::evaluate(const Document& root, Variables* variables) const {
-    // We'll try to return the narrowest possible result value while avoiding overflow, loss
-    // of precision due to intermediate rounding or implicit use of decimal types. To do that,
-    // compute a compensated sum for non-decimal values and a separate decimal sum for decimal
-    // values, and track the current narrowest type.
-    DoubleDoubleSummation nonDecimalTotal;
-    Decimal128 decimalTotal;
-    BSONType totalType = NumberInt;
-    bool haveDate = false;
-
-    const size_t n = _children.size();
-    for (size_t i = 0; i < n; ++i) {
-        Value val = _children[i]->evaluate(root, variables);
+namespace {
 
+/**
+ * Accumulates the operands of an $add. We'll try to return the narrowest possible result value
+ * while avoiding overflow, loss of precision due to intermediate rounding or implicit use of
+ * decimal types. To do that, compute a compensated sum for non-decimal values and a separate
+ * decimal sum for decimal values, and track the current narrowest type.
+ */
+class AddState {
+public:
+    /**
+     * Adds 'val' to the total. Returns false if 'val' is nullish, in which case the result of the
+     * $add is null and the remaining operands must not be evaluated.
+     */
+    bool add(const Value& val) {
         switch (val.getType()) {
             case NumberDecimal:
-                decimalTotal = decimalTotal.add(val.getDecimal());
-                totalType = NumberDecimal;
+                _decimalTotal = _decimalTotal.add(val.getDecimal());
+                _totalType = NumberDecimal;
                 break;
             case NumberDouble:
-                nonDecimalTotal.addDouble(val.getDouble());
-                if (totalType != NumberDecimal)
-                    totalType = NumberDouble;
+                _nonDecimalTotal.addDouble(val.getDouble());
+                if (_totalType != NumberDecimal)
+                    _totalType = NumberDouble;
                 break;
             case NumberLong:
-                nonDecimalTotal.addLong(val.getLong());
-                if (totalType == NumberInt)
-                    totalType = NumberLong;
+                _nonDecimalTotal.addLong(val.getLong());
+                if (_totalType == NumberInt)
+                    _totalType = NumberLong;
                 break;
             case NumberInt:
-                nonDecimalTotal.addDouble(val.getInt());
+                _nonDecimalTotal.addDouble(val.getInt());
                 break;
             case Date:
-                uassert(16612, "only one date allowed in an $add expression", !haveDate);
-                haveDate = true;
-                nonDecimalTotal.addLong(val.getDate().toMillisSinceEpoch());
+                uassert(16612, "only one date allowed in an $add expression", !_haveDate);
+                _haveDate = true;
+                _nonDecimalTotal.addLong(val.getDate().toMillisSinceEpoch());
                 break;
             default:
                 uassert(16554,
                         str::stream() << "$add only supports numeric or date types, not "
                                       << typeName(val.getType()),
                         val.nullish());
-                return Value(BSONNULL);
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Returns the sum of all of the operands added so far.
+     */
+    Value getValue() const {
+        if (_haveDate) {
+            int64_t longTotal;
+            if (_totalType == NumberDecimal) {
+                longTotal = _decimalTotal.add(_nonDecimalTotal.getDecimal()).toLong();
+            } else {
+                uassert(ErrorCodes::Overflow, "date overflow in $add", _nonDecimalTotal.fitsLong());
+                longTotal = _nonDecimalTotal.getLong();
+            }
+            return Value(Date_t::fromMillisSinceEpoch(longTotal));
+        }
+        switch (_totalType) {
+            case NumberDecimal:
+                return Value(_decimalTotal.add(_nonDecimalTotal.getDecimal()));
+            case NumberLong:
+                dassert(_nonDecimalTotal.isInteger());
+                if (_nonDecimalTotal.fitsLong())
+                    return Value(_nonDecimalTotal.getLong());
+            // Fallthrough.
+            case NumberInt:
+                if (_nonDecimalTotal.fitsLong())
+                    return Value::createIntOrLong(_nonDecimalTotal.getLong());
+            // Fallthrough.
+            case NumberDouble:
+                return Value(_nonDecimalTotal.getDouble());
+            default:
+                massert(16417, "$add resulted in a non-numeric type", false);
+        }
+    }
+
+private:
+    DoubleDoubleSummation _nonDecimalTotal;
+    Decimal128 _decimalTotal;
+    BSONType _totalType = NumberInt;
+    bool _haveDate = false;
+};
+
+}  // namespace
+
+Value ExpressionAdd::evaluate(const Document& root, Variables* variables) const {
+    AddState total;
+    for (auto&& child : _children) {
+        if (!total.add(child->evaluate(root, variables))) {
+            return Value(BSONNULL);
         }
     }
+    return total.getValue();
+}
 
-    if (haveDate) {
-        int64_t longTotal;
-        if (totalType == NumberDecimal) {
-            longTotal = decimalTotal.add(nonDecimalTotal.getDecimal()).toLong();
+void ExpressionAdd::evaluateBatch(const std::vector<Document>& roots,
+                                  Variables* variables,
+                                  std::vector<Value>* results) const {
+    std::vector<AddState> totals(roots.size());
+
+    // The documents whose sum is not yet known to be null. Each operand is only evaluated for
+    // these, as evaluate() stops at the first nullish operand.
+    std::vector<size_t> live(roots.size());
+    std::iota(live.begin(), live.end(), 0);
+
+    std::vector<Document> liveRoots;
+    std::vector<Value> operands;
+    for (auto&& child : _children) {
+        if (live.empty()) {
+            break;
+        }
+
+        operands.clear();
+        if (live.size() == roots.size()) {
+            child->evaluateBatch(roots, variables, &operands);
         } else {
-            uassert(ErrorCodes::Overflow, "date overflow in $add", nonDecimalTotal.fitsLong());
-            longTotal = nonDecimalTotal.getLong();
+            liveRoots.clear();
+            for (auto row : live) {
+                liveRoots.push_back(roots[row]);
+            }
+            child->evaluateBatch(liveRoots, variables, &operands);
+        }
+
+        size_t numLive = 0;
+        for (size_t i = 0; i < live.size(); ++i) {
+            if (totals[live[i]].add(operands[i])) {
+                live[numLive++] = live[i];
+            }
         }
-        return Value(Date_t::fromMillisSinceEpoch(longTotal));
+        live.resize(numLive);
     }
-    switch (totalType) {
-        case NumberDecimal:
-            return Value(decimalTotal.add(nonDecimalTotal.getDecimal()));
-        case NumberLong:
-            dassert(nonDecimalTotal.isInteger());
-            if (nonDecimalTotal.fitsLong())
-                return Value(nonDecimalTotal.getLong());
-        // Fallthrough.
-        case NumberInt:
-            if (nonDecimalTotal.fitsLong())
-                return Value::createIntOrLong(nonDecimalTotal.getLong());
-        // Fallthrough.
-        case NumberDouble:
-            return Value(nonDecimalTotal.getDouble());
-        default:
-            massert(16417, "$add resulted in a non-numeric type", false);
+
+    // Rows which dropped out of 'live' early have a null result.
+    std::vector<bool> isLive(roots.size(), false);
+    for (auto row : live) {
+        isLive[row] = true;
+    }
+    results->reserve(results->size() + roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        results->push_back(isLive[row] ? totals[row].getValue() : Value(BSONNULL));
     }
 }
 
@@ -871,7 +954,24 @@ static const CmpLookup cmpLookup[7] = {
 Value ExpressionCompare::evaluate(const Document& root, Variables* variables) const {
     Value pLeft(_children[0]->evaluate(root, variables));
     Value pRight(_children[1]->evaluate(root, variables));
+    return compareValues(pLeft, pRight);
+}
+
+void ExpressionCompare::evaluateBatch(const std::vector<Document>& roots,
+                                      Variables* variables,
+                                      std::vector<Value>* results) const {
+    std::vector<Value> left;
+    std::vector<Value> right;
+    _children[0]->evaluateBatch(roots, variables, &left);
+    _children[1]->evaluateBatch(roots, variables, &right);
+
+    results->reserve(results->size() + roots.size());
+    for (size_t row = 0; row < roots.size(); ++row) {
+        results->push_back(compareValues(left[row], right[row]));
+    }
+}
 
+Value ExpressionCompare::compareValues(const Value& pLeft, const Value& pRight) const {
     int cmp = getExpressionContext()->getValueComparator().compare(pLeft, pRight);
 
     // Make cmp one of 1, 0, or -1.
@@ -956,6 +1056,37 @@ Value ExpressionCond::evaluate(const Document& root, Variables* variables) const
     return _children[idx]->evaluate(root, variables);
 }
 
+void ExpressionCond::evaluateBatch(const std::vector<Document>& roots,
+                                   Variables* variables,
+                                   std::vector<Value>* results) const {
+    std::vector<Value> conds;
+    _children[0]->evaluateBatch(roots, variables, &conds);
+
+    // Split the batch by branch, so that each branch is only evaluated for the documents which
+    // take it, exactly as evaluate() would.
+    std::vector<size_t> rowsByBranch[2];
+    std::vector<Document> rootsByBranch[2];
+    for (size_t row = 0; row < roots.size(); ++row) {
+        const int branch = conds[row].coerceToBool() ? 0 : 1;
+        rowsByBranch[branch].push_back(row);
+        rootsByBranch[branch].push_back(roots[row]);
+    }
+
+    const size_t firstResult = results->size();
+    results->resize(firstResult + roots.size());
+    std::vector<Value> branchResults;
+    for (int branch = 0; branch < 2; ++branch) {
+        if (rowsByBranch[branch].empty()) {
+            continue;
+        }
+        branchResults.clear();
+        _children[branch + 1]->evaluateBatch(rootsByBranch[branch], variables, &branchResults);
+        for (size_t i = 0; i < branchResults.size(); ++i) {
+            (*results)[firstResult + rowsByBranch[branch][i]] = std::move(branchResults[i]);
+        }
+    }
+}
+
 intrusive_ptr<Expression> ExpressionCond::parse(ExpressionContext* const expCtx,
                                                 BSONElement expr,
                                                 const VariablesParseState& vps) {
@@ -1025,6 +1156,12 @@ Value ExpressionConstant::evaluate(const Document& root, Variables* variables) c
     return _value;
 }
 
+void ExpressionConstant::evaluateBatch(const std::vector<Document>& roots,
+                                       Variables* variables,
+                                       std::vector<Value>* results) const {
+    results->insert(results->end(), roots.size(), _value);
+}
+
 Value ExpressionConstant::serialize(bool explain) const {
     return serializeConstant(_value);
 }
@@ -2175,6 +2312,23 @@ Value ExpressionFieldPath::evaluate(const Document& root, Variables* variables)
     }
 }
 
+void ExpressionFieldPath::evaluateBatch(const std::vector<Document>& roots,
+                                        Variables* variables,
+                                        std::vector<Value>* results) const {
+    results->reserve(results->size() + roots.size());
+    if (_variable == Variables::kRootId && _fieldPath.getPathLength() > 1) {
+        // ROOT is always a document so use optimized code path
+        for (auto&& root : roots) {
+            results->push_back(evaluatePath(1, root));
+        }
+        return;
+    }
+
+    for (auto&& root : roots) {
+        results->push_back(evaluate(root, variables));
+    }
+}
+
 Value ExpressionFieldPath::serialize(bool explain) const {
     if (_fieldPath.getFieldName(0) == "CURRENT" && _fieldPath.getPathLength() > 1) {
         // use short form for "$$CURRENT.foo" but not just "$$CURRENT"
@@ -153,6 +153,18 @@ public:
      */
     virtual Value evaluate(const Document& root, Variables* variables) const = 0;
 
+    /**
+     * Evaluates the expression with respect to each Document in 'roots', appending one result per
+     * document to 'results' in the same order. The default implementation calls evaluate() once
+     * per document. Expressions which can share work across a batch, such as dispatching to their
+     * children once per batch rather than once per document, override it. If evaluating the batch
+     * throws, the error may come from any of its documents, not necessarily the first one that
+     * fails.
+     */
+    virtual void evaluateBatch(const std::vector<Document>& roots,
+                               Variables* variables,
+                               std::vector<Value>* results) const;
+
     /**
      * Returns information about the paths computed by this expression. This only needs to be
      * overridden by expressions that have renaming semantics, where optimization code could take
@@ -522,6 +534,9 @@ class ExpressionConstant final : public Expression {
 public:
     boost::intrusive_ptr<Expression> optimize() final;
     Value evaluate(const Document& root, Variables* variables) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       Variables* variables,
+                       std::vector<Value>* results) const final;
     Value serialize(bool explain) const final;
 
     const char* getOpName() const;
@@ -747,6 +762,9 @@ public:
         : ExpressionVariadic<ExpressionAdd>(expCtx) {}
 
     Value evaluate(const Document& root, Variables* variables) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       Variables* variables,
+                       std::vector<Value>* results) const final;
     const char* getOpName() const final;
 
     bool isAssociative() const final {
@@ -980,6 +998,9 @@ public:
         : ExpressionFixedArity<ExpressionCompare, 2>(expCtx), cmpOp(cmpOp) {}
 
     Value evaluate(const Document& root, Variables* variables) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       Variables* variables,
+                       std::vector<Value>* results) const final;
     const char* getOpName() const final;
 
     CmpOp getOp() const {
@@ -1002,6 +1023,11 @@ public:
     }
 
 private:
+    /**
+     * Compares the already evaluated operands 'left' and 'right' according to 'cmpOp'.
+     */
+    Value compareValues(const Value& left, const Value& right) const;
+
     CmpOp cmpOp;
 };
 
@@ -1047,6 +1073,9 @@ public:
     explicit ExpressionCond(ExpressionContext* const expCtx) : Base(expCtx) {}
 
     Value evaluate(const Document& root, Variables* variables) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       Variables* variables,
+                       std::vector<Value>* results) const final;
     const char* getOpName() const final;
 
     static boost::intrusive_ptr<Expression> parse(ExpressionContext* const expCtx,
@@ -1327,6 +1356,9 @@ public:
 
     boost::intrusive_ptr<Expression> optimize() final;
     Value evaluate(const Document& root, Variables* variables) const final;
+    void evaluateBatch(const std::vector<Document>& roots,
+                       Variables* variables,
+                       std::vector<Value>* results) const final;
     Value serialize(bool explain) const final;
 
     /*
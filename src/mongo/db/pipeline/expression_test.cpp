@@ -707,6 +707,116 @@ TEST(ExpressionConstantTest, ConstantOfValueMissingSerializesToRemoveSystemVar)
 
 }  // namespace Constant
 
+namespace EvaluateBatch {
+
+/**
+ * Asserts that evaluating the expression 'spec' over 'roots' as a batch produces the same results
+ * as evaluating it over each of them in turn.
+ */
+void assertBatchMatchesRowByRow(const BSONObj& spec, const std::vector<Document>& roots) {
+    auto expCtx = ExpressionContextForTest{};
+    VariablesParseState vps = expCtx.variablesParseState;
+    auto expr = Expression::parseOperand(&expCtx, spec.firstElement(), vps);
+
+    std::vector<Value> results{Value("existing result"_sd)};
+    expr->evaluateBatch(roots, &expCtx.variables, &results);
+    ASSERT_EQ(results.size(), roots.size() + 1);
+    ASSERT_VALUE_EQ(results[0], Value("existing result"_sd));
+    for (size_t i = 0; i < roots.size(); ++i) {
+        ASSERT_VALUE_EQ(results[i + 1], expr->evaluate(roots[i], &expCtx.variables));
+    }
+}
+
+const std::vector<Document> kRoots{Document{{"a", 1}, {"b", 2}},
+                                   Document{{"a", 2.5}, {"b", 2LL}},
+                                   Document{{"a", BSONNULL}, {"b", 2}},
+                                   Document{{"b", 2}},
+                                   Document{{"a", Date_t::fromMillisSinceEpoch(1000)}, {"b", 3}},
+                                   Document{{"a", Document{{"b", 4}}}, {"b", 1}},
+                                   Document{{"a", std::vector<Value>{Value(Document{{"b", 5}})}}}};
+
+TEST(ExpressionEvaluateBatchTest, AddMatchesRowByRowEvaluation) {
+    assertBatchMatchesRowByRow(BSON("expr" << BSON("$add" << BSON_ARRAY("$b" << 1 << "$b"))),
+                               kRoots);
+    assertBatchMatchesRowByRow(BSON("expr" << BSON("$add" << BSON_ARRAY("$b" << "$a.b"))), kRoots);
+}
+
+TEST(ExpressionEvaluateBatchTest, CompareMatchesRowByRowEvaluation) {
+    for (auto&& op : {"$eq", "$ne", "$gt", "$gte", "$lt", "$lte", "$cmp"}) {
+        assertBatchMatchesRowByRow(BSON("expr" << BSON(op << BSON_ARRAY("$a" << "$b"))), kRoots);
+    }
+}
+
+TEST(ExpressionEvaluateBatchTest, CondMatchesRowByRowEvaluation) {
+    assertBatchMatchesRowByRow(
+        BSON("expr" << BSON("$cond" << BSON_ARRAY("$a"
+                                                  << "$b"
+                                                  << "$a.b"))),
+        kRoots);
+}
+
+TEST(ExpressionEvaluateBatchTest, FieldPathMatchesRowByRowEvaluation) {
+    assertBatchMatchesRowByRow(BSON("expr"
+                                    << "$a"),
+                               kRoots);
+    assertBatchMatchesRowByRow(BSON("expr"
+                                    << "$a.b"),
+                               kRoots);
+    assertBatchMatchesRowByRow(BSON("expr"
+                                    << "$$ROOT"),
+                               kRoots);
+    assertBatchMatchesRowByRow(BSON("expr"
+                                    << "$$CURRENT.b"),
+                               kRoots);
+}
+
+TEST(ExpressionEvaluateBatchTest, ConstantMatchesRowByRowEvaluation) {
+    assertBatchMatchesRowByRow(BSON("expr" << 42), kRoots);
+}
+
+TEST(ExpressionEvaluateBatchTest, CondDoesNotEvaluateUntakenBranch) {
+    auto expCtx = ExpressionContextForTest{};
+    VariablesParseState vps = expCtx.variablesParseState;
+    auto expr = Expression::parseExpression(
+        &expCtx,
+        fromjson("{$cond: [{$eq: ['$a', 0]}, 'zero', {$divide: [1, '$a']}]}"),
+        vps);
+
+    std::vector<Value> results;
+    expr->evaluateBatch({Document{{"a", 0}}, Document{{"a", 2}}, Document{{"a", 0}}},
+                        &expCtx.variables,
+                        &results);
+    ASSERT_EQ(results.size(), 3U);
+    ASSERT_VALUE_EQ(results[0], Value("zero"_sd));
+    ASSERT_VALUE_EQ(results[1], Value(0.5));
+    ASSERT_VALUE_EQ(results[2], Value("zero"_sd));
+}
+
+TEST(ExpressionEvaluateBatchTest, AddDoesNotEvaluateOperandsAfterNullishOperand) {
+    auto expCtx = ExpressionContextForTest{};
+    VariablesParseState vps = expCtx.variablesParseState;
+    auto expr =
+        Expression::parseExpression(&expCtx, fromjson("{$add: ['$a', {$divide: [1, '$a']}]}"), vps);
+
+    std::vector<Value> results;
+    expr->evaluateBatch({Document{{"a", 2}}, Document{{"a", BSONNULL}}, Document{{"b", 0}}},
+                        &expCtx.variables,
+                        &results);
+    ASSERT_EQ(results.size(), 3U);
+    ASSERT_VALUE_EQ(results[0], Value(2.5));
+    ASSERT_VALUE_EQ(results[1], Value(BSONNULL));
+    ASSERT_VALUE_EQ(results[2], Value(BSONNULL));
+
+    // The same expression throws when a document which does reach the division divides by zero.
+    results.clear();
+    ASSERT_THROWS_CODE(
+        expr->evaluateBatch({Document{{"a", 2}}, Document{{"a", 0}}}, &expCtx.variables, &results),
+        AssertionException,
+        16608);
+}
+
+}  // namespace EvaluateBatch
+
 TEST(ExpressionFromAccumulators, Avg) {
     assertExpectedResults("$avg",
                           {// $avg ignores non-numeric inputs.
@@ -40,6 +40,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/pipeline/common_subexpression_elimination.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_geo_near.h"
 #include "mongo/db/pipeline/document_source_match.h"
@@ -262,6 +263,10 @@ void Pipeline::optimizePipeline() {
             }
         }
         _sources.swap(optimizedSources);
+
+        // Now that the stages and their expressions are final, compute the expressions which
+        // several stages repeat for the same document only once.
+        eliminateCommonSubexpressions(&_sources, pCtx);
     } catch (DBException& ex) {
         ex.addContext("Failed to optimize pipeline");
         throw;
@@ -33,6 +33,7 @@
 
 #include "mongo/db/pipeline/pipeline_d.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "mongo/base/exact_cast.h"
@@ -47,6 +48,8 @@
 #include "mongo/db/exec/collection_scan.h"
 #include "mongo/db/exec/fetch.h"
 #include "mongo/db/exec/multi_iterator.h"
+#include "mongo/db/exec/multi_plan.h"
+#include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/exec/queued_data_stage.h"
 #include "mongo/db/exec/shard_filter.h"
 #include "mongo/db/exec/trial_stage.h"
@@ -59,10 +62,12 @@
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_change_stream.h"
 #include "mongo/db/pipeline/document_source_cursor.h"
+#include "mongo/db/pipeline/document_source_exchange.h"
 #include "mongo/db/pipeline/document_source_geo_near.h"
 #include "mongo/db/pipeline/document_source_geo_near_cursor.h"
 #include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_match.h"
+#include "mongo/db/pipeline/document_source_parallel_group.h"
 #include "mongo/db/pipeline/document_source_sample.h"
 #include "mongo/db/pipeline/document_source_sample_from_random_cursor.h"
 #include "mongo/db/pipeline/document_source_single_document_transformation.h"
@@ -72,8 +77,10 @@
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_executor_factory.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/sort_pattern.h"
+#include "mongo/db/repl/read_concern_args.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/operation_sharding_state.h"
 #include "mongo/db/service_context.h"
@@ -81,6 +88,7 @@
 #include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage/sorted_data_interface.h"
 #include "mongo/db/transaction_participant.h"
+#include "mongo/logv2/log.h"
 #include "mongo/rpc/metadata/client_metadata_ismaster.h"
 #include "mongo/s/catalog_cache.h"
 #include "mongo/s/chunk_manager.h"
@@ -400,6 +408,168 @@ void PipelineD::buildAndAttachInnerQueryExecutorToPipeline(Collection* collectio
 
 namespace {
 
+// The size of the buffer holding the documents of each thread of a parallel $group.
+constexpr int kParallelGroupExchangeBufferBytes = 1024 * 1024;
+
+/**
+ * Returns the BSON form of 'stages', from which they can be parsed again.
+ */
+std::vector<BSONObj> serializeStages(
+    const std::vector<boost::intrusive_ptr<DocumentSource>>& stages) {
+    std::vector<Value> serialized;
+    for (auto&& stage : stages) {
+        stage->serializeToArray(serialized);
+    }
+
+    std::vector<BSONObj> stageSpecs;
+    for (auto&& stage : serialized) {
+        stageSpecs.push_back(stage.getDocument().toBson());
+    }
+    return stageSpecs;
+}
+
+/**
+ * Returns whether 'obj' contains a JavaScript expression or accumulator, which we do not evaluate
+ * on the threads of a parallel $group.
+ */
+bool usesJavaScript(const BSONObj& obj) {
+    for (auto&& elem : obj) {
+        const auto fieldName = elem.fieldNameStringData();
+        if (fieldName == "$where"_sd || fieldName == "$function"_sd ||
+            fieldName == "$accumulator"_sd) {
+            return true;
+        }
+        if (elem.isABSONObj() && usesJavaScript(elem.Obj())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+std::unique_ptr<Pipeline, PipelineDeleter> PipelineD::parallelizeGroupIfPossible(
+    std::unique_ptr<Pipeline, PipelineDeleter> pipeline) {
+    const size_t numWorkers = internalDocumentSourceGroupParallelism.load();
+    const auto expCtx = pipeline->getContext();
+    const auto& sources = pipeline->getSources();
+    if (numWorkers <= 1 || expCtx->explain || expCtx->inMongos || expCtx->fromMongos ||
+        expCtx->needsMerge || expCtx->inMultiDocumentTransaction ||
+        expCtx->tailableMode != TailableModeEnum::kNormal || sources.empty() ||
+        !dynamic_cast<DocumentSourceCursor*>(sources.front().get())) {
+        return pipeline;
+    }
+
+    // The threads read the collection under their own operation contexts, which only supports the
+    // default read concern.
+    const auto& readConcernArgs = repl::ReadConcernArgs::get(expCtx->opCtx);
+    if (readConcernArgs.getLevel() != repl::ReadConcernLevel::kLocalReadConcern ||
+        readConcernArgs.getArgsAfterClusterTime() || readConcernArgs.getArgsAtClusterTime() ||
+        readConcernArgs.getArgsOpTime()) {
+        return pipeline;
+    }
+
+    return parallelizeGroup(std::move(pipeline), numWorkers);
+}
+
+std::unique_ptr<Pipeline, PipelineDeleter> PipelineD::parallelizeGroup(
+    std::unique_ptr<Pipeline, PipelineDeleter> pipeline, size_t numWorkers) {
+    const auto expCtx = pipeline->getContext();
+    const auto& sources = pipeline->getSources();
+
+    // Look for the $group, which may only be preceded by $match stages.
+    std::vector<boost::intrusive_ptr<DocumentSource>> workerStages;
+    auto groupIt = std::next(sources.begin());
+    for (; groupIt != sources.end() && dynamic_cast<DocumentSourceMatch*>(groupIt->get());
+         ++groupIt) {
+        workerStages.push_back(*groupIt);
+    }
+    auto group =
+        groupIt == sources.end() ? nullptr : dynamic_cast<DocumentSourceGroup*>(groupIt->get());
+    if (!group || group->doingMerge()) {
+        return pipeline;
+    }
+    workerStages.push_back(group);
+
+    // The threads take documents from the cursor in no particular order, and their partial groups
+    // are merged in no particular order either. Accumulators such as $first or $push depend on the
+    // order of their input, so they may only be split up if that order was not defined anyway.
+    const auto cursor = dynamic_cast<DocumentSourceCursor*>(sources.front().get());
+    if (!cursor || cursor->providesSortOrder()) {
+        for (auto&& accumulatedField : group->getAccumulatedFields()) {
+            if (!accumulatedField.makeAccumulator()->isCommutative()) {
+                return pipeline;
+            }
+        }
+    }
+
+    // The rest of the pipeline runs on this thread after a $group which merges the partial groups.
+    std::vector<boost::intrusive_ptr<DocumentSource>> mergingStages{
+        group->distributedPlanLogic()->mergingStage};
+    mergingStages.insert(mergingStages.end(), std::next(groupIt), sources.end());
+
+    // Each pipeline needs its own ExpressionContext, so the stages are rebuilt from their
+    // serialized form.
+    const auto workerStageSpecs = serializeStages(workerStages);
+    const auto mergingStageSpecs = serializeStages(mergingStages);
+    for (auto&& stageSpecs : {workerStageSpecs, mergingStageSpecs}) {
+        if (std::any_of(stageSpecs.begin(), stageSpecs.end(), usesJavaScript)) {
+            return pipeline;
+        }
+    }
+
+    // The partial groups share the memory the $group may use, so that running them does not
+    // multiply it.
+    const size_t workerMaxMemoryUsageBytes =
+        std::max<size_t>(group->getMaxMemoryUsageBytes() / numWorkers, 1);
+
+    std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> workerPipelines;
+    for (size_t workerId = 0; workerId < numWorkers; ++workerId) {
+        auto workerExpCtx = expCtx->copyWith(expCtx->ns, expCtx->uuid);
+        workerExpCtx->needsMerge = true;
+        workerPipelines.push_back(Pipeline::parse(workerStageSpecs, workerExpCtx));
+        static_cast<DocumentSourceGroup*>(workerPipelines.back()->getSources().back().get())
+            ->setMaxMemoryUsageBytes(workerMaxMemoryUsageBytes);
+    }
+
+    // Serializing stages splits those which absorbed the stages after them, such as a $sort which
+    // absorbed a $limit, so the merging pipeline is optimized again to coalesce them.
+    auto mergingExpCtx = expCtx->copyWith(expCtx->ns, expCtx->uuid);
+    auto mergingPipeline = Pipeline::parse(mergingStageSpecs, mergingExpCtx);
+    mergingPipeline->optimizePipeline();
+
+    LOGV2_DEBUG(4972101,
+                1,
+                "Running $group in parallel",
+                "namespace"_attr = expCtx->ns,
+                "workers"_attr = numWorkers);
+
+    // The $cursor stage keeps the original ExpressionContext, which the Exchange attaches to the
+    // operation context of whichever thread is reading from it.
+    auto cursorStage = pipeline->popFront();
+    pipeline.reset();
+
+    ExchangeSpec spec;
+    spec.setPolicy(ExchangePolicyEnum::kRoundRobin);
+    spec.setConsumers(numWorkers);
+    spec.setBufferSize(kParallelGroupExchangeBufferBytes);
+    boost::intrusive_ptr<Exchange> exchange =
+        new Exchange(std::move(spec), Pipeline::create({cursorStage}, expCtx));
+
+    for (size_t workerId = 0; workerId < numWorkers; ++workerId) {
+        auto& workerPipeline = workerPipelines[workerId];
+        workerPipeline->addInitialSource(new DocumentSourceExchange(
+            workerPipeline->getContext(), exchange, workerId, nullptr));
+        workerPipeline->detachFromOperationContext();
+    }
+
+    mergingPipeline->addInitialSource(
+        DocumentSourceParallelGroup::create(mergingExpCtx, exchange, std::move(workerPipelines)));
+    return mergingPipeline;
+}
+
+namespace {
+
 /**
  * Look for $sort, $group at the beginning of the pipeline, potentially returning either or both.
  * Returns nullptr for any of the stages that are not found. Note that we are not looking for the
@@ -435,6 +605,41 @@ getSortAndGroupStagesFromPipeline(const Pipeline::SourceContainer& sources) {
     return std::make_pair(sortStage, groupStage);
 }
 
+/**
+ * Returns true if the plan rooted at 'stage' returns its documents in the order of the scanned
+ * index keys, and none of the scanned indexes is multikey. Documents then arrive in the order of
+ * the values of the sorted fields themselves, rather than in that of some of their array elements.
+ */
+bool providesSortFromNonMultikeyIndex(const PlanStage* stage) {
+    switch (stage->stageType()) {
+        case STAGE_IXSCAN:
+            return !static_cast<const IndexScanStats*>(stage->getSpecificStats())->isMultiKey;
+        case STAGE_MULTI_PLAN: {
+            auto multiPlanStage = static_cast<const MultiPlanStage*>(stage);
+            return multiPlanStage->bestPlanChosen() &&
+                providesSortFromNonMultikeyIndex(
+                       multiPlanStage->getChildren()[multiPlanStage->bestPlanIdx()].get());
+        }
+        case STAGE_CACHED_PLAN:
+        case STAGE_FETCH:
+        case STAGE_LIMIT:
+        case STAGE_PROJECTION_COVERED:
+        case STAGE_PROJECTION_DEFAULT:
+        case STAGE_PROJECTION_SIMPLE:
+        case STAGE_SHARDING_FILTER:
+        case STAGE_SKIP:
+        case STAGE_SORT_MERGE: {
+            auto&& children = stage->getChildren();
+            return !children.empty() &&
+                std::all_of(children.begin(), children.end(), [](auto&& child) {
+                       return providesSortFromNonMultikeyIndex(child.get());
+                   });
+        }
+        default:
+            return false;
+    }
+}
+
 boost::optional<long long> extractLimitForPushdown(Pipeline* pipeline) {
     // If the disablePipelineOptimization failpoint is enabled, then do not attempt the limit
     // pushdown optimization.
@@ -556,6 +761,15 @@ PipelineD::buildInnerQueryExecutorGeneric(Collection* collection,
                                                 Pipeline::kAllowedMatcherFeatures,
                                                 &shouldProduceEmptyDocs));
 
+    // When the $sort that was pushed down ahead of a $group is provided by scanning an index, the
+    // documents of each group arrive one after another and the $group can return every group as
+    // soon as it is complete, rather than after having consumed all of its input.
+    if (sortStage && groupStage && pipeline->peekFront() == groupStage.get() &&
+        groupStage->groupsAreContiguousWhenSortedBy(sortStage->getSortKeyPattern()) &&
+        providesSortFromNonMultikeyIndex(exec->getRootStage())) {
+        groupStage->setStreaming(true);
+    }
+
     const auto cursorType = shouldProduceEmptyDocs
         ? DocumentSourceCursor::CursorType::kEmptyDocuments
         : DocumentSourceCursor::CursorType::kRegular;
@@ -759,22 +973,40 @@ Timestamp PipelineD::getLatestOplogTimestamp(const Pipeline* pipeline) {
     return Timestamp();
 }
 
-std::string PipelineD::getPlanSummaryStr(const Pipeline* pipeline) {
-    if (auto docSourceCursor =
-            dynamic_cast<DocumentSourceCursor*>(pipeline->_sources.front().get())) {
-        return docSourceCursor->getPlanSummaryStr();
+namespace {
+
+/**
+ * Calls 'fn' with the $cursor stage which reads the documents of 'pipeline', if any. The $cursor of
+ * a parallel $group feeds its workers from within their Exchange.
+ */
+void inspectCursorStage(const Pipeline::SourceContainer& sources,
+                        const std::function<void(const DocumentSourceCursor&)>& fn) {
+    if (auto docSourceCursor = dynamic_cast<DocumentSourceCursor*>(sources.front().get())) {
+        fn(*docSourceCursor);
+    } else if (auto parallelGroup =
+                   dynamic_cast<DocumentSourceParallelGroup*>(sources.front().get())) {
+        parallelGroup->inspectInputPipeline([&](const Pipeline& inputPipeline) {
+            inspectCursorStage(inputPipeline.getSources(), fn);
+        });
     }
+}
+
+}  // namespace
 
-    return "";
+std::string PipelineD::getPlanSummaryStr(const Pipeline* pipeline) {
+    std::string planSummary;
+    inspectCursorStage(pipeline->_sources, [&](const DocumentSourceCursor& docSourceCursor) {
+        planSummary = docSourceCursor.getPlanSummaryStr();
+    });
+    return planSummary;
 }
 
 void PipelineD::getPlanSummaryStats(const Pipeline* pipeline, PlanSummaryStats* statsOut) {
     invariant(statsOut);
 
-    if (auto docSourceCursor =
-            dynamic_cast<DocumentSourceCursor*>(pipeline->_sources.front().get())) {
-        *statsOut = docSourceCursor->getPlanSummaryStats();
-    }
+    inspectCursorStage(pipeline->_sources, [&](const DocumentSourceCursor& docSourceCursor) {
+        *statsOut = docSourceCursor.getPlanSummaryStats();
+    });
 
     for (auto&& source : pipeline->_sources) {
         if (dynamic_cast<DocumentSourceSort*>(source.get()))
@@ -117,6 +117,29 @@ public:
                                                            const AggregationRequest* aggRequest,
                                                            Pipeline* pipeline);
 
+    /**
+     * If 'pipeline' starts with a $cursor stage followed by $match stages and a $group, and
+     * 'internalDocumentSourceGroupParallelism' allows it, returns an equivalent pipeline which runs
+     * the $match and $group stages as partial aggregations on several threads. Each thread reads a
+     * share of the $cursor's documents through an Exchange, and a merging $group combines their
+     * results. The $group must only use accumulators which do not depend on the order of their
+     * input, unless the $cursor returns its documents in no particular order. Otherwise returns
+     * 'pipeline' unchanged.
+     *
+     * Must be called after the $cursor stage has been attached. The returned pipeline does not
+     * share its ExpressionContext with 'pipeline'.
+     */
+    static std::unique_ptr<Pipeline, PipelineDeleter> parallelizeGroupIfPossible(
+        std::unique_ptr<Pipeline, PipelineDeleter> pipeline);
+
+    /**
+     * Performs the rewrite of parallelizeGroupIfPossible() with 'numWorkers' threads, whatever the
+     * operation it runs for. A first stage other than $cursor is assumed to return its documents
+     * in a defined order. Returns 'pipeline' unchanged if it does not have the required shape.
+     * Exposed for testing.
+     */
+    static std::unique_ptr<Pipeline, PipelineDeleter> parallelizeGroup(
+        std::unique_ptr<Pipeline, PipelineDeleter> pipeline, size_t numWorkers);
 
     static std::string getPlanSummaryStr(const Pipeline* pipeline);
 
@@ -64,6 +64,7 @@
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/temp_dir.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -474,6 +475,82 @@ TEST(PipelineOptimizationTest, SortSortSortMatchProjSkipLimBecomesMatchTopKSortS
     assertPipelineOptimizesAndSerializesTo(inputPipe, outputPipe, serializedPipe);
 }
 
+TEST(PipelineOptimizationTest, SortGroupPushSliceBecomesGroupTopN) {
+    assertPipelineOptimizesTo(
+        "[{$sort: {a: 1, b: -1}}"
+        ",{$group: {_id: '$k', top: {$push: '$x'}, total: {$sum: '$y'}}}"
+        ",{$project: {top: {$slice: ['$top', 3]}, total: 1}}"
+        "]",
+        "[{$group: {_id: '$k', top: {$topN: {n: 3, sortBy: {a: 1, b: -1}, output: '$x'}},"
+        "  total: {$sum: '$y'}}}"
+        ",{$project: {_id: true, total: true, top: {$slice: ['$top', {$const: 3}]}}}"
+        "]");
+}
+
+TEST(PipelineOptimizationTest, SortGroupPushNegativeSliceBecomesGroupBottomN) {
+    assertPipelineOptimizesTo(
+        "[{$sort: {a: 1}}"
+        ",{$group: {_id: '$k', last: {$push: {v: '$x'}}}}"
+        ",{$addFields: {last: {$slice: ['$last', -2]}}}"
+        "]",
+        "[{$group: {_id: '$k', last: {$bottomN: {n: 2, sortBy: {a: 1}, output: {v: '$x'}}}}}"
+        ",{$addFields: {last: {$slice: ['$last', {$const: -2}]}}}"
+        "]");
+}
+
+TEST(PipelineOptimizationTest, SortGroupPushSliceKeepsSortForOrderSensitiveAccumulators) {
+    assertPipelineOptimizesTo(
+        "[{$sort: {a: 1}}"
+        ",{$group: {_id: '$k', top: {$push: '$x'}, first: {$first: '$x'}}}"
+        ",{$project: {top: {$slice: ['$top', 3]}, first: 1}}"
+        "]",
+        "[{$sort: {sortKey: {a: 1}}}"
+        ",{$group: {_id: '$k', top: {$topN: {n: 3, sortBy: {a: 1}, output: '$x'}},"
+        "  first: {$first: '$x'}}}"
+        ",{$project: {_id: true, first: true, top: {$slice: ['$top', {$const: 3}]}}}"
+        "]");
+}
+
+TEST(PipelineOptimizationTest, SortGroupPushIsNotRewrittenIfWholeArrayIsRead) {
+    assertPipelineOptimizesTo(
+        "[{$sort: {a: 1}}"
+        ",{$group: {_id: '$k', top: {$push: '$x'}}}"
+        ",{$project: {top: {$slice: ['$top', 3]}, count: {$size: '$top'}}}"
+        "]",
+        "[{$sort: {sortKey: {a: 1}}}"
+        ",{$group: {_id: '$k', top: {$push: '$x'}}}"
+        ",{$project: {_id: true, top: {$slice: ['$top', {$const: 3}]}, count: {$size: ['$top']}}}"
+        "]");
+    assertPipelineOptimizesTo(
+        "[{$sort: {a: 1}}"
+        ",{$group: {_id: '$k', top: {$push: '$x'}}}"
+        ",{$addFields: {firstThree: {$slice: ['$top', 3]}}}"
+        "]",
+        "[{$sort: {sortKey: {a: 1}}}"
+        ",{$group: {_id: '$k', top: {$push: '$x'}}}"
+        ",{$addFields: {firstThree: {$slice: ['$top', {$const: 3}]}}}"
+        "]");
+}
+
+TEST(PipelineOptimizationTest, SortGroupPushSliceIsNotRewrittenBeforeUpgrade) {
+    serverGlobalParams.featureCompatibility.setVersion(
+        ServerGlobalParams::FeatureCompatibility::Version::kUpgradingFrom44To451);
+    ON_BLOCK_EXIT([] {
+        serverGlobalParams.featureCompatibility.setVersion(
+            ServerGlobalParams::FeatureCompatibility::kLatest);
+    });
+
+    assertPipelineOptimizesTo(
+        "[{$sort: {a: 1}}"
+        ",{$group: {_id: '$k', top: {$push: '$x'}}}"
+        ",{$project: {top: {$slice: ['$top', 3]}}}"
+        "]",
+        "[{$sort: {sortKey: {a: 1}}}"
+        ",{$group: {_id: '$k', top: {$push: '$x'}}}"
+        ",{$project: {_id: true, top: {$slice: ['$top', {$const: 3}]}}}"
+        "]");
+}
+
 TEST(PipelineOptimizationTest, NonIdenticalSortsBecomeFinalKeyTopKSort) {
     std::string inputPipe =
         "[{$sort: {a: -1}}"
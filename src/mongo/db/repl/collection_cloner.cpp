@@ -378,7 +378,11 @@ void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
     _firstBatchOfQueryRound = false;
 
     {
-        stdx::lock_guard<Latch> lk(_mutex);
+        stdx::unique_lock<Latch> lk(_mutex);
+        // Stay at most one batch ahead of the batch being inserted. This lets the next batch be
+        // received while the previous one is written, without buffering an unbounded number of
+        // documents when the network is faster than the storage engine.
+        _documentsToInsertDrained.wait(lk, [&] { return _documentsToInsert.empty(); });
         _stats.receivedBatches++;
         while (iter.moreInCurrentBatch()) {
             _documentsToInsert.emplace_back(iter.nextSafe());
@@ -390,6 +394,13 @@ void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
         [=](const executor::TaskExecutor::CallbackArgs& cbd) { insertDocumentsCallback(cbd); });
 
     if (!scheduleResult.isOK()) {
+        {
+            // Nothing will consume these documents, and they will be fetched again if the query
+            // is resumed.
+            stdx::lock_guard<Latch> lk(_mutex);
+            _documentsToInsert.clear();
+            _documentsToInsertDrained.notify_all();
+        }
         Status newStatus = scheduleResult.getStatus().withContext(
             str::stream() << "Error cloning collection '" << _sourceNss.ns() << "'");
         // We must throw an exception to terminate query.
@@ -423,27 +434,36 @@ void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
 }
 
 void CollectionCloner::insertDocumentsCallback(const executor::TaskExecutor::CallbackArgs& cbd) {
+    // Take the documents before checking the status, so that a query waiting for the buffer to
+    // drain is released even if this insertion is cancelled.
+    std::vector<BSONObj> docs;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _documentsToInsert.swap(docs);
+        _documentsToInsertDrained.notify_all();
+    }
+
     uassertStatusOK(cbd.status);
 
+    if (docs.empty()) {
+        LOGV2_WARNING(21145,
+                      "insertDocumentsCallback, but no documents to insert for ns:{namespace}",
+                      "insertDocumentsCallback, but no documents to insert",
+                      "namespace"_attr = _sourceNss);
+        return;
+    }
+
+    // CollectionBulkLoader is not thread safe, but insertions are serialized by
+    // _dbWorkTaskRunner, so the insert does not need to hold _mutex. Not holding it keeps the
+    // query from blocking on storage work while it buffers the next batch.
+    invariant(_collLoader);
+    uassertStatusOK(_collLoader->insertDocuments(docs.cbegin(), docs.cend()));
+
     {
         stdx::lock_guard<Latch> lk(_mutex);
-        std::vector<BSONObj> docs;
-        if (_documentsToInsert.size() == 0) {
-            LOGV2_WARNING(21145,
-                          "insertDocumentsCallback, but no documents to insert for ns:{namespace}",
-                          "insertDocumentsCallback, but no documents to insert",
-                          "namespace"_attr = _sourceNss);
-            return;
-        }
-        _documentsToInsert.swap(docs);
         _stats.documentsCopied += docs.size();
         ++_stats.fetchedBatches;
         _progressMeter.hit(int(docs.size()));
-        invariant(_collLoader);
-
-        // The insert must be done within the lock, because CollectionBulkLoader is not
-        // thread safe.
-        uassertStatusOK(_collLoader->insertDocuments(docs.cbegin(), docs.cend()));
     }
 
     initialSyncHangDuringCollectionClone.executeIf(
@@ -39,6 +39,7 @@
 #include "mongo/db/service_context_test_fixture.h"
 #include "mongo/dbtests/mock/mock_dbclient_connection.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/notification.h"
 #include "mongo/util/concurrency/thread_pool.h"
 
 namespace mongo {
@@ -472,6 +473,63 @@ TEST_F(CollectionClonerTestResumable, InsertDocumentsFailed) {
     clonerThread.join();
 }
 
+TEST_F(CollectionClonerTestResumable, InsertDocumentsDoesNotBlockReceivingNextBatch) {
+    // Set up data for preliminary stages
+    _mockServer->setCommandReply("count", createCountResponse(3));
+    _mockServer->setCommandReply("listIndexes",
+                                 createCursorResponse(_nss.ns(), BSON_ARRAY(_idIndexSpec)));
+
+    // Set up documents to be returned from upstream node.
+    _mockServer->insert(_nss.ns(), BSON("_id" << 1));
+    _mockServer->insert(_nss.ns(), BSON("_id" << 2));
+    _mockServer->insert(_nss.ns(), BSON("_id" << 3));
+
+    auto cloner = makeCollectionCloner();
+    cloner->setBatchSize_forTest(1);
+    // Stop before running the query to set up the loader.
+    auto collClonerBeforeFailPoint = globalFailPointRegistry().find("hangBeforeClonerStage");
+    auto timesEntered = collClonerBeforeFailPoint->setMode(
+        FailPoint::alwaysOn,
+        0,
+        fromjson("{cloner: 'CollectionCloner', stage: 'query', nss: '" + _nss.ns() + "'}"));
+
+    stdx::thread clonerThread([&] {
+        Client::initThread("ClonerRunner");
+        ASSERT_OK(cloner->run());
+    });
+
+    collClonerBeforeFailPoint->waitForTimesEntered(timesEntered + 1);
+
+    // Make the insertion of the first batch block until the second batch has been received.
+    Notification<void> firstInsertStarted;
+    Notification<void> finishFirstInsert;
+    ASSERT(_loader != nullptr);
+    _loader->insertDocsFn = [&](const std::vector<BSONObj>::const_iterator begin,
+                                const std::vector<BSONObj>::const_iterator end) {
+        if (!firstInsertStarted) {
+            firstInsertStarted.set();
+            finishFirstInsert.get();
+        }
+        return Status::OK();
+    };
+
+    collClonerBeforeFailPoint->setMode(FailPoint::off, 0);
+    firstInsertStarted.get();
+    while (cloner->getStats().receivedBatches < 2) {
+        sleepmillis(10);
+    }
+    ASSERT_EQUALS(0u, cloner->getStats().documentsCopied);
+
+    finishFirstInsert.set();
+    clonerThread.join();
+
+    ASSERT_EQUALS(3, _collectionStats->insertCount);
+    ASSERT_TRUE(_collectionStats->commitCalled);
+    auto stats = cloner->getStats();
+    ASSERT_EQUALS(3u, stats.receivedBatches);
+    ASSERT_EQUALS(3u, stats.documentsCopied);
+}
+
 TEST_F(CollectionClonerTestResumable, DoNotCreateIDIndexIfAutoIndexIdUsed) {
     NamespaceString collNss;
     CollectionOptions collOptions;
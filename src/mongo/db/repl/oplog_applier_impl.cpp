@@ -50,6 +50,7 @@
 #include "mongo/db/storage/control/storage_control.h"
 #include "mongo/logv2/log.h"
 #include "mongo/platform/basic.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/log_with_sampling.h"
 #include "third_party/murmurhash3/MurmurHash3.h"
@@ -207,28 +208,72 @@ void processCrudOp(OperationContext* opCtx,
     }
 }
 
+}  // namespace
+
 /**
- * Adds a single oplog entry to the appropriate writer vector.
+ * Distributes the oplog entries of a batch across the writer vectors.
+ *
+ * Entries with the same hash (derived from the namespace, and from the _id for CRUD ops on
+ * non-capped collections) may conflict and must be applied in order by a single writer. Entries
+ * with different hashes are independent, so instead of pinning each hash to 'hash % numWriters',
+ * which lets a few hot documents pile up on the same writer while others sit idle, a hash seen
+ * for the first time in the batch is given to the writer with the fewest entries so far. All
+ * later entries with that hash follow it to the same writer.
  */
-void addToWriterVector(OplogEntry* op,
-                       std::vector<std::vector<const OplogEntry*>>* writerVectors,
-                       uint32_t hash) {
-    const uint32_t numWriters = writerVectors->size();
-    auto& writer = (*writerVectors)[hash % numWriters];
-    if (writer.empty()) {
-        writer.reserve(8);  // Skip a few growth rounds
+class WriterVectorAssigner {
+public:
+    explicit WriterVectorAssigner(std::vector<std::vector<const OplogEntry*>>* writerVectors)
+        : _writerVectors(writerVectors) {
+        invariant(!_writerVectors->empty());
+    }
+
+    /**
+     * Adds a single oplog entry to the writer vector its hash is assigned to.
+     */
+    void add(OplogEntry* op, uint32_t hash) {
+        auto it = _writerForHash.find(hash);
+        if (it == _writerForHash.end()) {
+            it = _writerForHash.emplace(hash, _leastLoadedWriter()).first;
+        }
+
+        auto& writer = (*_writerVectors)[it->second];
+        if (writer.empty()) {
+            writer.reserve(8);  // Skip a few growth rounds
+        }
+        writer.push_back(op);
+    }
+
+private:
+    size_t _leastLoadedWriter() const {
+        // Start the search after the writers picked so far, so that ties are broken round-robin
+        // rather than always in favor of the first writers.
+        const auto numWriters = _writerVectors->size();
+        const auto start = _writerForHash.size() % numWriters;
+        auto best = start;
+        for (size_t i = 1; i < numWriters; ++i) {
+            const auto candidate = (start + i) % numWriters;
+            if ((*_writerVectors)[candidate].size() < (*_writerVectors)[best].size()) {
+                best = candidate;
+            }
+        }
+        return best;
     }
-    writer.push_back(op);
-}
+
+    std::vector<std::vector<const OplogEntry*>>* const _writerVectors;
+
+    stdx::unordered_map<uint32_t, size_t> _writerForHash;
+};
+
+namespace {
 
 /**
- * Adds a set of derivedOps to writerVectors.
+ * Adds a set of derivedOps to the writer vectors.
  * If `serial` is true, assign all derived operations to the writer vector corresponding to the hash
  * of the first operation in `derivedOps`.
  */
 void addDerivedOps(OperationContext* opCtx,
                    std::vector<OplogEntry>* derivedOps,
-                   std::vector<std::vector<const OplogEntry*>>* writerVectors,
+                   WriterVectorAssigner* writerVectorAssigner,
                    CachedCollectionProperties* collPropertiesCache,
                    bool serial) {
 
@@ -247,9 +292,9 @@ void addDerivedOps(OperationContext* opCtx,
         if (serial) {
             // Serial derived ops go to the writer vector corresponding to the first op of
             // derivedOps.
-            addToWriterVector(&op, writerVectors, serialWriterId.get());
+            writerVectorAssigner->add(&op, serialWriterId.get());
         } else {
-            addToWriterVector(&op, writerVectors, hash);
+            writerVectorAssigner->add(&op, hash);
         }
     }
 }
@@ -259,7 +304,7 @@ void _addOplogChainOpsToWriterVectors(OperationContext* opCtx,
                                       std::vector<std::vector<OplogEntry>>* derivedOps,
                                       OplogEntry* op,
                                       CachedCollectionProperties* collPropertiesCache,
-                                      std::vector<std::vector<const OplogEntry*>>* writerVectors) {
+                                      WriterVectorAssigner* writerVectorAssigner) {
     std::vector<OplogEntry> txnOps;
     bool shouldSerialize = false;
     std::tie(txnOps, shouldSerialize) =
@@ -268,7 +313,8 @@ void _addOplogChainOpsToWriterVectors(OperationContext* opCtx,
     partialTxnList->clear();
 
     // Transaction entries cannot have different session updates.
-    addDerivedOps(opCtx, &derivedOps->back(), writerVectors, collPropertiesCache, shouldSerialize);
+    addDerivedOps(
+        opCtx, &derivedOps->back(), writerVectorAssigner, collPropertiesCache, shouldSerialize);
 }
 
 void stableSortByNamespace(std::vector<const OplogEntry*>* oplogEntryPointers) {
@@ -624,6 +670,14 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
     // Increment the batch size stat.
     oplogApplicationBatchSize.increment(ops.size());
 
+    // Applying the batch may only overlap with writing it to the oplog if a crash in between is
+    // recovered from a stable timestamp, which discards the partially applied documents along with
+    // the oplog entries past the oplogTruncateAfterPoint.
+    const bool overlapOplogWrites = !getOptions().skipWritesToOplog &&
+        getOptions().mode == OplogApplication::Mode::kSecondary &&
+        oplogApplicationOverlapsOplogWrites.load() &&
+        opCtx->getServiceContext()->getStorageEngine()->supportsRecoverToStableTimestamp();
+
     std::vector<WorkerMultikeyPathInfo> multikeyVector(_writerPool->getStats().numThreads);
     {
         // Each node records cumulative batch application stats for itself using this timer.
@@ -653,21 +707,32 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
             _writerPool->getStats().numThreads);
         fillWriterVectors(opCtx, &ops, &writerVectors, &derivedOps);
 
-        // Wait for writes to finish before applying ops.
-        _writerPool->waitForIdle();
-
         // Use this fail point to hold the PBWM lock after we have written the oplog entries but
-        // before we have applied them.
-        if (MONGO_unlikely(pauseBatchApplicationAfterWritingOplogEntries.shouldFail())) {
+        // before we have applied them. It is only evaluated once, so that an activation limited
+        // to a number of batches is not used up by the check below.
+        const bool pauseAfterWritingOplogEntries =
+            MONGO_unlikely(pauseBatchApplicationAfterWritingOplogEntries.shouldFail());
+
+        // Wait for writes to finish before applying ops, unless the writer threads can start
+        // applying ops while the rest of the oplog writes are still in progress.
+        if (!overlapOplogWrites || pauseAfterWritingOplogEntries) {
+            _writerPool->waitForIdle();
+        }
+
+        if (pauseAfterWritingOplogEntries) {
             LOGV2(21231,
                   "pauseBatchApplicationAfterWritingOplogEntries fail point enabled. Blocking "
                   "until fail point is disabled");
             pauseBatchApplicationAfterWritingOplogEntries.pauseWhileSet(opCtx);
         }
 
-        // Reset consistency markers in case the node fails while applying ops.
+        // Reset consistency markers in case the node fails while applying ops. When the oplog
+        // writes may still be in progress, the oplogTruncateAfterPoint is only reset once they
+        // are done, below.
         if (!getOptions().skipWritesToOplog) {
-            _consistencyMarkers->setOplogTruncateAfterPoint(opCtx, Timestamp());
+            if (!overlapOplogWrites) {
+                _consistencyMarkers->setOplogTruncateAfterPoint(opCtx, Timestamp());
+            }
             _consistencyMarkers->setMinValidToAtLeast(opCtx, ops.back().getOpTime());
         }
 
@@ -723,6 +788,11 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
                 }
             }
         }
+
+        // Waiting for the ops to be applied also waited for the oplog writes.
+        if (overlapOplogWrites) {
+            _consistencyMarkers->setOplogTruncateAfterPoint(opCtx, Timestamp());
+        }
     }
 
     // Tell the storage engine to flush the journal now that a replication batch has completed. This
@@ -774,7 +844,7 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
 /**
  * ops - This only modifies the isForCappedCollection field on each op. It does not alter the ops
  *      vector in any other way.
- * writerVectors - Set of operations for each worker thread to apply.
+ * writerVectorAssigner - Distributes the operations to apply across the worker threads.
  * derivedOps - If provided, this function inserts a decomposition of applyOps operations
  *      and instructions for updating the transactions table.  Required if processing oplogs
  *      with transactions.
@@ -783,7 +853,7 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
 void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
     OperationContext* opCtx,
     std::vector<OplogEntry>* ops,
-    std::vector<std::vector<const OplogEntry*>>* writerVectors,
+    WriterVectorAssigner* writerVectorAssigner,
     std::vector<std::vector<OplogEntry>>* derivedOps,
     SessionUpdateTracker* sessionUpdateTracker) noexcept {
 
@@ -809,7 +879,7 @@ void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
                 derivedOps->emplace_back(std::move(*newOplogWrites));
                 addDerivedOps(opCtx,
                               &derivedOps->back(),
-                              writerVectors,
+                              writerVectorAssigner,
                               &collPropertiesCache,
                               false /*serial*/);
             }
@@ -849,8 +919,12 @@ void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
                 // oplog and fill writers with those operations.
                 // Flush partialTxnList operations for current transaction.
                 auto& partialTxnList = partialTxnOps[*logicalSessionId];
-                _addOplogChainOpsToWriterVectors(
-                    opCtx, &partialTxnList, derivedOps, &op, &collPropertiesCache, writerVectors);
+                _addOplogChainOpsToWriterVectors(opCtx,
+                                                 &partialTxnList,
+                                                 derivedOps,
+                                                 &op,
+                                                 &collPropertiesCache,
+                                                 writerVectorAssigner);
             } else {
                 // The applyOps entry was not generated as part of a transaction.
                 invariant(!op.getPrevWriteOpTimeInTransaction());
@@ -860,7 +934,7 @@ void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
                 // Nested entries cannot have different session updates.
                 addDerivedOps(opCtx,
                               &derivedOps->back(),
-                              writerVectors,
+                              writerVectorAssigner,
                               &collPropertiesCache,
                               false /*serial*/);
             }
@@ -873,12 +947,16 @@ void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
         if (op.isPreparedCommit() && (getOptions().mode == OplogApplication::Mode::kInitialSync)) {
             auto logicalSessionId = op.getSessionId();
             auto& partialTxnList = partialTxnOps[*logicalSessionId];
-            _addOplogChainOpsToWriterVectors(
-                opCtx, &partialTxnList, derivedOps, &op, &collPropertiesCache, writerVectors);
+            _addOplogChainOpsToWriterVectors(opCtx,
+                                             &partialTxnList,
+                                             derivedOps,
+                                             &op,
+                                             &collPropertiesCache,
+                                             writerVectorAssigner);
             continue;
         }
 
-        addToWriterVector(&op, writerVectors, hash);
+        writerVectorAssigner->add(&op, hash);
     }
 }
 
@@ -888,14 +966,16 @@ void OplogApplierImpl::fillWriterVectors(
     std::vector<std::vector<const OplogEntry*>>* writerVectors,
     std::vector<std::vector<OplogEntry>>* derivedOps) noexcept {
 
+    WriterVectorAssigner writerVectorAssigner(writerVectors);
     SessionUpdateTracker sessionUpdateTracker;
-    _deriveOpsAndFillWriterVectors(opCtx, ops, writerVectors, derivedOps, &sessionUpdateTracker);
+    _deriveOpsAndFillWriterVectors(
+        opCtx, ops, &writerVectorAssigner, derivedOps, &sessionUpdateTracker);
 
     auto newOplogWrites = sessionUpdateTracker.flushAll();
     if (!newOplogWrites.empty()) {
         derivedOps->emplace_back(std::move(newOplogWrites));
         _deriveOpsAndFillWriterVectors(
-            opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr);
+            opCtx, &derivedOps->back(), &writerVectorAssigner, derivedOps, nullptr);
     }
 }
 
@@ -67,6 +67,7 @@
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/transaction_participant_gen.h"
 #include "mongo/platform/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/clock_source_mock.h"
@@ -557,6 +558,228 @@ TEST_F(OplogApplierImplTest,
                                                      createOplogCollectionOptions()));
 }
 
+/**
+ * Test only subclass of OplogApplierImpl that does not apply oplog entries, but records the
+ * namespaces of the ops given to each writer.
+ */
+class TrackWriterVectorsApplier : public OplogApplierImpl {
+public:
+    using OplogApplierImpl::OplogApplierImpl;
+
+    Status applyOplogBatchPerWorker(OperationContext* opCtx,
+                                    std::vector<const OplogEntry*>* ops,
+                                    WorkerMultikeyPathInfo* workerMultikeyPathInfo) override {
+        std::vector<NamespaceString> namespaces;
+        for (auto&& opPtr : *ops) {
+            namespaces.push_back(opPtr->getNss());
+        }
+
+        stdx::lock_guard<Latch> lk(_mutex);
+        writerVectors.push_back(std::move(namespaces));
+        return Status::OK();
+    }
+
+    std::vector<std::vector<NamespaceString>> writerVectors;
+
+private:
+    Mutex _mutex = MONGO_MAKE_LATCH("TrackWriterVectorsApplier::_mutex");
+};
+
+TEST_F(OplogApplierImplTest, MultiApplySpreadsIndependentOpsAcrossAllWriters) {
+    auto writerPool = makeReplWriterPool();
+    const auto numWriters = writerPool->getStats().numThreads;
+    ASSERT_GT(numWriters, 1U);
+
+    // A burst of ops on a hot collection, followed by a single op on enough other collections to
+    // keep every remaining writer busy.
+    const NamespaceString hotNss("test.hot");
+    std::vector<OplogEntry> ops;
+    for (int i = 0; i < 3; ++i) {
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(1), i), 1LL}, hotNss, BSON("_id" << 1 << "i" << i)));
+    }
+    for (size_t i = 1; i < numWriters; ++i) {
+        ops.push_back(makeInsertDocumentOplogEntry({Timestamp(Seconds(2), i), 1LL},
+                                                   NamespaceString("test.coll" + std::to_string(i)),
+                                                   BSON("_id" << 1)));
+    }
+
+    NoopOplogApplierObserver observer;
+    TrackWriterVectorsApplier oplogApplier(
+        nullptr,  // executor
+        nullptr,  // oplogBuffer
+        &observer,
+        ReplicationCoordinator::get(_opCtx.get()),
+        getConsistencyMarkers(),
+        getStorageInterface(),
+        repl::OplogApplier::Options(repl::OplogApplication::Mode::kSecondary),
+        writerPool.get());
+    ASSERT_OK(oplogApplier.applyOplogBatch(_opCtx.get(), ops));
+
+    // Every writer got work, and the ops on the hot collection stayed together on one of them.
+    ASSERT_EQUALS(numWriters, oplogApplier.writerVectors.size());
+    size_t numHotWriters = 0;
+    for (const auto& writer : oplogApplier.writerVectors) {
+        if (writer.front() == hotNss) {
+            ASSERT_EQUALS(3U, writer.size());
+            ++numHotWriters;
+        } else {
+            ASSERT_EQUALS(1U, writer.size());
+        }
+    }
+    ASSERT_EQUALS(1U, numHotWriters);
+}
+
+/**
+ * Test only subclass of OplogApplierImpl that does not apply oplog entries, but calls 'onApply'
+ * with the ops given to each writer.
+ */
+class ApplyHookApplier : public OplogApplierImpl {
+public:
+    using OplogApplierImpl::OplogApplierImpl;
+
+    Status applyOplogBatchPerWorker(OperationContext* opCtx,
+                                    std::vector<const OplogEntry*>* ops,
+                                    WorkerMultikeyPathInfo* workerMultikeyPathInfo) override {
+        onApply(opCtx, *ops);
+        return Status::OK();
+    }
+
+    std::function<void(OperationContext*, const std::vector<const OplogEntry*>&)> onApply;
+};
+
+class OplogApplierImplOverlapTest : public OplogApplierImplTest {
+public:
+    // Applying a batch only overlaps with writing it to the oplog on a storage engine which can
+    // recover to a stable timestamp.
+    OplogApplierImplOverlapTest() : OplogApplierImplTest("wiredTiger") {}
+
+protected:
+    void setUp() override {
+        OplogApplierImplTest::setUp();
+        _originalOverlap = oplogApplicationOverlapsOplogWrites.load();
+        oplogApplicationOverlapsOplogWrites.store(true);
+
+        _opObserver->onInsertsFn =
+            [&](OperationContext*, const NamespaceString& nss, const std::vector<BSONObj>& docs) {
+                if (nss.isOplog()) {
+                    _numOplogDocs.fetchAndAdd(docs.size());
+                }
+            };
+        _writerPool = makeReplWriterPool();
+    }
+
+    void tearDown() override {
+        oplogApplicationOverlapsOplogWrites.store(_originalOverlap);
+        OplogApplierImplTest::tearDown();
+    }
+
+    std::vector<OplogEntry> makeOps() {
+        std::vector<OplogEntry> ops;
+        for (int i = 0; i < 10; ++i) {
+            ops.push_back(makeInsertDocumentOplogEntry(
+                {Timestamp(Seconds(2), i), 1LL},
+                NamespaceString("test.coll" + std::to_string(i)),
+                BSON("_id" << 1)));
+        }
+        return ops;
+    }
+
+    std::unique_ptr<ApplyHookApplier> makeApplier() {
+        return std::make_unique<ApplyHookApplier>(
+            nullptr,  // executor
+            nullptr,  // oplogBuffer
+            &_observer,
+            ReplicationCoordinator::get(_opCtx.get()),
+            getConsistencyMarkers(),
+            getStorageInterface(),
+            repl::OplogApplier::Options(repl::OplogApplication::Mode::kSecondary),
+            _writerPool.get());
+    }
+
+    AtomicWord<size_t> _numOplogDocs{0};
+    NoopOplogApplierObserver _observer;
+    std::unique_ptr<ThreadPool> _writerPool;
+
+private:
+    bool _originalOverlap = false;
+};
+
+TEST_F(OplogApplierImplOverlapTest, ResetsOplogTruncateAfterPointOnceBatchIsApplied) {
+    const Timestamp lastApplied(Seconds(1), 0);
+    ReplicationCoordinator::get(_opCtx.get())
+        ->setMyLastAppliedOpTimeAndWallTime({OpTime(lastApplied, 1LL), Date_t()});
+    auto ops = makeOps();
+
+    auto oplogApplier = makeApplier();
+    Mutex mutex = MONGO_MAKE_LATCH("OplogApplierImplOverlapTest::mutex");
+    size_t numApplied = 0;
+    std::vector<std::pair<Timestamp, OpTime>> markersWhenApplied;
+    oplogApplier->onApply = [&](OperationContext* opCtx,
+                                const std::vector<const OplogEntry*>& writerOps) {
+        stdx::lock_guard<Latch> lk(mutex);
+        numApplied += writerOps.size();
+        markersWhenApplied.emplace_back(
+            getConsistencyMarkers()->getOplogTruncateAfterPoint(opCtx),
+            getConsistencyMarkers()->getMinValid(opCtx));
+    };
+    ASSERT_EQ(ops.back().getOpTime(),
+              unittest::assertGet(oplogApplier->applyOplogBatch(_opCtx.get(), ops)));
+
+    // The oplog entries may still have been in the course of being written while the ops were
+    // applied, so a crash at that point had to truncate them, and recover to a point before any op
+    // of the batch was applied.
+    ASSERT_EQ(ops.size(), numApplied);
+    for (auto&& [oplogTruncateAfterPoint, minValid] : markersWhenApplied) {
+        ASSERT_EQ(lastApplied, oplogTruncateAfterPoint);
+        ASSERT_EQ(ops.back().getOpTime(), minValid);
+    }
+    ASSERT_EQ(ops.size(), _numOplogDocs.load());
+    ASSERT_EQ(getConsistencyMarkers()->getOplogTruncateAfterPoint(_opCtx.get()), Timestamp());
+}
+
+TEST_F(OplogApplierImplOverlapTest, PauseAfterWritingOplogEntriesWaitsForOplogWrites) {
+    auto ops = makeOps();
+
+    auto oplogApplier = makeApplier();
+    Mutex mutex = MONGO_MAKE_LATCH("OplogApplierImplOverlapTest::mutex");
+    std::vector<size_t> numOplogDocsWhenApplied;
+    oplogApplier->onApply = [&](OperationContext*, const std::vector<const OplogEntry*>&) {
+        stdx::lock_guard<Latch> lk(mutex);
+        numOplogDocsWhenApplied.push_back(_numOplogDocs.load());
+    };
+
+    auto failPoint =
+        globalFailPointRegistry().find("pauseBatchApplicationAfterWritingOplogEntries");
+    const auto timesEntered = failPoint->setMode(FailPoint::alwaysOn);
+    ON_BLOCK_EXIT([&] { failPoint->setMode(FailPoint::off); });
+
+    Status status = Status::OK();
+    stdx::thread applyThread([&] {
+        ThreadClient tc("OplogApplierImplOverlapTest", getServiceContext());
+        auto opCtx = cc().makeOperationContext();
+        status = oplogApplier->applyOplogBatch(opCtx.get(), ops).getStatus();
+    });
+
+    // The fail point is checked once before the oplog writes are waited for, and then again by the
+    // pause which follows them.
+    failPoint->waitForTimesEntered(timesEntered + 2);
+    ASSERT_EQ(ops.size(), _numOplogDocs.load());
+    {
+        stdx::lock_guard<Latch> lk(mutex);
+        ASSERT(numOplogDocsWhenApplied.empty());
+    }
+
+    failPoint->setMode(FailPoint::off);
+    applyThread.join();
+    ASSERT_OK(status);
+
+    ASSERT_FALSE(numOplogDocsWhenApplied.empty());
+    for (auto numOplogDocs : numOplogDocsWhenApplied) {
+        ASSERT_EQ(ops.size(), numOplogDocs);
+    }
+}
+
 TEST_F(OplogApplierImplTest,
        OplogApplicationThreadFuncUsesApplyOplogEntryOrGroupedInsertsToApplyOperation) {
     NamespaceString nss("local." + _agent.getSuiteName() + "_" + _agent.getTestName());
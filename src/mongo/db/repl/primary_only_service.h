@@ -282,6 +282,7 @@ public:
 
     void onStepUpBegin(OperationContext*, long long term) final {}
     void onBecomeArbiter() final{};
+    void onInitialSyncComplete(OperationContext*) final {}
     void onStepUpComplete(OperationContext*, long long term) final;
     void onStepDown() final;
 
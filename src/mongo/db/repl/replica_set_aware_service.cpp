@@ -74,6 +74,12 @@ void ReplicaSetAwareServiceRegistry::onBecomeArbiter() {
     });
 }
 
+void ReplicaSetAwareServiceRegistry::onInitialSyncComplete(OperationContext* opCtx) {
+    std::for_each(_services.begin(), _services.end(), [&](ReplicaSetAwareInterface* service) {
+        service->onInitialSyncComplete(opCtx);
+    });
+}
+
 void ReplicaSetAwareServiceRegistry::_registerService(ReplicaSetAwareInterface* service) {
     _services.push_back(service);
 }
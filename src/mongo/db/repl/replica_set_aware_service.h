@@ -84,6 +84,9 @@ namespace mongo {
  *     void onBecomeArbiter() final {
  *         // ...
  *     }
+ *     void onInitialSyncComplete(OperationContext* opCtx) final {
+ *         // ...
+ *     }
  * };
  *
  * namespace {
@@ -124,6 +127,12 @@ public:
      * Called when the node commences being an arbiter.
      */
     virtual void onBecomeArbiter() = 0;
+
+    /**
+     * Called after initial sync has completed, before the node starts applying the oplog in
+     * steady state.
+     */
+    virtual void onInitialSyncComplete(OperationContext* opCtx) = 0;
 };
 
 
@@ -175,6 +184,7 @@ public:
     void onStepUpComplete(OperationContext* opCtx, long long term) final;
     void onStepDown() final;
     void onBecomeArbiter() final;
+    void onInitialSyncComplete(OperationContext* opCtx) final;
 
 private:
     void _registerService(ReplicaSetAwareInterface* service);
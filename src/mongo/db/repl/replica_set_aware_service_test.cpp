@@ -43,6 +43,7 @@ public:
     int numCallsOnStepUpComplete{0};
     int numCallsOnStepDown{0};
     int numCallsOnBecomeArbiter{0};
+    int numCallsOnInitialSyncComplete{0};
 
 protected:
     void onStepUpBegin(OperationContext* opCtx, long long term) override {
@@ -60,6 +61,10 @@ protected:
     void onBecomeArbiter() override {
         numCallsOnBecomeArbiter++;
     }
+
+    void onInitialSyncComplete(OperationContext* opCtx) override {
+        numCallsOnInitialSyncComplete++;
+    }
 };
 
 /**
@@ -142,6 +147,12 @@ private:
                   ServiceB::get(getServiceContext())->numCallsOnBecomeArbiter - 1);
         TestService::onBecomeArbiter();
     }
+
+    void onInitialSyncComplete(OperationContext* opCtx) final {
+        ASSERT_EQ(numCallsOnInitialSyncComplete,
+                  ServiceB::get(getServiceContext())->numCallsOnInitialSyncComplete - 1);
+        TestService::onInitialSyncComplete(opCtx);
+    }
 };
 
 const auto getServiceC = ServiceContext::declareDecoration<ServiceC>();
@@ -172,16 +183,19 @@ TEST_F(ReplicaSetAwareServiceTest, ReplicaSetAwareService) {
     ASSERT_EQ(0, a->numCallsOnStepUpComplete);
     ASSERT_EQ(0, a->numCallsOnStepDown);
     ASSERT_EQ(0, a->numCallsOnBecomeArbiter);
+    ASSERT_EQ(0, a->numCallsOnInitialSyncComplete);
 
     ASSERT_EQ(0, b->numCallsOnStepUpBegin);
     ASSERT_EQ(0, b->numCallsOnStepUpComplete);
     ASSERT_EQ(0, b->numCallsOnStepDown);
     ASSERT_EQ(0, b->numCallsOnBecomeArbiter);
+    ASSERT_EQ(0, b->numCallsOnInitialSyncComplete);
 
     ASSERT_EQ(0, c->numCallsOnStepUpBegin);
     ASSERT_EQ(0, c->numCallsOnStepUpComplete);
     ASSERT_EQ(0, c->numCallsOnStepDown);
     ASSERT_EQ(0, c->numCallsOnBecomeArbiter);
+    ASSERT_EQ(0, c->numCallsOnInitialSyncComplete);
 
     ReplicaSetAwareServiceRegistry::get(sc).onStepUpBegin(opCtx, 0);
     ReplicaSetAwareServiceRegistry::get(sc).onStepUpBegin(opCtx, 0);
@@ -190,21 +204,25 @@ TEST_F(ReplicaSetAwareServiceTest, ReplicaSetAwareService) {
     ReplicaSetAwareServiceRegistry::get(sc).onStepUpComplete(opCtx, 0);
     ReplicaSetAwareServiceRegistry::get(sc).onStepDown();
     ReplicaSetAwareServiceRegistry::get(sc).onBecomeArbiter();
+    ReplicaSetAwareServiceRegistry::get(sc).onInitialSyncComplete(opCtx);
 
     ASSERT_EQ(0, a->numCallsOnStepUpBegin);
     ASSERT_EQ(0, a->numCallsOnStepUpComplete);
     ASSERT_EQ(0, a->numCallsOnStepDown);
     ASSERT_EQ(0, a->numCallsOnBecomeArbiter);
+    ASSERT_EQ(0, a->numCallsOnInitialSyncComplete);
 
     ASSERT_EQ(3, b->numCallsOnStepUpBegin);
     ASSERT_EQ(2, b->numCallsOnStepUpComplete);
     ASSERT_EQ(1, b->numCallsOnStepDown);
     ASSERT_EQ(1, b->numCallsOnBecomeArbiter);
+    ASSERT_EQ(1, b->numCallsOnInitialSyncComplete);
 
     ASSERT_EQ(3, c->numCallsOnStepUpBegin);
     ASSERT_EQ(2, c->numCallsOnStepUpComplete);
     ASSERT_EQ(1, c->numCallsOnStepDown);
     ASSERT_EQ(1, c->numCallsOnBecomeArbiter);
+    ASSERT_EQ(1, c->numCallsOnInitialSyncComplete);
 }
 
 }  // namespace
@@ -799,6 +799,7 @@ void ReplicationCoordinatorImpl::_startDataReplication(OperationContext* opCtx,
         invariant(memberState.startup2() || memberState.removed());
         invariant(setFollowerMode(MemberState::RS_RECOVERING));
         auto opCtxHolder = cc().makeOperationContext();
+        ReplicaSetAwareServiceRegistry::get(_service).onInitialSyncComplete(opCtxHolder.get());
         _externalState->startSteadyStateReplication(opCtxHolder.get(), this);
         // This log is used in tests to ensure we made it to this point.
         LOGV2_DEBUG(4853000, 1, "initial sync complete.");
@@ -171,6 +171,7 @@ private:
     void onStepUpComplete(OperationContext* opCtx, long long term) final;
     void onStepDown() final;
     void onBecomeArbiter() final;
+    void onInitialSyncComplete(OperationContext* opCtx) final {}
 
     /**
      * The main balancer loop, which runs in a separate thread.
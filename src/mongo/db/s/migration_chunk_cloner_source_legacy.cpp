@@ -662,16 +662,18 @@ void MigrationChunkClonerSourceLegacy::_nextCloneBatchFromCloneLocs(OperationCon
                            Milliseconds(internalQueryExecYieldPeriodMS.load()));
 
     stdx::unique_lock<Latch> lk(_mutex);
-    auto iter = _cloneLocs.begin();
 
-    for (; iter != _cloneLocs.end(); ++iter) {
+    while (!_cloneLocs.empty()) {
         // We must always make progress in this method by at least one document because empty
         // return indicates there is no more initial clone data.
         if (arrBuilder->arrSize() && tracker.intervalHasElapsed()) {
             break;
         }
 
-        auto nextRecordId = *iter;
+        // Claim the record id before reading it, so that a recipient issuing several concurrent
+        // _migrateClone requests never receives the same document twice.
+        auto nextRecordId = *_cloneLocs.begin();
+        _cloneLocs.erase(_cloneLocs.begin());
 
         lk.unlock();
 
@@ -681,7 +683,9 @@ void MigrationChunkClonerSourceLegacy::_nextCloneBatchFromCloneLocs(OperationCon
             // that we take into consideration the overhead of BSONArray indices.
             if (arrBuilder->arrSize() &&
                 (arrBuilder->len() + doc.value().objsize() + 1024) > BSONObjMaxUserSize) {
-
+                // Return the record id so that it is cloned as part of a later batch.
+                lk.lock();
+                _cloneLocs.insert(nextRecordId);
                 break;
             }
 
@@ -691,8 +695,6 @@ void MigrationChunkClonerSourceLegacy::_nextCloneBatchFromCloneLocs(OperationCon
 
         lk.lock();
     }
-
-    _cloneLocs.erase(_cloneLocs.begin(), iter);
 }
 
 uint64_t MigrationChunkClonerSourceLegacy::getCloneBatchBufferAllocationSize() {
@@ -713,6 +715,8 @@ Status MigrationChunkClonerSourceLegacy::nextCloneBatch(OperationContext* opCtx,
     // attempt to move it, scan the collection directly.
     if (_jumboChunkCloneState && _forceJumbo) {
         try {
+            // The index scan executor can only be driven by one request at a time.
+            stdx::lock_guard<Latch> jumboLk(_jumboChunkCloneMutex);
             _nextCloneBatchFromIndexScan(opCtx, collection, arrBuilder);
             return Status::OK();
         } catch (const DBException& ex) {
@@ -156,6 +156,9 @@ public:
      * give a chance to the caller to perform some form of yielding. It does not free or acquire any
      * locks on its own.
      *
+     * May be called concurrently by several requests from the recipient, in which case each
+     * document is returned to exactly one of them.
+     *
      * NOTE: Must be called with the collection lock held in at least IS mode.
      */
     Status nextCloneBatch(OperationContext* opCtx,
@@ -394,6 +397,11 @@ private:
 
     // Set only once its discovered a chunk is jumbo
     boost::optional<JumboChunkCloneState> _jumboChunkCloneState;
+
+    // Serializes concurrent clone requests which scan a jumbo chunk through the index, since they
+    // share the plan executor in '_jumboChunkCloneState'. Acquired before '_mutex'.
+    Mutex _jumboChunkCloneMutex =
+        MONGO_MAKE_LATCH("MigrationChunkClonerSourceLegacy::_jumboChunkCloneMutex");
 };
 
 }  // namespace mongo
@@ -436,64 +436,151 @@ Status MigrationDestinationManager::start(OperationContext* opCtx,
 repl::OpTime MigrationDestinationManager::cloneDocumentsFromDonor(
     OperationContext* opCtx,
     std::function<void(OperationContext*, BSONObj)> insertBatchFn,
-    std::function<BSONObj(OperationContext*)> fetchBatchFn) {
+    std::function<BSONObj(OperationContext*)> fetchBatchFn,
+    int numWorkers) {
+    invariant(numWorkers > 0);
 
-    SingleProducerSingleConsumerQueue<BSONObj>::Options options;
-    options.maxQueueDepth = 1;
+    MultiProducerMultiConsumerQueue<BSONObj>::Options options;
+    options.maxQueueDepth = numWorkers;
 
-    SingleProducerSingleConsumerQueue<BSONObj> batches(options);
+    MultiProducerMultiConsumerQueue<BSONObj> batches(options);
+
+    // Protects 'lastOpApplied', 'fetchStatus', 'fetcherOpCtxs' and 'fetchersInterrupted', which
+    // are used by the worker threads.
+    Mutex mutex = MONGO_MAKE_LATCH("MigrationDestinationManager::cloneDocumentsFromDonor");
     repl::OpTime lastOpApplied;
+    Status fetchStatus = Status::OK();
+    std::vector<OperationContext*> fetcherOpCtxs;
+    bool fetchersInterrupted = false;
+
+    // Interrupts the additional fetcher threads, which may be waiting for the donor, once the clone
+    // has failed. Fetchers which have not registered their operation contexts yet are interrupted
+    // as soon as they do.
+    auto interruptFetchers = [&](ErrorCodes::Error code) {
+        stdx::lock_guard<Latch> lk(mutex);
+        fetchersInterrupted = true;
+        for (auto fetcherOpCtx : fetcherOpCtxs) {
+            stdx::lock_guard<Client> clientLock(*fetcherOpCtx->getClient());
+            fetcherOpCtx->getServiceContext()->killOperation(clientLock, fetcherOpCtx, code);
+        }
+    };
 
-    stdx::thread inserterThread{[&] {
+    auto insertUntilDone = [&] {
         Client::initKillableThread("chunkInserter", opCtx->getServiceContext());
 
         auto inserterOpCtx = Client::getCurrent()->makeOperationContext();
-        auto consumerGuard = makeGuard([&] {
-            batches.closeConsumerEnd();
-            lastOpApplied = repl::ReplClientInfo::forClient(inserterOpCtx->getClient()).getLastOp();
+        auto lastOpGuard = makeGuard([&] {
+            auto lastOp = repl::ReplClientInfo::forClient(inserterOpCtx->getClient()).getLastOp();
+            stdx::lock_guard<Latch> lk(mutex);
+            lastOpApplied = std::max(lastOpApplied, lastOp);
         });
 
         try {
             while (true) {
                 auto nextBatch = batches.pop(inserterOpCtx.get());
-                auto arr = nextBatch["objects"].Obj();
-                if (arr.isEmpty()) {
-                    return;
-                }
-                insertBatchFn(inserterOpCtx.get(), arr);
+                insertBatchFn(inserterOpCtx.get(), nextBatch["objects"].Obj());
             }
+        } catch (const ExceptionFor<ErrorCodes::ProducerConsumerQueueConsumed>&) {
+            // Every fetcher has finished and all of the fetched batches have been inserted.
+        } catch (const ExceptionFor<ErrorCodes::ProducerConsumerQueueEndClosed>&) {
+            // Another worker failed and has already reported its error.
         } catch (...) {
-            stdx::lock_guard<Client> lk(*opCtx->getClient());
-            opCtx->getServiceContext()->killOperation(lk, opCtx, ErrorCodes::Error(51008));
+            batches.closeConsumerEnd();
+            interruptFetchers(ErrorCodes::Error(51008));
+            {
+                stdx::lock_guard<Client> lk(*opCtx->getClient());
+                opCtx->getServiceContext()->killOperation(lk, opCtx, ErrorCodes::Error(51008));
+            }
             LOGV2(21999,
                   "Batch insertion failed: {error}",
                   "Batch insertion failed",
                   "error"_attr = redact(exceptionToStatus()));
         }
-    }};
+    };
+
+    auto fetchUntilDone = [&](OperationContext* fetcherOpCtx) {
+        try {
+            while (true) {
+                auto res = fetchBatchFn(fetcherOpCtx);
+                if (res["objects"].Obj().isEmpty()) {
+                    return;
+                }
+                batches.push(res.getOwned(), fetcherOpCtx);
+            }
+        } catch (const ExceptionFor<ErrorCodes::ProducerConsumerQueueEndClosed>&) {
+            // Another worker failed and has already reported its error.
+        }
+    };
 
+    std::vector<stdx::thread> inserterThreads;
+    std::vector<stdx::thread> fetcherThreads;
 
     {
-        auto inserterThreadJoinGuard = makeGuard([&] {
+        bool fetchedAll = false;
+        auto workerThreadsJoinGuard = makeGuard([&] {
+            if (!fetchedAll) {
+                batches.closeConsumerEnd();
+                interruptFetchers(ErrorCodes::Error(4975108));
+            }
+            for (auto& fetcherThread : fetcherThreads) {
+                fetcherThread.join();
+            }
             batches.closeProducerEnd();
-            inserterThread.join();
+            for (auto& inserterThread : inserterThreads) {
+                inserterThread.join();
+            }
         });
 
-        while (true) {
-            auto res = fetchBatchFn(opCtx);
-            try {
-                batches.push(res.getOwned(), opCtx);
-                auto arr = res["objects"].Obj();
-                if (arr.isEmpty()) {
-                    break;
+        for (int i = 0; i < numWorkers; ++i) {
+            inserterThreads.emplace_back(insertUntilDone);
+        }
+
+        // This thread is one of the fetchers, so only 'numWorkers' - 1 additional ones are needed.
+        for (int i = 1; i < numWorkers; ++i) {
+            fetcherThreads.emplace_back([&] {
+                Client::initKillableThread("chunkCloneFetcher", opCtx->getServiceContext());
+
+                auto fetcherOpCtx = Client::getCurrent()->makeOperationContext();
+                {
+                    stdx::lock_guard<Latch> lk(mutex);
+                    fetcherOpCtxs.push_back(fetcherOpCtx.get());
+                    if (fetchersInterrupted) {
+                        stdx::lock_guard<Client> clientLock(*fetcherOpCtx->getClient());
+                        fetcherOpCtx->getServiceContext()->killOperation(
+                            clientLock, fetcherOpCtx.get(), ErrorCodes::Error(4975108));
+                    }
                 }
-            } catch (const ExceptionFor<ErrorCodes::ProducerConsumerQueueEndClosed>&) {
-                break;
-            }
+                auto unregisterGuard = makeGuard([&] {
+                    stdx::lock_guard<Latch> lk(mutex);
+                    fetcherOpCtxs.erase(
+                        std::find(fetcherOpCtxs.begin(), fetcherOpCtxs.end(), fetcherOpCtx.get()));
+                });
+
+                try {
+                    fetchUntilDone(fetcherOpCtx.get());
+                } catch (...) {
+                    const auto status = exceptionToStatus();
+                    batches.closeConsumerEnd();
+                    {
+                        stdx::lock_guard<Latch> lk(mutex);
+                        if (fetchStatus.isOK()) {
+                            fetchStatus = status;
+                        }
+                    }
+                    interruptFetchers(ErrorCodes::Error(4975108));
+                }
+            });
         }
+
+        fetchUntilDone(opCtx);
+        fetchedAll = true;
     }  // This scope ensures that the guard is destroyed
 
-    // This check is necessary because the consumer thread uses killOp to propagate errors to the
+    // The additional fetcher threads stop the clone by closing the queue, so their errors must be
+    // surfaced here.
+    uassertStatusOK(fetchStatus);
+
+    // This check is necessary because the consumer threads use killOp to propagate errors to the
     // producer thread (this thread)
     opCtx->checkForInterrupt();
     return lastOpApplied;
@@ -977,6 +1064,11 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* outerOpCtx) {
             uassert(50748, "Migration aborted while copying documents", getState() != ABORT);
         };
 
+        // Checking the session of 'outerOpCtx' in and out is not thread-safe, so the inserter
+        // threads take turns waiting for their writes to replicate.
+        Mutex awaitReplicationMutex =
+            MONGO_MAKE_LATCH("MigrationDestinationManager::_migrateDriver::awaitReplication");
+
         auto insertBatchFn = [&](OperationContext* opCtx, BSONObj arr) {
             auto it = arr.begin();
             while (it != arr.end()) {
@@ -1018,6 +1110,7 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* outerOpCtx) {
                     _clonedBytes += batchClonedBytes;
                 }
                 if (_writeConcern.needToWaitForOtherNodes()) {
+                    stdx::lock_guard<Latch> awaitReplicationLock(awaitReplicationMutex);
                     runWithoutSession(outerOpCtx, [&] {
                         repl::ReplicationCoordinator::StatusAndDuration replStatus =
                             repl::ReplicationCoordinator::get(opCtx)->awaitReplication(
@@ -1040,6 +1133,8 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* outerOpCtx) {
         };
 
         auto fetchBatchFn = [&](OperationContext* opCtx) {
+            assertNotAborted(opCtx);
+
             auto res = uassertStatusOKWithContext(
                 fromShard->runCommand(opCtx,
                                       ReadPreferenceSetting(ReadPreference::PrimaryOnly),
@@ -1054,9 +1149,17 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* outerOpCtx) {
             return res.response;
         };
 
+        // Donors older than 4.5.1 cannot serve concurrent _migrateClone requests, as each of
+        // them erases the record ids it has read from a range which another may still be reading.
+        const bool donorSupportsConcurrentClone = serverGlobalParams.featureCompatibility.isVersion(
+            ServerGlobalParams::FeatureCompatibility::Version::kVersion451);
+        const int cloneConcurrency =
+            donorSupportsConcurrentClone ? migrateCloneConcurrency.load() : 1;
+
         // If running on a replicated system, we'll need to flush the docs we cloned to the
         // secondaries
-        lastOpApplied = cloneDocumentsFromDonor(opCtx, insertBatchFn, fetchBatchFn);
+        lastOpApplied =
+            cloneDocumentsFromDonor(opCtx, insertBatchFn, fetchBatchFn, cloneConcurrency);
 
         timing.done(3);
         migrateThreadHangAtStep3.pauseWhileSet();
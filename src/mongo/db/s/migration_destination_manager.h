@@ -113,12 +113,16 @@ public:
                  const WriteConcernOptions& writeConcern);
 
     /**
-     * Clones documents from a donor shard.
+     * Clones documents from a donor shard. 'numWorkers' batches are fetched concurrently through
+     * 'fetchBatchFn', which must therefore be safe to call from several threads, and are inserted
+     * by as many threads through 'insertBatchFn'. Returns the latest optime written by any of the
+     * inserting threads.
      */
     static repl::OpTime cloneDocumentsFromDonor(
         OperationContext* opCtx,
         std::function<void(OperationContext*, BSONObj)> insertBatchFn,
-        std::function<BSONObj(OperationContext*)> fetchBatchFn);
+        std::function<BSONObj(OperationContext*)> fetchBatchFn,
+        int numWorkers = 1);
 
     /**
      * Idempotent method, which causes the current ongoing migration to abort only if it has the
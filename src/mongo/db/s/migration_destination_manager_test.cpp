@@ -104,6 +104,76 @@ TEST_F(MigrationDestinationManagerTest, CloneDocumentsFromDonorWorksCorrectly) {
     }
 }
 
+// Tests that with several workers every fetched document is inserted exactly once.
+TEST_F(MigrationDestinationManagerTest, CloneDocumentsFromDonorWithConcurrentWorkers) {
+    const int kNumBatches = 20;
+    const int kDocsPerBatch = 5;
+
+    auto mutex = MONGO_MAKE_LATCH();
+    int batchesFetched = 0;
+    std::vector<int> insertedIds;
+
+    auto fetchBatchFn = [&](OperationContext* opCtx) {
+        int batchNumber;
+        {
+            stdx::lock_guard<Latch> lk(mutex);
+            batchNumber = batchesFetched++;
+        }
+
+        BSONArrayBuilder arrayBuilder;
+        for (int i = 0; batchNumber < kNumBatches && i < kDocsPerBatch; ++i) {
+            arrayBuilder.append(createDocument(batchNumber * kDocsPerBatch + i));
+        }
+
+        BSONObjBuilder fetchBatchResultBuilder;
+        fetchBatchResultBuilder.append("objects", arrayBuilder.arr());
+        return fetchBatchResultBuilder.obj();
+    };
+
+    auto insertBatchFn = [&](OperationContext* opCtx, BSONObj docs) {
+        stdx::lock_guard<Latch> lk(mutex);
+        for (auto&& docToClone : docs) {
+            insertedIds.push_back(docToClone.Obj()["_id"].numberInt());
+        }
+    };
+
+    MigrationDestinationManager::cloneDocumentsFromDonor(
+        operationContext(), insertBatchFn, fetchBatchFn, 4);
+
+    std::sort(insertedIds.begin(), insertedIds.end());
+    ASSERT_EQ(static_cast<size_t>(kNumBatches * kDocsPerBatch), insertedIds.size());
+    for (int i = 0; i < kNumBatches * kDocsPerBatch; ++i) {
+        ASSERT_EQ(i, insertedIds[i]);
+    }
+}
+
+// Tests that an exception in the fetch logic of any of the workers is rethrown on the main thread.
+TEST_F(MigrationDestinationManagerTest, CloneDocumentsThrowsFetchErrorsWithConcurrentWorkers) {
+    auto mutex = MONGO_MAKE_LATCH();
+    int batchesFetched = 0;
+
+    auto fetchBatchFn = [&](OperationContext* opCtx) {
+        {
+            stdx::lock_guard<Latch> lk(mutex);
+            if (batchesFetched++ >= 3) {
+                uasserted(ErrorCodes::NetworkTimeout, "network error");
+            }
+        }
+
+        BSONObjBuilder fetchBatchResultBuilder;
+        fetchBatchResultBuilder.append("objects", createDocumentsToCloneArray());
+        return fetchBatchResultBuilder.obj();
+    };
+
+    auto insertBatchFn = [&](OperationContext* opCtx, BSONObj docs) {};
+
+    ASSERT_THROWS_CODE_AND_WHAT(MigrationDestinationManager::cloneDocumentsFromDonor(
+                                    operationContext(), insertBatchFn, fetchBatchFn, 4),
+                                DBException,
+                                ErrorCodes::NetworkTimeout,
+                                "network error");
+}
+
 // Tests that an exception in the fetch logic will successfully throw an exception on the main
 // thread.
 TEST_F(MigrationDestinationManagerTest, CloneDocumentsThrowsFetchErrors) {
@@ -156,5 +226,36 @@ TEST_F(MigrationDestinationManagerTest, CloneDocumentsCatchesInsertErrors) {
     ASSERT_EQ(operationContext()->getKillStatus(), 51008);
 }
 
+// Tests that the fetchers waiting for the donor are interrupted when an insertion fails.
+TEST_F(MigrationDestinationManagerTest, CloneDocumentsInterruptsFetchersOnInsertErrors) {
+    auto mutex = MONGO_MAKE_LATCH();
+    bool ranOnce = false;
+
+    auto fetchBatchFn = [&](OperationContext* opCtx) {
+        BSONObjBuilder fetchBatchResultBuilder;
+        {
+            stdx::lock_guard<Latch> lk(mutex);
+            if (!ranOnce) {
+                ranOnce = true;
+                fetchBatchResultBuilder.append("objects", createDocumentsToCloneArray());
+                return fetchBatchResultBuilder.obj();
+            }
+        }
+
+        opCtx->sleepFor(Hours(1));
+        fetchBatchResultBuilder.append("objects", BSONArray());
+        return fetchBatchResultBuilder.obj();
+    };
+
+    auto insertBatchFn = [&](OperationContext* opCtx, BSONObj docs) {
+        uasserted(ErrorCodes::FailedToParse, "insertion error");
+    };
+
+    ASSERT_THROWS_CODE(MigrationDestinationManager::cloneDocumentsFromDonor(
+                           operationContext(), insertBatchFn, fetchBatchFn, 4),
+                       DBException,
+                       51008);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -0,0 +1,145 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_oplog_cache.h"
+
+#include <cstring>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+WiredTigerOplogCache::WiredTigerOplogCache(int64_t maxBytes, RecordId lowWatermark)
+    : _maxBytes(maxBytes), _lowWatermark(lowWatermark), _highestInserted(lowWatermark) {
+    invariant(_maxBytes > 0);
+}
+
+void WiredTigerOplogCache::insertPending(const Record* records, size_t nRecords) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    for (size_t i = 0; i < nRecords; i++) {
+        const auto& record = records[i];
+        if (record.id <= _lowWatermark) {
+            continue;
+        }
+
+        auto size = record.data.size();
+        auto buffer = SharedBuffer::allocate(size);
+        std::memcpy(buffer.get(), record.data.data(), size);
+
+        auto inserted = _entries.emplace(record.id, Entry{std::move(buffer), size, false});
+        invariant(inserted.second);
+        _bytes += size;
+        if (record.id > _highestInserted) {
+            _highestInserted = record.id;
+        }
+    }
+
+    while (_bytes > _maxBytes && !_entries.empty()) {
+        _evictOldest_inlock();
+    }
+}
+
+void WiredTigerOplogCache::markCommitted(const std::vector<RecordId>& ids) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    for (const auto& id : ids) {
+        auto it = _entries.find(id);
+        if (it != _entries.end()) {
+            it->second.committed = true;
+        }
+    }
+}
+
+void WiredTigerOplogCache::remove(const std::vector<RecordId>& ids) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    for (const auto& id : ids) {
+        auto it = _entries.find(id);
+        if (it != _entries.end()) {
+            _bytes -= it->second.size;
+            _entries.erase(it);
+        }
+    }
+}
+
+boost::optional<Record> WiredTigerOplogCache::next(const RecordId& lastReturned,
+                                                    const RecordId& upTo) const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (lastReturned < _lowWatermark) {
+        // Entries between 'lastReturned' and the watermark may have been evicted.
+        return boost::none;
+    }
+
+    auto it = _entries.upper_bound(lastReturned);
+    if (it == _entries.end() || it->first > upTo || !it->second.committed) {
+        return boost::none;
+    }
+    return Record{it->first, RecordData(it->second.data, it->second.size)};
+}
+
+void WiredTigerOplogCache::evictThrough(const RecordId& id) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    while (!_entries.empty() && _entries.begin()->first <= id) {
+        _evictOldest_inlock();
+    }
+    if (id > _lowWatermark) {
+        _lowWatermark = id;
+    }
+}
+
+void WiredTigerOplogCache::clear() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _entries.clear();
+    _bytes = 0;
+    _lowWatermark = _highestInserted;
+}
+
+int64_t WiredTigerOplogCache::bytesCached() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _bytes;
+}
+
+RecordId WiredTigerOplogCache::lowWatermark() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _lowWatermark;
+}
+
+void WiredTigerOplogCache::_evictOldest_inlock() {
+    auto it = _entries.begin();
+    // Evicting an entry, even a pending one, means later readers can no longer assume the cache
+    // holds everything after it.
+    if (it->first > _lowWatermark) {
+        _lowWatermark = it->first;
+    }
+    _bytes -= it->second.size;
+    _entries.erase(it);
+}
+
+}  // namespace mongo
@@ -0,0 +1,125 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "mongo/db/record_id.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/shared_buffer.h"
+
+namespace mongo {
+
+/**
+ * Keeps copies of the most recently written oplog entries in memory so that forward oplog scans
+ * which have caught up with the end of the oplog (tailing secondaries and change streams) can be
+ * served without a WiredTiger cursor advance per entry.
+ *
+ * Entries are added when they are inserted and become readable once their transaction commits;
+ * entries whose transaction rolls back are removed. When the cache grows past its byte budget the
+ * oldest entries are evicted.
+ *
+ * The cache tracks a low watermark: every committed oplog entry with a RecordId greater than the
+ * watermark is guaranteed to be in the cache. A reader positioned at or after the watermark can
+ * therefore take the next cached entry as the next entry of the oplog. Readers that have fallen
+ * behind the watermark must read from the record store.
+ */
+class WiredTigerOplogCache {
+    WiredTigerOplogCache(const WiredTigerOplogCache&) = delete;
+    WiredTigerOplogCache& operator=(const WiredTigerOplogCache&) = delete;
+
+public:
+    /**
+     * 'lowWatermark' must be the RecordId of the newest entry already in the oplog, or null if the
+     * oplog is empty.
+     */
+    WiredTigerOplogCache(int64_t maxBytes, RecordId lowWatermark);
+
+    /**
+     * Copies 'records' into the cache as pending entries. Records at or below the low watermark
+     * are not cached.
+     */
+    void insertPending(const Record* records, size_t nRecords);
+
+    /**
+     * Makes the given pending entries readable. Entries which were evicted in the meantime are
+     * ignored.
+     */
+    void markCommitted(const std::vector<RecordId>& ids);
+
+    /**
+     * Removes the given pending entries after their transaction rolled back.
+     */
+    void remove(const std::vector<RecordId>& ids);
+
+    /**
+     * Returns the oplog entry immediately following 'lastReturned', if it is cached, committed and
+     * not newer than 'upTo'. Returns boost::none when the caller must read from the record store
+     * instead. The returned record owns a reference to the cached data.
+     */
+    boost::optional<Record> next(const RecordId& lastReturned, const RecordId& upTo) const;
+
+    /**
+     * Evicts every entry at or below 'id', e.g. after the oldest part of the oplog was truncated.
+     */
+    void evictThrough(const RecordId& id);
+
+    /**
+     * Drops every cached entry and raises the low watermark past everything inserted so far. Used
+     * whenever the oplog is truncated from the end.
+     */
+    void clear();
+
+    int64_t bytesCached() const;
+
+    RecordId lowWatermark() const;
+
+private:
+    struct Entry {
+        SharedBuffer data;
+        int size;
+        bool committed;
+    };
+
+    void _evictOldest_inlock();
+
+    const int64_t _maxBytes;
+
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("WiredTigerOplogCache::_mutex");
+    std::map<RecordId, Entry> _entries;
+    int64_t _bytes = 0;
+    RecordId _lowWatermark;
+    RecordId _highestInserted;
+};
+
+}  // namespace mongo
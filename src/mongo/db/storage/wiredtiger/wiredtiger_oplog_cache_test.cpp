@@ -0,0 +1,171 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_oplog_cache.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const int64_t kMaxBytes = 1024 * 1024;
+
+class WiredTigerOplogCacheTest : public unittest::Test {
+protected:
+    /**
+     * Adds a pending entry with the given id and a payload of roughly 'payloadBytes' bytes.
+     */
+    void insert(WiredTigerOplogCache* cache, int64_t id, int payloadBytes = 10) {
+        BSONObj obj = BSON("ts" << Timestamp(id) << "payload" << std::string(payloadBytes, 'x'));
+        _docs.push_back(obj);
+        Record record{RecordId(id), RecordData(obj.objdata(), obj.objsize())};
+        cache->insertPending(&record, 1);
+    }
+
+private:
+    std::vector<BSONObj> _docs;
+};
+
+TEST_F(WiredTigerOplogCacheTest, ReturnsCommittedEntriesInOrder) {
+    WiredTigerOplogCache cache(kMaxBytes, RecordId(1));
+    insert(&cache, 2);
+    insert(&cache, 3);
+    cache.markCommitted({RecordId(2), RecordId(3)});
+
+    auto record = cache.next(RecordId(1), RecordId(10));
+    ASSERT(record);
+    ASSERT_EQ(RecordId(2), record->id);
+    ASSERT_EQ(Timestamp(2), record->data.toBson()["ts"].timestamp());
+
+    record = cache.next(RecordId(2), RecordId(10));
+    ASSERT(record);
+    ASSERT_EQ(RecordId(3), record->id);
+
+    ASSERT_FALSE(cache.next(RecordId(3), RecordId(10)));
+}
+
+TEST_F(WiredTigerOplogCacheTest, DoesNotReturnPendingOrInvisibleEntries) {
+    WiredTigerOplogCache cache(kMaxBytes, RecordId(1));
+    insert(&cache, 2);
+    insert(&cache, 3);
+    cache.markCommitted({RecordId(3)});
+
+    // The entry following the reader is still pending.
+    ASSERT_FALSE(cache.next(RecordId(1), RecordId(10)));
+
+    cache.markCommitted({RecordId(2)});
+    ASSERT(cache.next(RecordId(1), RecordId(10)));
+
+    // The entry following the reader is past its visibility point.
+    ASSERT_FALSE(cache.next(RecordId(2), RecordId(2)));
+}
+
+TEST_F(WiredTigerOplogCacheTest, RemovesRolledBackEntries) {
+    WiredTigerOplogCache cache(kMaxBytes, RecordId(1));
+    insert(&cache, 2);
+    cache.remove({RecordId(2)});
+    ASSERT_EQ(0, cache.bytesCached());
+
+    insert(&cache, 3);
+    cache.markCommitted({RecordId(3)});
+    auto record = cache.next(RecordId(1), RecordId(10));
+    ASSERT(record);
+    ASSERT_EQ(RecordId(3), record->id);
+}
+
+TEST_F(WiredTigerOplogCacheTest, ReadersBehindLowWatermarkMiss) {
+    WiredTigerOplogCache cache(kMaxBytes, RecordId(5));
+
+    // Entries at or below the watermark are already in the oplog and are not cached.
+    insert(&cache, 4);
+    ASSERT_EQ(0, cache.bytesCached());
+
+    insert(&cache, 6);
+    cache.markCommitted({RecordId(6)});
+    ASSERT_FALSE(cache.next(RecordId(4), RecordId(10)));
+    ASSERT(cache.next(RecordId(5), RecordId(10)));
+}
+
+TEST_F(WiredTigerOplogCacheTest, EvictionRaisesLowWatermark) {
+    WiredTigerOplogCache cache(1024, RecordId());
+    for (int64_t id = 1; id <= 10; id++) {
+        insert(&cache, id, 200);
+        cache.markCommitted({RecordId(id)});
+    }
+    ASSERT_LTE(cache.bytesCached(), 1024);
+
+    RecordId watermark = cache.lowWatermark();
+    ASSERT_GT(watermark, RecordId(1));
+    ASSERT_FALSE(cache.next(RecordId(1), RecordId(10)));
+
+    auto record = cache.next(watermark, RecordId(10));
+    ASSERT(record);
+    ASSERT_EQ(RecordId(watermark.repr() + 1), record->id);
+}
+
+TEST_F(WiredTigerOplogCacheTest, EvictedDataRemainsValidForReaders) {
+    WiredTigerOplogCache cache(kMaxBytes, RecordId(1));
+    insert(&cache, 2);
+    cache.markCommitted({RecordId(2)});
+
+    auto record = cache.next(RecordId(1), RecordId(10));
+    ASSERT(record);
+    cache.evictThrough(RecordId(2));
+
+    ASSERT_EQ(Timestamp(2), record->data.toBson()["ts"].timestamp());
+    ASSERT_EQ(RecordId(2), cache.lowWatermark());
+}
+
+TEST_F(WiredTigerOplogCacheTest, ClearRaisesLowWatermarkPastInsertedEntries) {
+    WiredTigerOplogCache cache(kMaxBytes, RecordId(1));
+    insert(&cache, 2);
+    insert(&cache, 3);
+    cache.markCommitted({RecordId(2), RecordId(3)});
+
+    cache.clear();
+    ASSERT_EQ(0, cache.bytesCached());
+    ASSERT_EQ(RecordId(3), cache.lowWatermark());
+    ASSERT_FALSE(cache.next(RecordId(1), RecordId(10)));
+
+    // Entries written after a truncation are cached again once they pass the old end of the oplog.
+    insert(&cache, 3);
+    insert(&cache, 4);
+    cache.markCommitted({RecordId(3), RecordId(4)});
+    ASSERT_FALSE(cache.next(RecordId(2), RecordId(10)));
+    auto record = cache.next(RecordId(3), RecordId(10));
+    ASSERT(record);
+    ASSERT_EQ(RecordId(4), record->id);
+}
+
+}  // namespace
+}  // namespace mongo
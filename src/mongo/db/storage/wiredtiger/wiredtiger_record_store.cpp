@@ -57,6 +57,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_parameters_gen.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_prepare_conflict.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store_oplog_stones.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
@@ -102,6 +103,28 @@ void checkOplogFormatVersion(OperationContext* opCtx, const std::string& uri) {
 
     fassertNoTrace(39998, appMetadata.getValue().getIntField("oplogKeyExtractionVersion") == 1);
 }
+
+/**
+ * Makes oplog entries added to the oplog cache readable when their transaction commits, and removes
+ * them when it rolls back.
+ */
+class OplogCacheInsertChange final : public RecoveryUnit::Change {
+public:
+    OplogCacheInsertChange(WiredTigerOplogCache* oplogCache, std::vector<RecordId> ids)
+        : _oplogCache(oplogCache), _ids(std::move(ids)) {}
+
+    void commit(boost::optional<Timestamp>) final {
+        _oplogCache->markCommitted(_ids);
+    }
+
+    void rollback() final {
+        _oplogCache->remove(_ids);
+    }
+
+private:
+    WiredTigerOplogCache* _oplogCache;
+    std::vector<RecordId> _ids;
+};
 }  // namespace
 
 MONGO_FAIL_POINT_DEFINE(WTWriteConflictException);
@@ -926,6 +949,20 @@ void WiredTigerRecordStore::postConstructorInit(OperationContext* opCtx) {
         _oplogStones = std::make_shared<OplogStones>(opCtx, this);
     }
 
+    if (_oplogStones && gWiredTigerOplogCacheSizeMB > 0) {
+        // Everything already in the oplog is below the cache's low watermark, so only entries
+        // written from now on are served from the cache.
+        RecordId lastRecordId;
+        {
+            auto cursor = getCursor(opCtx, false);
+            if (auto lastRecord = cursor->next()) {
+                lastRecordId = lastRecord->id;
+            }
+        }
+        _oplogCache = std::make_unique<WiredTigerOplogCache>(
+            static_cast<int64_t>(gWiredTigerOplogCacheSizeMB) * 1024 * 1024, lastRecordId);
+    }
+
     if (_isOplog) {
         invariant(_kvEngine);
         _kvEngine->startOplogManager(opCtx, this);
@@ -1412,6 +1449,10 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx, Timestamp mayT
             // Remove the stone after a successful truncation.
             _oplogStones->popOldestStone();
 
+            if (_oplogCache) {
+                _oplogCache->evictThrough(stone->lastRecord);
+            }
+
             // Stash the truncate point for next time to cleanly skip over tombstones, etc.
             _oplogStones->firstRecord = stone->lastRecord;
             _cappedFirstRecord = stone->lastRecord;
@@ -1512,6 +1553,18 @@ Status WiredTigerRecordStore::_insertRecords(OperationContext* opCtx,
     _changeNumRecords(opCtx, nRecords);
     _increaseDataSize(opCtx, totalLength);
 
+    if (_oplogCache) {
+        _oplogCache->insertPending(records, nRecords);
+
+        std::vector<RecordId> ids;
+        ids.reserve(nRecords);
+        for (size_t i = 0; i < nRecords; i++) {
+            ids.push_back(records[i].id);
+        }
+        opCtx->recoveryUnit()->registerChange(
+            std::make_unique<OplogCacheInsertChange>(_oplogCache.get(), std::move(ids)));
+    }
+
     if (_oplogStones) {
         _oplogStones->updateCurrentStoneAfterInsertOnCommit(
             opCtx, totalLength, highestIdRecord, nRecords);
@@ -1727,6 +1780,10 @@ Status WiredTigerRecordStore::truncate(OperationContext* opCtx) {
         _oplogStones->clearStonesOnCommit(opCtx);
     }
 
+    if (_oplogCache) {
+        _oplogCache->clear();
+    }
+
     return Status::OK();
 }
 
@@ -2037,6 +2094,12 @@ void WiredTigerRecordStore::cappedTruncateAfter(OperationContext* opCtx,
         } while ((record = cursor->next()));
     }
 
+    // Stop serving the entries being removed from the oplog cache before they disappear from the
+    // collection.
+    if (_oplogCache) {
+        _oplogCache->clear();
+    }
+
     // Truncate the collection starting from the record located at 'firstRemovedId' to the end of
     // the collection.
     WriteUnitOfWork wuow(opCtx);
@@ -2127,8 +2190,30 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::next() {
     // options we pass when we explicitly start transactions in the RecoveryUnit.
     WiredTigerRecoveryUnit::get(_opCtx)->getSession();
 
+    if (auto record = _nextFromOplogCache()) {
+        return record;
+    }
+
     WT_CURSOR* c = _cursor->get();
 
+    if (_repositionBeforeAdvance) {
+        // The records since the cursor was last positioned were returned from the oplog cache.
+        // Catch the WiredTiger cursor up to the last of them before advancing.
+        _repositionBeforeAdvance = false;
+        setKey(c, _lastReturnedId);
+
+        int cmp;
+        int ret = wiredTigerPrepareConflictRetry(_opCtx, [&] { return c->search_near(c, &cmp); });
+        if (ret == WT_NOTFOUND) {
+            _eof = true;
+            return {};
+        }
+        invariantWTOK(ret);
+
+        // If we landed after the last returned record, that is the record to return next.
+        _skipNextAdvance = cmp > 0;
+    }
+
     RecordId id;
     if (!_skipNextAdvance) {
         // Nothing after the next line can throw WCEs.
@@ -2193,6 +2278,7 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::seekExact(const RecordI
     WiredTigerRecoveryUnit::get(_opCtx)->getSession();
 
     _skipNextAdvance = false;
+    _repositionBeforeAdvance = false;
     WT_CURSOR* c = _cursor->get();
     setKey(c, id);
     // Nothing after the next line can throw WCEs.
@@ -2243,6 +2329,7 @@ bool WiredTigerRecordStoreCursorBase::restore() {
     // This will ensure an active session exists, so any restored cursors will bind to it
     invariant(WiredTigerRecoveryUnit::get(_opCtx)->getSession() == _cursor->getSession());
     _skipNextAdvance = false;
+    _repositionBeforeAdvance = false;
     _hasRestored = true;
 
     // If we've hit EOF, then this iterator is done and need not be restored.
@@ -2292,6 +2379,28 @@ bool WiredTigerRecordStoreCursorBase::restore() {
     return true;
 }
 
+boost::optional<Record> WiredTigerRecordStoreCursorBase::_nextFromOplogCache() {
+    if (!_rs._oplogCache || !_forward || !_oplogVisibleTs || _skipNextAdvance ||
+        _lastReturnedId.isNull()) {
+        return boost::none;
+    }
+
+    // Only return entries that the WiredTiger snapshot would also see.
+    RecordId upTo(*_oplogVisibleTs);
+    if (auto readTimestamp = WiredTigerRecoveryUnit::get(_opCtx)->getPointInTimeReadTimestamp()) {
+        upTo = std::min(upTo, RecordId(readTimestamp->asLL()));
+    }
+
+    auto record = _rs._oplogCache->next(_lastReturnedId, upTo);
+    if (!record) {
+        return boost::none;
+    }
+
+    _lastReturnedId = record->id;
+    _repositionBeforeAdvance = true;
+    return record;
+}
+
 void WiredTigerRecordStoreCursorBase::detachFromOperationContext() {
     _opCtx = nullptr;
     _cursor = boost::none;
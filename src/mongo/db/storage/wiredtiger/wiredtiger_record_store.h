@@ -40,6 +40,7 @@
 #include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_cursor.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_oplog_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
 #include "mongo/platform/atomic_word.h"
@@ -385,6 +386,10 @@ private:
     // Non-null if this record store is underlying the active oplog.
     std::shared_ptr<OplogStones> _oplogStones;
 
+    // Non-null if this record store is underlying the active oplog and wiredTigerOplogCacheSizeMB
+    // is set.
+    std::unique_ptr<WiredTigerOplogCache> _oplogCache;
+
     AtomicWord<int64_t>
         _totalTimeTruncating;            // Cumulative amount of time spent truncating the oplog.
     AtomicWord<int64_t> _truncateCount;  // Cumulative number of truncates of the oplog.
@@ -486,6 +491,16 @@ protected:
 private:
     bool isVisible(const RecordId& id);
 
+    /**
+     * Returns the next record from the record store's oplog cache, if this is a forward oplog
+     * cursor and the cache can serve the record following '_lastReturnedId'.
+     */
+    boost::optional<Record> _nextFromOplogCache();
+
+    // Set when records were returned from the oplog cache, leaving the WiredTiger cursor behind
+    // '_lastReturnedId'.
+    bool _repositionBeforeAdvance = false;
+
     /**
      * This value is used for visibility calculations on what oplog entries can be returned to a
      * client. This value *must* be initialized/updated *before* a WiredTiger snapshot is
@@ -43,6 +43,7 @@
 #include "mongo/db/operation_context_noop.h"
 #include "mongo/db/storage/kv/kv_prefix.h"
 #include "mongo/db/storage/record_store_test_harness.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_parameters_gen.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store_oplog_stones.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
@@ -417,8 +418,9 @@ BSONObj makeBSONObjWithSize(const Timestamp& opTime, int size, char fill = 'x')
 StatusWith<RecordId> insertBSONWithSize(OperationContext* opCtx,
                                         RecordStore* rs,
                                         const Timestamp& opTime,
-                                        int size) {
-    BSONObj obj = makeBSONObjWithSize(opTime, size);
+                                        int size,
+                                        char fill = 'x') {
+    BSONObj obj = makeBSONObjWithSize(opTime, size, fill);
 
     WriteUnitOfWork wuow(opCtx);
     WiredTigerRecordStore* wtrs = checked_cast<WiredTigerRecordStore*>(rs);
@@ -995,5 +997,290 @@ TEST(WiredTigerRecordStoreTest, CursorInActiveTxnAfterSeek) {
     }
 }
 
+unique_ptr<RecordStore> newOplogWithCache(RecordStoreHarnessHelper* harnessHelper) {
+    // The cache is only set up when the oplog is opened.
+    const auto savedCacheSizeMB = gWiredTigerOplogCacheSizeMB;
+    ON_BLOCK_EXIT([&] { gWiredTigerOplogCacheSizeMB = savedCacheSizeMB; });
+    gWiredTigerOplogCacheSizeMB = 1;
+    return harnessHelper->newCappedRecordStore("local.oplog.rs", 100000, -1);
+}
+
+// Records served from the oplog cache own a copy of the entry, whereas records read through the
+// WiredTiger cursor point into the cursor's buffer.
+bool servedFromOplogCache(const Record& record) {
+    return record.data.isOwned();
+}
+
+char fillOf(const Record& record) {
+    return record.data.toBson()["str"].String()[0];
+}
+
+TEST(WiredTigerRecordStoreTest, OplogCacheServesCaughtUpReads) {
+    unique_ptr<RecordStoreHarnessHelper> harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(newOplogWithCache(harnessHelper.get()));
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        for (int inc = 1; inc <= 3; inc++) {
+            ASSERT_OK(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, inc), 100));
+        }
+        rs->waitForAllEarlierOplogWritesToBeVisible(opCtx.get());
+    }
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    auto cursor = rs->getCursor(opCtx.get());
+
+    // The first entry is always read from WiredTiger to position the cursor.
+    auto record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(RecordId(1, 1), record->id);
+    ASSERT_FALSE(servedFromOplogCache(*record));
+
+    for (int inc = 2; inc <= 3; inc++) {
+        record = cursor->next();
+        ASSERT(record);
+        ASSERT_EQ(RecordId(1, inc), record->id);
+        ASSERT_TRUE(servedFromOplogCache(*record));
+        ASSERT_EQ('x', fillOf(*record));
+    }
+
+    ASSERT_FALSE(cursor->next());
+}
+
+// A reader which falls behind the cache's low watermark must reposition its WiredTiger cursor after
+// the last entry it returned from the cache.
+TEST(WiredTigerRecordStoreTest, OplogCacheRepositionsAfterMiss) {
+    unique_ptr<RecordStoreHarnessHelper> harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(newOplogWithCache(harnessHelper.get()));
+
+    // Only two of these entries fit in the 1MB cache, so inserting each one evicts the oldest.
+    const int entrySize = 400 * 1024;
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        for (int inc = 1; inc <= 3; inc++) {
+            ASSERT_OK(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, inc), entrySize));
+        }
+        rs->waitForAllEarlierOplogWritesToBeVisible(opCtx.get());
+    }
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    auto cursor = rs->getCursor(opCtx.get());
+
+    auto record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(RecordId(1, 1), record->id);
+    ASSERT_FALSE(servedFromOplogCache(*record));
+
+    record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(RecordId(1, 2), record->id);
+    ASSERT_TRUE(servedFromOplogCache(*record));
+
+    // Evict the entries following the reader's position.
+    {
+        auto innerClient = harnessHelper->serviceContext()->makeClient("inner");
+        ServiceContext::UniqueOperationContext innerOpCtx(
+            harnessHelper->newOperationContext(innerClient.get()));
+        for (int inc = 4; inc <= 5; inc++) {
+            ASSERT_OK(insertBSONWithSize(innerOpCtx.get(), rs.get(), Timestamp(1, inc), entrySize));
+        }
+    }
+
+    record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(RecordId(1, 3), record->id);
+    ASSERT_FALSE(servedFromOplogCache(*record));
+
+    // The entries inserted after the reader opened its snapshot are not visible to it.
+    ASSERT_FALSE(cursor->next());
+}
+
+TEST(WiredTigerRecordStoreTest, OplogCacheServesReadsAfterRestore) {
+    unique_ptr<RecordStoreHarnessHelper> harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(newOplogWithCache(harnessHelper.get()));
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        for (int inc = 1; inc <= 2; inc++) {
+            ASSERT_OK(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, inc), 100));
+        }
+        rs->waitForAllEarlierOplogWritesToBeVisible(opCtx.get());
+    }
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    auto cursor = rs->getCursor(opCtx.get());
+
+    auto record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(RecordId(1, 1), record->id);
+    record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(RecordId(1, 2), record->id);
+    ASSERT_TRUE(servedFromOplogCache(*record));
+    ASSERT_FALSE(cursor->next());
+
+    cursor->save();
+    opCtx->recoveryUnit()->abandonSnapshot();
+
+    {
+        auto innerClient = harnessHelper->serviceContext()->makeClient("inner");
+        ServiceContext::UniqueOperationContext innerOpCtx(
+            harnessHelper->newOperationContext(innerClient.get()));
+        ASSERT_OK(insertBSONWithSize(innerOpCtx.get(), rs.get(), Timestamp(1, 3), 100));
+        rs->waitForAllEarlierOplogWritesToBeVisible(innerOpCtx.get());
+    }
+
+    ASSERT_TRUE(cursor->restore());
+    record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(RecordId(1, 3), record->id);
+    ASSERT_TRUE(servedFromOplogCache(*record));
+
+    // The WiredTiger cursor is repositioned after the cached entry before looking for more.
+    ASSERT_FALSE(cursor->next());
+}
+
+// Entries removed by cappedTruncateAfter(), as during rollback, must not be served from the cache
+// after the oplog has been rewritten.
+TEST(WiredTigerRecordStoreTest, OplogCacheClearedByCappedTruncateAfter) {
+    unique_ptr<RecordStoreHarnessHelper> harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(newOplogWithCache(harnessHelper.get()));
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        for (int inc = 1; inc <= 3; inc++) {
+            ASSERT_OK(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, inc), 100));
+        }
+        rs->waitForAllEarlierOplogWritesToBeVisible(opCtx.get());
+    }
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        rs->cappedTruncateAfter(opCtx.get(), RecordId(1, 1), false);
+        ASSERT_OK(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 2), 100, 'y'));
+        rs->waitForAllEarlierOplogWritesToBeVisible(opCtx.get());
+    }
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    auto cursor = rs->getCursor(opCtx.get());
+
+    auto record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(RecordId(1, 1), record->id);
+
+    record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(RecordId(1, 2), record->id);
+    ASSERT_FALSE(servedFromOplogCache(*record));
+    ASSERT_EQ('y', fillOf(*record));
+
+    ASSERT_FALSE(cursor->next());
+}
+
+TEST(WiredTigerRecordStoreTest, OplogCacheDropsRolledBackInserts) {
+    unique_ptr<RecordStoreHarnessHelper> harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(newOplogWithCache(harnessHelper.get()));
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        ASSERT_OK(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 1), 100));
+        rs->waitForAllEarlierOplogWritesToBeVisible(opCtx.get());
+    }
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    auto cursor = rs->getCursor(opCtx.get());
+
+    auto record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(RecordId(1, 1), record->id);
+
+    cursor->save();
+    opCtx->recoveryUnit()->abandonSnapshot();
+
+    {
+        auto innerClient = harnessHelper->serviceContext()->makeClient("inner");
+        ServiceContext::UniqueOperationContext innerOpCtx(
+            harnessHelper->newOperationContext(innerClient.get()));
+
+        {
+            // Roll back an insert of the entry.
+            const Timestamp opTime(1, 2);
+            BSONObj obj = makeBSONObjWithSize(opTime, 100, 'z');
+            WriteUnitOfWork wuow(innerOpCtx.get());
+            ASSERT_OK(rs->oplogDiskLocRegister(innerOpCtx.get(), opTime, false));
+            ASSERT_OK(rs->insertRecord(innerOpCtx.get(), obj.objdata(), obj.objsize(), opTime));
+        }
+
+        ASSERT_OK(insertBSONWithSize(innerOpCtx.get(), rs.get(), Timestamp(1, 2), 100, 'y'));
+        rs->waitForAllEarlierOplogWritesToBeVisible(innerOpCtx.get());
+    }
+
+    ASSERT_TRUE(cursor->restore());
+    record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(RecordId(1, 2), record->id);
+    ASSERT_TRUE(servedFromOplogCache(*record));
+    ASSERT_EQ('y', fillOf(*record));
+
+    ASSERT_FALSE(cursor->next());
+}
+
+// Committed entries which are not yet visible in the oplog must not be served from the cache.
+TEST(WiredTigerRecordStoreTest, OplogCacheRespectsOplogVisibility) {
+    ON_BLOCK_EXIT([] { WTPauseOplogVisibilityUpdateLoop.setMode(FailPoint::off); });
+
+    unique_ptr<RecordStoreHarnessHelper> harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(newOplogWithCache(harnessHelper.get()));
+    auto wtrs = checked_cast<WiredTigerRecordStore*>(rs.get());
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        for (int inc = 1; inc <= 2; inc++) {
+            ASSERT_OK(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, inc), 100));
+        }
+        rs->waitForAllEarlierOplogWritesToBeVisible(opCtx.get());
+
+        WTPauseOplogVisibilityUpdateLoop.setMode(FailPoint::alwaysOn);
+        ASSERT_OK(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 3), 100));
+        ASSERT(wtrs->isOpHidden_forTest(RecordId(1, 3)));
+    }
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        auto cursor = rs->getCursor(opCtx.get());
+
+        auto record = cursor->next();
+        ASSERT(record);
+        ASSERT_EQ(RecordId(1, 1), record->id);
+        record = cursor->next();
+        ASSERT(record);
+        ASSERT_EQ(RecordId(1, 2), record->id);
+        ASSERT_TRUE(servedFromOplogCache(*record));
+        ASSERT_FALSE(cursor->next());
+    }
+
+    WTPauseOplogVisibilityUpdateLoop.setMode(FailPoint::off);
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        rs->waitForAllEarlierOplogWritesToBeVisible(opCtx.get());
+    }
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    auto cursor = rs->getCursor(opCtx.get());
+
+    auto record = cursor->next();
+    ASSERT(record);
+    ASSERT_EQ(RecordId(1, 1), record->id);
+    for (int inc = 2; inc <= 3; inc++) {
+        record = cursor->next();
+        ASSERT(record);
+        ASSERT_EQ(RecordId(1, inc), record->id);
+        ASSERT_TRUE(servedFromOplogCache(*record));
+    }
+    ASSERT_FALSE(cursor->next());
+}
+
 }  // namespace
 }  // namespace mongo
@@ -86,6 +86,7 @@ private:
     void onStepUpComplete(OperationContext* opCtx, long long term) override {}
     void onStepDown() override {}
     void onBecomeArbiter() override;
+    void onInitialSyncComplete(OperationContext* opCtx) override {}
 
     void _recoverComponent(OperationContext* opCtx,
                            const BSONObj& in,
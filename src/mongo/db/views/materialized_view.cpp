@@ -0,0 +1,500 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/views/materialized_view.h"
+
+#include <limits>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/exec/document_value/document.h"
+#include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/pipeline/document_source_match.h"
+#include "mongo/db/pipeline/document_source_single_document_transformation.h"
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+
+// Operators which either run JavaScript or are not deterministic, and so whose results cannot be
+// reproduced when a document is later removed from the view.
+const StringDataSet kUnsupportedOperators{
+    "$accumulator", "$function", "$rand", "$sampleRate", "$text", "$where"};
+
+// System variables whose value differs from one write to the next.
+const std::vector<StringData> kUnsupportedVariables{"$$NOW"_sd, "$$CLUSTER_TIME"_sd};
+
+void assertMaintainable(const NamespaceString& viewNss, const BSONObj& obj) {
+    for (auto&& elem : obj) {
+        uassert(4975000,
+                str::stream() << "Materialized view " << viewNss << " cannot use "
+                              << elem.fieldNameStringData(),
+                !kUnsupportedOperators.count(elem.fieldNameStringData()));
+
+        if (elem.type() == String) {
+            for (auto&& variable : kUnsupportedVariables) {
+                uassert(4975001,
+                        str::stream() << "Materialized view " << viewNss << " cannot use "
+                                      << variable,
+                        !elem.valueStringData().startsWith(variable));
+            }
+        } else if (elem.isABSONObj()) {
+            assertMaintainable(viewNss, elem.Obj());
+        }
+    }
+}
+
+/**
+ * An operator expression is an object with a single field whose name starts with '$', as opposed
+ * to a compound _id such as {a: "$a", b: "$b"}.
+ */
+bool isOperatorExpression(const BSONElement& elem) {
+    return elem.type() == Object && elem.Obj().nFields() == 1 &&
+        elem.Obj().firstElementFieldNameStringData().startsWith("$");
+}
+
+BSONObj getObject(const BSONElement& elem) {
+    return elem.type() == Object ? elem.Obj() : BSONObj();
+}
+
+Value negate(const Value& value) {
+    switch (value.getType()) {
+        case NumberInt:
+            if (value.getInt() != std::numeric_limits<int>::min()) {
+                return Value(-value.getInt());
+            }
+            return Value(-static_cast<long long>(value.getInt()));
+        case NumberLong:
+            if (value.getLong() != std::numeric_limits<long long>::min()) {
+                return Value(-value.getLong());
+            }
+            return Value(-static_cast<double>(value.getLong()));
+        case NumberDouble:
+            return Value(-value.getDouble());
+        case NumberDecimal:
+            return Value(value.getDecimal().negate());
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+Value average(const Value& sum, long long count) {
+    if (sum.getType() == NumberDecimal) {
+        return Value(sum.getDecimal().divide(Decimal128(count)));
+    }
+    return Value(sum.coerceToDouble() / count);
+}
+
+}  // namespace
+
+/**
+ * The pipeline of a materialized view, parsed once and shared by the Maintainers of every write to
+ * its source collection. Its ExpressionContext is attached to one operation at a time.
+ */
+class MaterializedView::ParsedPipeline {
+public:
+    struct Accumulated {
+        std::string fieldName;
+        bool isAvg;
+        boost::intrusive_ptr<Expression> argument;
+    };
+
+    // The group key of a source document, and the argument of each accumulator for it.
+    struct Evaluated {
+        Value key;
+        std::vector<Value> arguments;
+    };
+
+    /**
+     * Parses and validates the pipeline of 'view'. Throws if it cannot be maintained.
+     */
+    ParsedPipeline(OperationContext* opCtx, const MaterializedView& view);
+
+    /**
+     * Runs the source document 'doc' through the stages which precede the $group, and returns
+     * boost::none if it is filtered out.
+     */
+    boost::optional<Evaluated> evaluate(OperationContext* opCtx, const BSONObj& doc) const;
+
+    const std::vector<Accumulated>& getAccumulated() const {
+        return _accumulated;
+    }
+
+    /**
+     * Adds 'lhs' and 'rhs' the way $sum does.
+     */
+    Value add(const Value& lhs, const Value& rhs) const;
+
+private:
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("MaterializedView::ParsedPipeline::_mutex");
+    boost::intrusive_ptr<ExpressionContext> _expCtx;
+
+    // The stages which precede the $group, each either a $match or a single document
+    // transformation.
+    std::vector<boost::intrusive_ptr<DocumentSource>> _stages;
+    // The _id of the groups is either computed by '_idExpression', or is a compound key whose
+    // components are computed by '_idComponents'.
+    boost::intrusive_ptr<Expression> _idExpression;
+    std::vector<std::pair<std::string, boost::intrusive_ptr<Expression>>> _idComponents;
+    std::vector<Accumulated> _accumulated;
+};
+
+MaterializedView MaterializedView::parse(const BSONObj& definition) {
+    BSONElement idElem;
+    BSONElement viewOnElem;
+    BSONElement pipelineElem;
+    for (auto&& elem : definition) {
+        const auto fieldName = elem.fieldNameStringData();
+        if (fieldName == "_id"_sd) {
+            idElem = elem;
+        } else if (fieldName == "viewOn"_sd) {
+            viewOnElem = elem;
+        } else if (fieldName == "pipeline"_sd) {
+            pipelineElem = elem;
+        } else {
+            uasserted(4975002,
+                      str::stream()
+                          << "Unknown field in materialized view definition: " << fieldName);
+        }
+    }
+
+    uassert(4975003,
+            "A materialized view definition must have a string _id",
+            idElem.type() == String);
+    uassert(4975004,
+            "A materialized view definition must have a string 'viewOn'",
+            viewOnElem.type() == String);
+    uassert(4975005,
+            "A materialized view definition must have an array 'pipeline'",
+            pipelineElem.type() == Array);
+
+    std::vector<BSONObj> pipeline;
+    for (auto&& stage : pipelineElem.Obj()) {
+        uassert(4975006,
+                "Each stage of a materialized view pipeline must be an object",
+                stage.type() == Object);
+        pipeline.push_back(stage.Obj().getOwned());
+    }
+
+    NamespaceString viewNss(idElem.valueStringData());
+    NamespaceString sourceNss(viewNss.db(), viewOnElem.valueStringData());
+    return MaterializedView(std::move(viewNss), std::move(sourceNss), std::move(pipeline));
+}
+
+MaterializedView::MaterializedView(NamespaceString viewNss,
+                                   NamespaceString sourceNss,
+                                   std::vector<BSONObj> pipeline)
+    : _viewNss(std::move(viewNss)),
+      _sourceNss(std::move(sourceNss)),
+      _pipeline(std::move(pipeline)) {
+    uassert(ErrorCodes::InvalidNamespace,
+            str::stream() << "Invalid materialized view namespace: " << _viewNss,
+            _viewNss.isValid() && !_viewNss.coll().empty() && !_viewNss.isSystem());
+    uassert(ErrorCodes::InvalidNamespace,
+            str::stream() << "Invalid source namespace for materialized view " << _viewNss << ": "
+                          << _sourceNss,
+            NamespaceString::validCollectionName(_sourceNss.coll()) && !_sourceNss.isSystem());
+    uassert(ErrorCodes::InvalidOptions,
+            str::stream() << "Materialized view " << _viewNss << " cannot be defined on itself",
+            _viewNss != _sourceNss);
+}
+
+BSONObj MaterializedView::toBSON() const {
+    BSONObjBuilder builder;
+    builder.append("_id", _viewNss.ns());
+    builder.append("viewOn", _sourceNss.coll());
+    builder.append("pipeline", _pipeline);
+    return builder.obj();
+}
+
+MaterializedView::ParsedPipeline::ParsedPipeline(OperationContext* opCtx,
+                                                 const MaterializedView& view)
+    : _expCtx(make_intrusive<ExpressionContext>(opCtx, nullptr, view.getSourceNss())) {
+    const auto& pipeline = view.getPipeline();
+    uassert(4975007,
+            str::stream() << "The pipeline of materialized view " << view.getViewNss()
+                          << " must end with a $group stage",
+            !pipeline.empty() && pipeline.back().nFields() == 1 &&
+                pipeline.back().firstElementFieldNameStringData() == "$group"_sd);
+
+    for (auto&& stageObj : pipeline) {
+        assertMaintainable(view.getViewNss(), stageObj);
+    }
+
+    for (auto it = pipeline.begin(); it != std::prev(pipeline.end()); ++it) {
+        for (auto&& stage : DocumentSource::parse(_expCtx, *it)) {
+            auto match = dynamic_cast<DocumentSourceMatch*>(stage.get());
+            uassert(4975008,
+                    str::stream() << "Materialized view " << view.getViewNss()
+                                  << " only supports $match and single document transformation "
+                                     "stages before its $group, found "
+                                  << stage->getSourceName(),
+                    (match && !match->isTextQuery()) ||
+                        dynamic_cast<DocumentSourceSingleDocumentTransformation*>(stage.get()));
+            _stages.push_back(std::move(stage));
+        }
+    }
+
+    const auto groupElem = pipeline.back().firstElement();
+    uassert(4975009, "a group's fields must be specified in an object", groupElem.type() == Object);
+    const auto& vps = _expCtx->variablesParseState;
+    for (auto&& elem : groupElem.Obj()) {
+        const auto fieldName = elem.fieldNameStringData();
+        if (fieldName == "_id"_sd) {
+            if (elem.type() == Object && !isOperatorExpression(elem)) {
+                // A compound _id, whose missing components are grouped as null just like $group.
+                for (auto&& component : elem.Obj()) {
+                    _idComponents.emplace_back(
+                        component.fieldName(),
+                        Expression::parseOperand(_expCtx.get(), component, vps));
+                }
+            } else {
+                _idExpression = Expression::parseOperand(_expCtx.get(), elem, vps);
+            }
+            continue;
+        }
+
+        uassert(4975010,
+                str::stream() << "Invalid field name for materialized view " << view.getViewNss()
+                              << ": " << fieldName,
+                !fieldName.startsWith("$") && fieldName.find('.') == std::string::npos &&
+                    fieldName != kStateField);
+        uassert(4975011,
+                str::stream() << "Materialized view " << view.getViewNss()
+                              << " only supports the $sum and $avg accumulators, found "
+                              << elem,
+                elem.type() == Object && elem.Obj().nFields() == 1 &&
+                    (elem.Obj().firstElementFieldNameStringData() == "$sum"_sd ||
+                     elem.Obj().firstElementFieldNameStringData() == "$avg"_sd) &&
+                    elem.Obj().firstElement().type() != Array);
+
+        const auto accumulator = elem.Obj().firstElement();
+        _accumulated.push_back(
+            {fieldName.toString(),
+             accumulator.fieldNameStringData() == "$avg"_sd,
+             Expression::parseOperand(_expCtx.get(), accumulator, vps)});
+    }
+    uassert(4975012,
+            "a group specification must include an _id",
+            _idExpression || !_idComponents.empty());
+
+    // The expressions are evaluated on behalf of later operations, which attach their own
+    // operation context.
+    _expCtx->opCtx = nullptr;
+}
+
+boost::optional<MaterializedView::ParsedPipeline::Evaluated>
+MaterializedView::ParsedPipeline::evaluate(OperationContext* opCtx, const BSONObj& doc) const {
+    // The stages and expressions share the ExpressionContext, whose variables they may set.
+    stdx::lock_guard<Latch> lk(_mutex);
+    _expCtx->opCtx = opCtx;
+    ON_BLOCK_EXIT([&] { _expCtx->opCtx = nullptr; });
+
+    Document current(doc);
+    for (auto&& stage : _stages) {
+        if (auto match = dynamic_cast<DocumentSourceMatch*>(stage.get())) {
+            if (!match->getMatchExpression()->matchesBSON(current.toBson())) {
+                return boost::none;
+            }
+        } else {
+            current = static_cast<DocumentSourceSingleDocumentTransformation*>(stage.get())
+                          ->getTransformer()
+                          .applyTransformation(current);
+        }
+    }
+
+    auto& variables = _expCtx->variables;
+    Evaluated evaluated;
+    if (_idExpression) {
+        evaluated.key = _idExpression->evaluate(current, &variables);
+    } else {
+        MutableDocument compoundKey;
+        for (auto&& [fieldName, expression] : _idComponents) {
+            auto component = expression->evaluate(current, &variables);
+            compoundKey.addField(fieldName, component.missing() ? Value(BSONNULL) : component);
+        }
+        evaluated.key = compoundKey.freezeToValue();
+    }
+    if (evaluated.key.missing()) {
+        evaluated.key = Value(BSONNULL);
+    }
+
+    evaluated.arguments.reserve(_accumulated.size());
+    for (auto&& accumulated : _accumulated) {
+        evaluated.arguments.push_back(accumulated.argument->evaluate(current, &variables));
+    }
+    return evaluated;
+}
+
+Value MaterializedView::ParsedPipeline::add(const Value& lhs, const Value& rhs) const {
+    auto sum = AccumulatorSum::create(_expCtx.get());
+    sum->process(lhs, false);
+    sum->process(rhs, false);
+    return sum->getValue(false);
+}
+
+void MaterializedView::parsePipeline(OperationContext* opCtx) {
+    _parsedPipeline = std::make_shared<const ParsedPipeline>(opCtx, *this);
+}
+
+MaterializedView::Maintainer::Maintainer(OperationContext* opCtx, const MaterializedView& view)
+    : _view(view),
+      _opCtx(opCtx),
+      _pipeline(view._parsedPipeline ? view._parsedPipeline
+                                     : std::make_shared<const ParsedPipeline>(opCtx, view)),
+      _changes(ValueComparator::kInstance.makeUnorderedValueMap<GroupChange>()) {}
+
+
+MaterializedView::Maintainer::~Maintainer() = default;
+
+void MaterializedView::Maintainer::process(const BSONObj& doc, int sign) {
+    invariant(sign == 1 || sign == -1);
+
+    auto evaluated = _pipeline->evaluate(_opCtx, doc);
+    if (!evaluated) {
+        return;
+    }
+
+    const auto& accumulated = _pipeline->getAccumulated();
+    auto [it, inserted] = _changes.try_emplace(evaluated->key);
+    auto& change = it->second;
+    if (inserted) {
+        change.sums.resize(accumulated.size(), Value(0));
+        change.counts.resize(accumulated.size(), 0);
+    }
+
+    change.count += sign;
+    for (size_t i = 0; i < accumulated.size(); ++i) {
+        const auto& argument = evaluated->arguments[i];
+        if (!argument.numeric()) {
+            // Like $sum and $avg, ignore values which are not numbers.
+            continue;
+        }
+        change.sums[i] = _pipeline->add(change.sums[i], sign > 0 ? argument : negate(argument));
+        change.counts[i] += sign;
+    }
+}
+
+std::vector<Value> MaterializedView::Maintainer::getChangedGroups() const {
+    std::vector<Value> keys;
+    keys.reserve(_changes.size());
+    for (auto&& entry : _changes) {
+        keys.push_back(entry.first);
+    }
+    return keys;
+}
+
+BSONObj MaterializedView::Maintainer::applyChanges(const Value& key,
+                                                   const BSONObj& current) const {
+    auto it = _changes.find(key);
+    invariant(it != _changes.end());
+    const auto& change = it->second;
+
+    const auto state = getObject(current[kStateField]);
+    const long long count = state["count"].safeNumberLong() + change.count;
+    if (count <= 0) {
+        return BSONObj();
+    }
+
+    const auto& accumulated = _pipeline->getAccumulated();
+    MutableDocument updated;
+    updated.addField("_id", key);
+    MutableDocument averages;
+    for (size_t i = 0; i < accumulated.size(); ++i) {
+        const auto& fieldName = accumulated[i].fieldName;
+        if (!accumulated[i].isAvg) {
+            auto previous = current.isEmpty() ? Value(0) : Value(current[fieldName]);
+            updated.addField(fieldName, _pipeline->add(previous, change.sums[i]));
+            continue;
+        }
+
+        const auto previous = getObject(getObject(state["avg"])[fieldName]);
+        const long long numValues = previous["count"].safeNumberLong() + change.counts[i];
+        // Once the last value is removed, drop whatever rounding error the sum accumulated.
+        const auto sum =
+            numValues > 0 ? _pipeline->add(Value(previous["sum"]), change.sums[i]) : Value(0);
+        updated.addField(fieldName, numValues > 0 ? average(sum, numValues) : Value(BSONNULL));
+        averages.addField(fieldName, Value(Document{{"sum", sum}, {"count", numValues}}));
+    }
+
+    MutableDocument newState;
+    newState.addField("count", Value(count));
+    if (!averages.peek().empty()) {
+        newState.addField("avg", averages.freezeToValue());
+    }
+    updated.addField(kStateField, newState.freezeToValue());
+    return updated.freeze().toBson();
+}
+
+void MaterializedView::Maintainer::write(OperationContext* opCtx,
+                                         Collection* viewCollection) const {
+    for (auto&& [key, change] : _changes) {
+        uassert(4975013,
+                str::stream() << "Cannot maintain materialized view " << _view.getViewNss()
+                              << ": the group key " << key.toString()
+                              << " is an array, which cannot be the _id of a document",
+                key.getType() != Array);
+
+        BSONObjBuilder idBuilder;
+        key.addToBsonObj(&idBuilder, "_id");
+        const auto idQuery = idBuilder.obj();
+
+        const auto recordId = Helpers::findById(opCtx, viewCollection, idQuery);
+        if (recordId.isNull()) {
+            auto updated = applyChanges(key, BSONObj());
+            if (!updated.isEmpty()) {
+                uassertStatusOK(
+                    viewCollection->insertDocument(opCtx, InsertStatement(updated), nullptr));
+            }
+            continue;
+        }
+
+        const auto current = viewCollection->docFor(opCtx, recordId);
+        auto updated = applyChanges(key, current.value());
+        if (updated.isEmpty()) {
+            viewCollection->deleteDocument(opCtx, kUninitializedStmtId, recordId, nullptr);
+            continue;
+        }
+
+        CollectionUpdateArgs args;
+        args.update = updated;
+        args.criteria = idQuery;
+        const bool indexesAffected = true;
+        viewCollection->updateDocument(
+            opCtx, recordId, current, updated, indexesAffected, nullptr, &args);
+    }
+}
+
+}  // namespace mongo
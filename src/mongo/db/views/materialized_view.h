@@ -0,0 +1,160 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/exec/document_value/value.h"
+#include "mongo/db/exec/document_value/value_comparator.h"
+#include "mongo/db/namespace_string.h"
+
+namespace mongo {
+
+class Collection;
+class OperationContext;
+
+/**
+ * A materialized view stores the result of an aggregation over a collection of the same database
+ * in a collection of its own, and is kept up to date as the documents of the source collection
+ * are inserted, updated and deleted instead of being recomputed.
+ *
+ * Its pipeline is made of any number of $match and single document transformation stages such as
+ * $project or $addFields, followed by one $group whose accumulators are all $sum or $avg, which
+ * can be maintained from a change to a single source document. Each document of the view holds
+ * one group, along with the state needed to maintain it under the field 'kStateField'.
+ */
+class MaterializedView {
+public:
+    class Maintainer;
+    class ParsedPipeline;
+
+    static constexpr StringData kStateField = "_mvState"_sd;
+
+    /**
+     * Parses a definition as stored in config.materializedViews:
+     *     {_id: <view namespace>, viewOn: <source collection name>, pipeline: [<stage>, ...]}
+     * Throws if the definition is malformed. The pipeline itself is validated by constructing a
+     * Maintainer.
+     */
+    static MaterializedView parse(const BSONObj& definition);
+
+    MaterializedView(NamespaceString viewNss,
+                     NamespaceString sourceNss,
+                     std::vector<BSONObj> pipeline);
+
+    const NamespaceString& getViewNss() const {
+        return _viewNss;
+    }
+
+    const NamespaceString& getSourceNss() const {
+        return _sourceNss;
+    }
+
+    const std::vector<BSONObj>& getPipeline() const {
+        return _pipeline;
+    }
+
+    /**
+     * Serializes this view to the format accepted by parse().
+     */
+    BSONObj toBSON() const;
+
+    /**
+     * Parses and validates the pipeline of this view, and keeps the result for the Maintainers
+     * constructed from it afterwards. Throws if the pipeline is invalid.
+     */
+    void parsePipeline(OperationContext* opCtx);
+
+private:
+    NamespaceString _viewNss;
+    NamespaceString _sourceNss;
+    std::vector<BSONObj> _pipeline;
+
+    // Set by parsePipeline(), and shared by the Maintainers of this view.
+    std::shared_ptr<const ParsedPipeline> _parsedPipeline;
+};
+
+/**
+ * Computes the changes made to the groups of a materialized view by a set of source documents
+ * being added or removed, and applies them to the documents of the view. A Maintainer reuses the
+ * pipeline parsed by MaterializedView::parsePipeline(), or else parses it on construction, and is
+ * meant to be used by a single operation.
+ */
+class MaterializedView::Maintainer {
+public:
+    Maintainer(OperationContext* opCtx, const MaterializedView& view);
+    ~Maintainer();
+
+    /**
+     * Records the source document 'doc' being added to the view if 'sign' is 1, or removed from
+     * it if 'sign' is -1.
+     */
+    void process(const BSONObj& doc, int sign);
+
+    /**
+     * Returns the _id of each group that the processed documents belong to.
+     */
+    std::vector<Value> getChangedGroups() const;
+
+    /**
+     * Returns the document of the group 'key' after the processed changes are applied to its
+     * current document 'current', which is empty if the group is new. Returns an empty object if
+     * the group no longer contains any source document and must be removed from the view.
+     */
+    BSONObj applyChanges(const Value& key, const BSONObj& current) const;
+
+    /**
+     * Applies all processed changes to 'viewCollection', which the caller must have locked in at
+     * least MODE_IX inside a WriteUnitOfWork.
+     */
+    void write(OperationContext* opCtx, Collection* viewCollection) const;
+
+private:
+    // The changes made to one group: the number of source documents added to it, and for each
+    // accumulated field, the sum and number of the numeric values added to it.
+    struct GroupChange {
+        long long count = 0;
+        std::vector<Value> sums;
+        std::vector<long long> counts;
+    };
+
+    const MaterializedView& _view;
+    OperationContext* const _opCtx;
+    std::shared_ptr<const ParsedPipeline> _pipeline;
+
+    ValueUnorderedMap<GroupChange> _changes;
+};
+
+}  // namespace mongo
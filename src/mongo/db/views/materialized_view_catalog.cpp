@@ -0,0 +1,142 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/views/materialized_view_catalog.h"
+
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/server_options.h"
+#include "mongo/db/service_context.h"
+#include "mongo/logv2/log.h"
+
+namespace mongo {
+namespace {
+
+const auto getMaterializedViewCatalog =
+    ServiceContext::declareDecoration<MaterializedViewCatalog>();
+
+const ReplicaSetAwareServiceRegistry::Registerer<MaterializedViewCatalog>
+    materializedViewCatalogRegisterer("MaterializedViewCatalog");
+
+}  // namespace
+
+MaterializedViewCatalog* MaterializedViewCatalog::get(ServiceContext* service) {
+    return &getMaterializedViewCatalog(service);
+}
+
+MaterializedViewCatalog* MaterializedViewCatalog::get(OperationContext* opCtx) {
+    return get(opCtx->getServiceContext());
+}
+
+std::shared_ptr<const MaterializedView> MaterializedViewCatalog::lookup(
+    const NamespaceString& viewNss) const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    auto it = _views.find(viewNss);
+    return it == _views.end() ? nullptr : it->second;
+}
+
+std::vector<std::shared_ptr<const MaterializedView>> MaterializedViewCatalog::lookupBySource(
+    const NamespaceString& sourceNss) const {
+    if (_empty.load()) {
+        return {};
+    }
+
+    std::vector<std::shared_ptr<const MaterializedView>> views;
+    stdx::lock_guard<Latch> lk(_mutex);
+    for (auto&& entry : _views) {
+        if (entry.second->getSourceNss() == sourceNss) {
+            views.push_back(entry.second);
+        }
+    }
+    return views;
+}
+
+void MaterializedViewCatalog::put(std::shared_ptr<const MaterializedView> view) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    auto viewNss = view->getViewNss();
+    _views[std::move(viewNss)] = std::move(view);
+    _empty.store(false);
+}
+
+void MaterializedViewCatalog::remove(const NamespaceString& viewNss) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _views.erase(viewNss);
+    _empty.store(_views.empty());
+}
+
+void MaterializedViewCatalog::clear() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _views.clear();
+    _empty.store(true);
+}
+
+bool MaterializedViewCatalog::shouldRegisterReplicaSetAwareService() const {
+    return serverGlobalParams.clusterRole == ClusterRole::None;
+}
+
+void MaterializedViewCatalog::onStepUpBegin(OperationContext* opCtx, long long term) {
+    reload(opCtx);
+}
+
+void MaterializedViewCatalog::onInitialSyncComplete(OperationContext* opCtx) {
+    reload(opCtx);
+}
+
+void MaterializedViewCatalog::reload(OperationContext* opCtx) {
+    std::map<NamespaceString, std::shared_ptr<const MaterializedView>> views;
+
+    DBDirectClient client(opCtx);
+    auto cursor = client.query(NamespaceString::kMaterializedViewsNamespace, BSONObj());
+    while (cursor->more()) {
+        const auto definition = cursor->nextSafe();
+        try {
+            auto view = std::make_shared<MaterializedView>(MaterializedView::parse(definition));
+            view->parsePipeline(opCtx);
+            auto viewNss = view->getViewNss();
+            views.emplace(std::move(viewNss), std::move(view));
+        } catch (const DBException& ex) {
+            LOGV2_WARNING(4975014,
+                          "Ignoring invalid materialized view definition",
+                          "definition"_attr = definition,
+                          "error"_attr = ex.toStatus());
+        }
+    }
+
+    LOGV2(4975015, "Loaded materialized view definitions", "numViews"_attr = views.size());
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    _views = std::move(views);
+    _empty.store(_views.empty());
+}
+
+}  // namespace mongo
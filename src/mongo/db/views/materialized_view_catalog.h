@@ -0,0 +1,106 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/repl/replica_set_aware_service.h"
+#include "mongo/db/views/materialized_view.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/mutex.h"
+
+namespace mongo {
+
+class OperationContext;
+class ServiceContext;
+
+/**
+ * In-memory copy of the materialized view definitions stored in config.materializedViews, which
+ * lets writes to a collection find the views they must maintain. It is kept in sync with the
+ * definitions by MaterializedViewOpObserver, and reloaded at startup, after rollback, after
+ * initial sync and on step-up, when the definitions may have changed without the observer seeing
+ * it.
+ */
+class MaterializedViewCatalog : public ReplicaSetAwareService<MaterializedViewCatalog> {
+public:
+    MaterializedViewCatalog() = default;
+
+
+    static MaterializedViewCatalog* get(ServiceContext* service);
+    static MaterializedViewCatalog* get(OperationContext* opCtx);
+
+    /**
+     * Returns the materialized view stored in the collection 'viewNss', or nullptr if there is
+     * none.
+     */
+    std::shared_ptr<const MaterializedView> lookup(const NamespaceString& viewNss) const;
+
+    /**
+     * Returns the materialized views defined on the collection 'sourceNss'.
+     */
+    std::vector<std::shared_ptr<const MaterializedView>> lookupBySource(
+        const NamespaceString& sourceNss) const;
+
+    /**
+     * Adds 'view' to the catalog, replacing any view with the same namespace.
+     */
+    void put(std::shared_ptr<const MaterializedView> view);
+
+    void remove(const NamespaceString& viewNss);
+
+    void clear();
+
+    /**
+     * Replaces the contents of the catalog with the definitions stored in
+     * config.materializedViews. Definitions which fail to parse are logged and skipped.
+     */
+    void reload(OperationContext* opCtx);
+
+private:
+    bool shouldRegisterReplicaSetAwareService() const final;
+    void onStepUpBegin(OperationContext* opCtx, long long term) final;
+    void onStepUpComplete(OperationContext* opCtx, long long term) final {}
+    void onStepDown() final {}
+    void onBecomeArbiter() final {}
+    void onInitialSyncComplete(OperationContext* opCtx) final;
+
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("MaterializedViewCatalog::_mutex");
+
+    // Materialized views by view namespace.
+    std::map<NamespaceString, std::shared_ptr<const MaterializedView>> _views;
+
+    // Mirrors _views.empty(), so that writes need not take the mutex when there are no views.
+    AtomicWord<bool> _empty{true};
+};
+
+}  // namespace mongo
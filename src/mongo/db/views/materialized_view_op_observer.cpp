@@ -0,0 +1,275 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/views/materialized_view_op_observer.h"
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog_raii.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/views/materialized_view.h"
+#include "mongo/db/views/materialized_view_catalog.h"
+#include "mongo/logv2/log.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+
+// The namespace of the view whose definition is about to be deleted, if any.
+const auto getDeletedViewNss =
+    OperationContext::declareDecoration<boost::optional<NamespaceString>>();
+
+/**
+ * Parses and validates a definition written to config.materializedViews, so that an invalid
+ * definition fails the write, and adds it to the catalog once the write commits.
+ */
+void putDefinitionOnCommit(OperationContext* opCtx, const BSONObj& definition) {
+    auto view = std::make_shared<MaterializedView>(MaterializedView::parse(definition));
+    view->parsePipeline(opCtx);
+
+    auto catalog = MaterializedViewCatalog::get(opCtx);
+    opCtx->recoveryUnit()->onCommit(
+        [catalog, view = std::move(view)](boost::optional<Timestamp>) { catalog->put(view); });
+}
+
+void clearCatalogOnCommit(OperationContext* opCtx) {
+    auto catalog = MaterializedViewCatalog::get(opCtx);
+    opCtx->recoveryUnit()->onCommit([catalog](boost::optional<Timestamp>) { catalog->clear(); });
+}
+
+/**
+ * Deletes the definitions of the materialized views which are stored in, or defined on, the
+ * collection 'nss', which is being dropped or renamed.
+ */
+void removeDefinitionsOf(OperationContext* opCtx, const NamespaceString& nss) {
+    // Secondaries replicate the deletes of the definitions.
+    if (!opCtx->writesAreReplicated()) {
+        return;
+    }
+
+    auto catalog = MaterializedViewCatalog::get(opCtx);
+    std::vector<NamespaceString> viewNsses;
+    if (catalog->lookup(nss)) {
+        viewNsses.push_back(nss);
+    }
+    for (auto&& view : catalog->lookupBySource(nss)) {
+        viewNsses.push_back(view->getViewNss());
+    }
+    if (viewNsses.empty()) {
+        return;
+    }
+
+    AutoGetCollection definitions(opCtx, NamespaceString::kMaterializedViewsNamespace, MODE_IX);
+    if (!definitions.getCollection()) {
+        return;
+    }
+    for (auto&& viewNss : viewNsses) {
+        const auto recordId = Helpers::findById(
+            opCtx, definitions.getCollection(), BSON("_id" << viewNss.ns()));
+        if (recordId.isNull()) {
+            continue;
+        }
+
+        LOGV2(4975018,
+              "Removing materialized view definition, as its collection or the collection it is "
+              "defined on is dropped or renamed",
+              "view"_attr = viewNss,
+              "namespace"_attr = nss);
+        definitions.getCollection()->deleteDocument(
+            opCtx, kUninitializedStmtId, recordId, nullptr);
+    }
+}
+
+/**
+ * Applies a write to the collection 'nss' to the materialized views defined on it. The function
+ * 'processChanges' feeds the documents added and removed by the write to a view's Maintainer.
+ */
+template <typename ProcessChanges>
+void maintainViews(OperationContext* opCtx,
+                   const NamespaceString& nss,
+                   ProcessChanges&& processChanges) {
+    // Secondaries replicate the writes to the views themselves, like those of any collection.
+    if (!opCtx->writesAreReplicated()) {
+        return;
+    }
+
+    for (auto&& view : MaterializedViewCatalog::get(opCtx)->lookupBySource(nss)) {
+        MaterializedView::Maintainer maintainer(opCtx, *view);
+        processChanges(maintainer);
+
+        AutoGetCollection viewCollection(opCtx, view->getViewNss(), MODE_IX);
+        if (!viewCollection.getCollection()) {
+            // The view collection was dropped, which leaves nothing to maintain.
+            continue;
+        }
+        maintainer.write(opCtx, viewCollection.getCollection());
+    }
+}
+
+}  // namespace
+
+void MaterializedViewOpObserver::onInserts(OperationContext* opCtx,
+                                           const NamespaceString& nss,
+                                           OptionalCollectionUUID uuid,
+                                           std::vector<InsertStatement>::const_iterator begin,
+                                           std::vector<InsertStatement>::const_iterator end,
+                                           bool fromMigrate) {
+    if (nss == NamespaceString::kMaterializedViewsNamespace) {
+        for (auto it = begin; it != end; ++it) {
+            putDefinitionOnCommit(opCtx, it->doc);
+        }
+        return;
+    }
+
+    maintainViews(opCtx, nss, [&](MaterializedView::Maintainer& maintainer) {
+        for (auto it = begin; it != end; ++it) {
+            maintainer.process(it->doc, 1);
+        }
+    });
+}
+
+void MaterializedViewOpObserver::onUpdate(OperationContext* opCtx,
+                                          const OplogUpdateEntryArgs& args) {
+    if (args.nss == NamespaceString::kMaterializedViewsNamespace) {
+        putDefinitionOnCommit(opCtx, args.updateArgs.updatedDoc);
+        return;
+    }
+
+    maintainViews(opCtx, args.nss, [&](MaterializedView::Maintainer& maintainer) {
+        uassert(4975016,
+                str::stream() << "Collection " << args.nss
+                              << " is the source of a materialized view, which requires it to "
+                                 "have the recordPreImages option enabled",
+                args.updateArgs.preImageDoc);
+        maintainer.process(*args.updateArgs.preImageDoc, -1);
+        maintainer.process(args.updateArgs.updatedDoc, 1);
+    });
+}
+
+void MaterializedViewOpObserver::aboutToDelete(OperationContext* opCtx,
+                                               const NamespaceString& nss,
+                                               const BSONObj& doc) {
+    auto& deletedViewNss = getDeletedViewNss(opCtx);
+    deletedViewNss = boost::none;
+    if (nss == NamespaceString::kMaterializedViewsNamespace && doc["_id"].type() == String) {
+        deletedViewNss.emplace(doc["_id"].valueStringData());
+    }
+}
+
+void MaterializedViewOpObserver::onDelete(OperationContext* opCtx,
+                                          const NamespaceString& nss,
+                                          OptionalCollectionUUID uuid,
+                                          StmtId stmtId,
+                                          bool fromMigrate,
+                                          const boost::optional<BSONObj>& deletedDoc) {
+    if (nss == NamespaceString::kMaterializedViewsNamespace) {
+        if (auto viewNss = getDeletedViewNss(opCtx)) {
+            auto catalog = MaterializedViewCatalog::get(opCtx);
+            opCtx->recoveryUnit()->onCommit(
+                [catalog, viewNss = *viewNss](boost::optional<Timestamp>) {
+                    catalog->remove(viewNss);
+                });
+        }
+        return;
+    }
+
+    maintainViews(opCtx, nss, [&](MaterializedView::Maintainer& maintainer) {
+        uassert(4975017,
+                str::stream() << "Collection " << nss
+                              << " is the source of a materialized view, which requires it to "
+                                 "have the recordPreImages option enabled",
+                deletedDoc);
+        maintainer.process(*deletedDoc, -1);
+    });
+}
+
+void MaterializedViewOpObserver::onDropDatabase(OperationContext* opCtx,
+                                                const std::string& dbName) {
+    if (dbName == NamespaceString::kMaterializedViewsNamespace.db()) {
+        clearCatalogOnCommit(opCtx);
+    }
+}
+
+repl::OpTime MaterializedViewOpObserver::onDropCollection(OperationContext* opCtx,
+                                                          const NamespaceString& collectionName,
+                                                          OptionalCollectionUUID uuid,
+                                                          std::uint64_t numRecords,
+                                                          CollectionDropType dropType) {
+    if (collectionName == NamespaceString::kMaterializedViewsNamespace) {
+        clearCatalogOnCommit(opCtx);
+    } else {
+        removeDefinitionsOf(opCtx, collectionName);
+    }
+    return {};
+}
+
+repl::OpTime MaterializedViewOpObserver::preRenameCollection(OperationContext* opCtx,
+                                                             const NamespaceString& fromCollection,
+                                                             const NamespaceString& toCollection,
+                                                             OptionalCollectionUUID uuid,
+                                                             OptionalCollectionUUID dropTargetUUID,
+                                                             std::uint64_t numRecords,
+                                                             bool stayTemp) {
+    uassert(4975019,
+            "Cannot rename the collection of the materialized view definitions",
+            !opCtx->writesAreReplicated() ||
+                (fromCollection != NamespaceString::kMaterializedViewsNamespace &&
+                 toCollection != NamespaceString::kMaterializedViewsNamespace));
+
+    removeDefinitionsOf(opCtx, fromCollection);
+    if (dropTargetUUID) {
+        removeDefinitionsOf(opCtx, toCollection);
+    }
+    return {};
+}
+
+void MaterializedViewOpObserver::onRenameCollection(OperationContext* opCtx,
+                                                    const NamespaceString& fromCollection,
+                                                    const NamespaceString& toCollection,
+                                                    OptionalCollectionUUID uuid,
+                                                    OptionalCollectionUUID dropTargetUUID,
+                                                    std::uint64_t numRecords,
+                                                    bool stayTemp) {
+    preRenameCollection(
+        opCtx, fromCollection, toCollection, uuid, dropTargetUUID, numRecords, stayTemp);
+}
+
+void MaterializedViewOpObserver::onReplicationRollback(OperationContext* opCtx,
+                                                       const RollbackObserverInfo& rbInfo) {
+    if (rbInfo.rollbackNamespaces.count(NamespaceString::kMaterializedViewsNamespace)) {
+        MaterializedViewCatalog::get(opCtx)->reload(opCtx);
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,163 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bsonmisc.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/json.h"
+#include "mongo/db/exec/document_value/document_value_test_util.h"
+#include "mongo/db/query/query_test_service_context.h"
+#include "mongo/db/views/materialized_view.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kViewNss("testdb.totals");
+const NamespaceString kSourceNss("testdb.orders");
+
+class MaterializedViewTest : public unittest::Test {
+public:
+    MaterializedViewTest() : _opCtx(_queryServiceContext.makeOperationContext()) {}
+
+    OperationContext* opCtx() {
+        return _opCtx.get();
+    }
+
+    MaterializedView makeView(std::vector<BSONObj> pipeline) {
+        return MaterializedView(kViewNss, kSourceNss, std::move(pipeline));
+    }
+
+private:
+    QueryTestServiceContext _queryServiceContext;
+    ServiceContext::UniqueOperationContext _opCtx;
+};
+
+TEST_F(MaterializedViewTest, DefinitionRoundTripsThroughBSON) {
+    auto definition = BSON("_id" << kViewNss.ns() << "viewOn" << kSourceNss.coll() << "pipeline"
+                                 << BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                                     << "$a"))));
+    auto view = MaterializedView::parse(definition);
+    ASSERT_EQ(view.getViewNss(), kViewNss);
+    ASSERT_EQ(view.getSourceNss(), kSourceNss);
+    ASSERT_BSONOBJ_EQ(view.toBSON(), definition);
+
+    auto unknownField = BSON("x" << 1);
+    ASSERT_THROWS_CODE(MaterializedView::parse(definition.addField(unknownField.firstElement())),
+                       AssertionException,
+                       4975002);
+}
+
+TEST_F(MaterializedViewTest, RejectsPipelinesWhichCannotBeMaintained) {
+    auto assertRejected = [&](std::vector<BSONObj> pipeline, int code) {
+        auto view = makeView(std::move(pipeline));
+        ASSERT_THROWS_CODE(MaterializedView::Maintainer(opCtx(), view), AssertionException, code);
+    };
+
+    assertRejected({fromjson("{$match: {a: 1}}")}, 4975007);
+    assertRejected({fromjson("{$sort: {a: 1}}"), fromjson("{$group: {_id: '$a'}}")}, 4975008);
+    assertRejected({fromjson("{$group: {_id: '$a', m: {$min: '$x'}}}")}, 4975011);
+    assertRejected({fromjson("{$group: {_id: '$a', s: {$sum: {$rand: {}}}}}")}, 4975000);
+    assertRejected({fromjson("{$addFields: {t: '$$NOW'}}"), fromjson("{$group: {_id: '$t'}}")},
+                   4975001);
+    assertRejected({fromjson("{$group: {s: {$sum: '$x'}}}")}, 4975012);
+}
+
+TEST_F(MaterializedViewTest, MaintainsSumAndAverageAsDocumentsAreAddedAndRemoved) {
+    auto view =
+        makeView({fromjson("{$group: {_id: '$a', total: {$sum: '$x'}, mean: {$avg: '$x'}}}")});
+
+    MaterializedView::Maintainer inserts(opCtx(), view);
+    inserts.process(BSON("a" << 1 << "x" << 2), 1);
+    inserts.process(BSON("a" << 1 << "x" << 4), 1);
+    inserts.process(BSON("a" << 2 << "x"
+                             << "not a number"),
+                    1);
+    ASSERT_EQ(inserts.getChangedGroups().size(), 2UL);
+
+    auto group = inserts.applyChanges(Value(1), BSONObj());
+    ASSERT_BSONOBJ_EQ(group,
+                      fromjson("{_id: 1, total: 6, mean: 3, _mvState: {count: 2, avg: {mean: "
+                               "{sum: 6, count: 2}}}}"));
+    ASSERT_BSONOBJ_EQ(inserts.applyChanges(Value(2), BSONObj()),
+                      fromjson("{_id: 2, total: 0, mean: null, _mvState: {count: 1, avg: {mean: "
+                               "{sum: 0, count: 0}}}}"));
+
+    MaterializedView::Maintainer update(opCtx(), view);
+    update.process(BSON("a" << 1 << "x" << 2), -1);
+    update.process(BSON("a" << 1 << "x" << 10), 1);
+    group = update.applyChanges(Value(1), group);
+    ASSERT_BSONOBJ_EQ(group,
+                      fromjson("{_id: 1, total: 14, mean: 7, _mvState: {count: 2, avg: {mean: "
+                               "{sum: 14, count: 2}}}}"));
+
+    MaterializedView::Maintainer deletes(opCtx(), view);
+    deletes.process(BSON("a" << 1 << "x" << 4), -1);
+    deletes.process(BSON("a" << 1 << "x" << 10), -1);
+    ASSERT_BSONOBJ_EQ(deletes.applyChanges(Value(1), group), BSONObj());
+}
+
+TEST_F(MaterializedViewTest, AppliesStagesBeforeGroupingAndGroupsMissingKeysAsNull) {
+    auto view = makeView({fromjson("{$match: {status: 'A'}}"),
+                          fromjson("{$addFields: {y: {$multiply: ['$x', 2]}}}"),
+                          fromjson("{$group: {_id: {a: '$a', b: '$b'}, total: {$sum: '$y'}}}")});
+
+    MaterializedView::Maintainer maintainer(opCtx(), view);
+    maintainer.process(fromjson("{status: 'A', a: 1, x: 3}"), 1);
+    maintainer.process(fromjson("{status: 'B', a: 1, x: 100}"), 1);
+    maintainer.process(fromjson("{status: 'A', a: 1, b: null, x: 4}"), 1);
+
+    auto groups = maintainer.getChangedGroups();
+    ASSERT_EQ(groups.size(), 1UL);
+    ASSERT_VALUE_EQ(groups[0], Value(fromjson("{a: 1, b: null}")));
+    ASSERT_BSONOBJ_EQ(maintainer.applyChanges(groups[0], BSONObj()),
+                      fromjson("{_id: {a: 1, b: null}, total: 14, _mvState: {count: 2}}"));
+}
+
+TEST_F(MaterializedViewTest, MaintainersShareTheParsedPipeline) {
+    auto invalid = makeView({fromjson("{$match: {a: 1}}")});
+    ASSERT_THROWS_CODE(invalid.parsePipeline(opCtx()), AssertionException, 4975007);
+
+    auto view = makeView({fromjson(
+        "{$group: {_id: '$a', total: {$sum: {$let: {vars: {d: {$multiply: ['$x', 2]}}, in: "
+        "'$$d'}}}}}")});
+    view.parsePipeline(opCtx());
+
+    BSONObj group;
+    for (int x : {1, 2, 3}) {
+        MaterializedView::Maintainer maintainer(opCtx(), view);
+        maintainer.process(BSON("a" << 1 << "x" << x), 1);
+        group = maintainer.applyChanges(Value(1), group);
+    }
+    ASSERT_BSONOBJ_EQ(group, fromjson("{_id: 1, total: 12, _mvState: {count: 3}}"));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -327,6 +327,13 @@ public:
         return _hostAndPort;
     }
 
+    /**
+     * Returns the id the controller knows this pool by.
+     */
+    PoolId id() const {
+        return _id;
+    }
+
     /**
      * Return true if the tags on the specific pool match the passed in tags
      */
@@ -576,6 +583,7 @@ void ConnectionPool::appendConnectionStats(ConnectionPoolStats* stats) const {
                                      pool->availableConnections(),
                                      pool->createdConnections(),
                                      pool->refreshingConnections()};
+        hostStats.target = _controller->getControls(pool->id()).targetConnections;
         stats->updateStatsForHost(_name, host, hostStats);
     }
 }
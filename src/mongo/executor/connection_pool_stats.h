@@ -50,6 +50,9 @@ struct ConnectionStatsPer {
     size_t available = 0u;
     size_t created = 0u;
     size_t refreshing = 0u;
+
+    // The number of connections the pool controller is currently asking for.
+    size_t target = 0u;
 };
 
 /**
@@ -66,6 +69,7 @@ struct ConnectionPoolStats {
     size_t totalAvailable = 0u;
     size_t totalCreated = 0u;
     size_t totalRefreshing = 0u;
+    size_t totalTarget = 0u;
 
     using StatsByHost = std::map<HostAndPort, ConnectionStatsPer>;
 
@@ -41,6 +41,7 @@
 #include <fmt/ostream.h>
 
 #include "mongo/executor/connection_pool.h"
+#include "mongo/executor/connection_pool_stats.h"
 #include "mongo/stdx/future.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/scopeguard.h"
@@ -960,6 +961,38 @@ TEST_F(ConnectionPoolTest, minPoolRespected) {
 }
 
 
+/**
+ * Verify that the controller's target for a host is reported in the connection stats.
+ */
+TEST_F(ConnectionPoolTest, statsReportTarget) {
+    ConnectionPool::Options options;
+    options.minConnections = 2;
+    options.maxConnections = 3;
+    auto pool = makePool(options);
+
+    ConnectionPool::ConnectionHandle conn;
+    ConnectionImpl::pushSetup(Status::OK());
+    ConnectionImpl::pushSetup(Status::OK());
+    pool->get_forTest(HostAndPort(),
+                      Milliseconds(5000),
+                      [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                          ASSERT(swConn.isOK());
+                          conn = std::move(swConn.getValue());
+                      });
+    ASSERT(conn);
+
+    ConnectionPoolStats stats;
+    pool->appendConnectionStats(&stats);
+
+    // One connection is in use, but minConnections keeps the target at two
+    const auto& hostStats = stats.statsByHost[HostAndPort()];
+    ASSERT_EQ(hostStats.inUse, 1u);
+    ASSERT_EQ(hostStats.target, 2u);
+    ASSERT_EQ(stats.totalTarget, 2u);
+
+    doneWith(conn);
+}
+
 /**
  * Verify that the hostTimeout is respected. This implies that an idle
  * hostAndPort drops it's connections.
@@ -0,0 +1,156 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/executor/host_latency_stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/platform/bits.h"
+
+namespace mongo {
+
+namespace {
+const auto hostLatencyStatsDecoration = ServiceContext::declareDecoration<HostLatencyStats>();
+}  // namespace
+
+HostLatencyStats::HostLatencyStats() : _random(SecureRandom().nextInt64()) {}
+
+HostLatencyStats* HostLatencyStats::get(ServiceContext* service) {
+    return &hostLatencyStatsDecoration(service);
+}
+
+void HostLatencyStats::recordRequestStarted(const HostAndPort& host) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _hosts[host].numInFlight++;
+}
+
+void HostLatencyStats::recordRequestFinished(const HostAndPort& host,
+                                             boost::optional<Microseconds> latency) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    auto it = _hosts.find(host);
+    if (it == _hosts.end()) {
+        return;
+    }
+
+    auto& data = it->second;
+    if (data.numInFlight > 0) {
+        data.numInFlight--;
+    }
+
+    if (!latency) {
+        return;
+    }
+
+    data.buckets[_bucketFor(*latency)]++;
+    if (++data.numSamples < kMaxSamples) {
+        return;
+    }
+
+    data.numSamples = 0;
+    for (auto& count : data.buckets) {
+        count /= 2;
+        data.numSamples += count;
+    }
+}
+
+void HostLatencyStats::removeHost(const HostAndPort& host) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _hosts.erase(host);
+}
+
+boost::optional<Microseconds> HostLatencyStats::getLatencyPercentile(const HostAndPort& host,
+                                                                     double percentile) const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    auto it = _hosts.find(host);
+    if (it == _hosts.end()) {
+        return boost::none;
+    }
+    return _percentile(it->second, percentile);
+}
+
+void HostLatencyStats::selectHost(std::vector<HostAndPort>* hosts) {
+    if (hosts->size() < 2) {
+        return;
+    }
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    const auto size = static_cast<int64_t>(hosts->size());
+    const auto first = _random.nextInt64(size);
+    const auto second = (first + 1 + _random.nextInt64(size - 1)) % size;
+
+    const auto firstWait = _expectedWait(lk, (*hosts)[first]);
+    const auto secondWait = _expectedWait(lk, (*hosts)[second]);
+    auto chosen = first;
+    if (firstWait && (!secondWait || *secondWait < *firstWait)) {
+        chosen = second;
+    }
+
+    std::rotate(hosts->begin(), hosts->begin() + chosen, hosts->begin() + chosen + 1);
+}
+
+size_t HostLatencyStats::_bucketFor(Microseconds latency) {
+    const auto micros = static_cast<uint64_t>(std::max<int64_t>(latency.count(), 1));
+    return std::min<size_t>(63 - countLeadingZeros64(micros), kNumBuckets - 1);
+}
+
+boost::optional<Microseconds> HostLatencyStats::_percentile(const HostData& data,
+                                                            double percentile) {
+    if (data.numSamples == 0) {
+        return boost::none;
+    }
+
+    const auto rank = static_cast<uint64_t>(std::ceil(percentile * data.numSamples));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+        seen += data.buckets[i];
+        if (seen >= rank) {
+            return Microseconds(int64_t(1) << (i + 1));
+        }
+    }
+    return Microseconds(int64_t(1) << kNumBuckets);
+}
+
+boost::optional<double> HostLatencyStats::_expectedWait(WithLock, const HostAndPort& host) const {
+    auto it = _hosts.find(host);
+    if (it == _hosts.end()) {
+        return boost::none;
+    }
+
+    auto median = _percentile(it->second, 0.5);
+    if (!median) {
+        return boost::none;
+    }
+    return static_cast<double>(durationCount<Microseconds>(*median)) *
+        (it->second.numInFlight + 1);
+}
+
+}  // namespace mongo
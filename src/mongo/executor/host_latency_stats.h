@@ -0,0 +1,122 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "mongo/db/service_context.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/platform/random.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/duration.h"
+#include "mongo/util/net/hostandport.h"
+
+namespace mongo {
+
+/**
+ * Server-wide record of the response latency and number of in-flight requests observed for each
+ * remote host, used to steer reads away from slow or overloaded replica set members.
+ *
+ * Latencies are kept in a histogram with power-of-two buckets, so recording a sample is constant
+ * time. Once a host accumulates kMaxSamples samples, its bucket counts are halved, which ages out
+ * old observations and lets the histogram follow changes in the host's behavior.
+ */
+class HostLatencyStats {
+    HostLatencyStats(const HostLatencyStats&) = delete;
+    HostLatencyStats& operator=(const HostLatencyStats&) = delete;
+
+public:
+    static constexpr size_t kNumBuckets = 40;
+    static constexpr uint64_t kMaxSamples = 1024;
+
+    HostLatencyStats();
+
+    static HostLatencyStats* get(ServiceContext* service);
+
+    /**
+     * Must be paired with a later call to recordRequestFinished() for the same host.
+     */
+    void recordRequestStarted(const HostAndPort& host);
+
+    /**
+     * Marks a request to 'host' as no longer in flight. The latency sample is only recorded if
+     * provided, so that failed requests do not make a host appear faster than it is. Does nothing
+     * if 'host' was removed since the request started.
+     */
+    void recordRequestFinished(const HostAndPort& host, boost::optional<Microseconds> latency);
+
+    /**
+     * Forgets everything recorded for 'host', which is no longer a member of any monitored
+     * topology.
+     */
+    void removeHost(const HostAndPort& host);
+
+    /**
+     * Returns an upper bound on the given percentile (in the range (0, 1]) of the latencies
+     * recorded for 'host', or boost::none if no latency has been recorded for it yet.
+     */
+    boost::optional<Microseconds> getLatencyPercentile(const HostAndPort& host,
+                                                       double percentile) const;
+
+    /**
+     * Chooses one of 'hosts' using the power of two choices: two distinct candidates are drawn at
+     * random and the one with the lower expected wait (median latency scaled by the number of
+     * in-flight requests) wins. Hosts without latency samples are always preferred so that they
+     * get a chance to be measured. The chosen host is moved to the front of 'hosts' and the
+     * relative order of the others is preserved.
+     */
+    void selectHost(std::vector<HostAndPort>* hosts);
+
+private:
+    struct HostData {
+        std::array<uint64_t, kNumBuckets> buckets{};
+        uint64_t numSamples{0};
+        int64_t numInFlight{0};
+    };
+
+    static size_t _bucketFor(Microseconds latency);
+
+    static boost::optional<Microseconds> _percentile(const HostData& data, double percentile);
+
+    // Returns the expected wait for a new request to the given host, or boost::none if the host
+    // has no latency samples.
+    boost::optional<double> _expectedWait(WithLock, const HostAndPort& host) const;
+
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("HostLatencyStats::_mutex");
+
+    stdx::unordered_map<HostAndPort, HostData> _hosts;
+
+    PseudoRandom _random;
+};
+
+}  // namespace mongo
@@ -0,0 +1,131 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/executor/host_latency_stats.h"
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const HostAndPort kFast("fast", 27017);
+const HostAndPort kSlow("slow", 27017);
+
+void recordLatency(HostLatencyStats* stats, const HostAndPort& host, Microseconds latency) {
+    stats->recordRequestStarted(host);
+    stats->recordRequestFinished(host, latency);
+}
+
+TEST(HostLatencyStatsTest, NoPercentileWithoutSamples) {
+    HostLatencyStats stats;
+    ASSERT_FALSE(stats.getLatencyPercentile(kFast, 0.5));
+
+    stats.recordRequestStarted(kFast);
+    stats.recordRequestFinished(kFast, boost::none);
+    ASSERT_FALSE(stats.getLatencyPercentile(kFast, 0.5));
+}
+
+TEST(HostLatencyStatsTest, RemoveHostForgetsSamples) {
+    HostLatencyStats stats;
+    recordLatency(&stats, kFast, Microseconds(100));
+    stats.recordRequestStarted(kFast);
+
+    stats.removeHost(kFast);
+    ASSERT_FALSE(stats.getLatencyPercentile(kFast, 0.5));
+
+    // A request which was in flight when the host was removed does not bring it back.
+    stats.recordRequestFinished(kFast, Microseconds(100));
+    ASSERT_FALSE(stats.getLatencyPercentile(kFast, 0.5));
+}
+
+TEST(HostLatencyStatsTest, PercentilesAreBucketUpperBounds) {
+    HostLatencyStats stats;
+    for (int i = 0; i < 90; ++i) {
+        recordLatency(&stats, kFast, Microseconds(100));
+    }
+    for (int i = 0; i < 10; ++i) {
+        recordLatency(&stats, kFast, Microseconds(5000));
+    }
+
+    ASSERT_EQ(Microseconds(128), *stats.getLatencyPercentile(kFast, 0.5));
+    ASSERT_EQ(Microseconds(128), *stats.getLatencyPercentile(kFast, 0.9));
+    ASSERT_EQ(Microseconds(8192), *stats.getLatencyPercentile(kFast, 0.95));
+}
+
+TEST(HostLatencyStatsTest, OldSamplesDecay) {
+    HostLatencyStats stats;
+    for (uint64_t i = 0; i < HostLatencyStats::kMaxSamples; ++i) {
+        recordLatency(&stats, kFast, Microseconds(5000));
+    }
+    for (uint64_t i = 0; i < HostLatencyStats::kMaxSamples; ++i) {
+        recordLatency(&stats, kFast, Microseconds(100));
+    }
+
+    ASSERT_EQ(Microseconds(128), *stats.getLatencyPercentile(kFast, 0.5));
+}
+
+TEST(HostLatencyStatsTest, SelectHostPrefersLowerLatency) {
+    HostLatencyStats stats;
+    recordLatency(&stats, kFast, Microseconds(100));
+    recordLatency(&stats, kSlow, Microseconds(5000));
+
+    for (int i = 0; i < 10; ++i) {
+        std::vector<HostAndPort> hosts{kSlow, kFast};
+        stats.selectHost(&hosts);
+        ASSERT_EQ(kFast, hosts[0]);
+        ASSERT_EQ(kSlow, hosts[1]);
+    }
+}
+
+TEST(HostLatencyStatsTest, SelectHostAccountsForInFlightRequests) {
+    HostLatencyStats stats;
+    recordLatency(&stats, kFast, Microseconds(100));
+    recordLatency(&stats, kSlow, Microseconds(500));
+    for (int i = 0; i < 10; ++i) {
+        stats.recordRequestStarted(kFast);
+    }
+
+    std::vector<HostAndPort> hosts{kFast, kSlow};
+    stats.selectHost(&hosts);
+    ASSERT_EQ(kSlow, hosts[0]);
+}
+
+TEST(HostLatencyStatsTest, SelectHostPrefersUnsampledHost) {
+    HostLatencyStats stats;
+    recordLatency(&stats, kFast, Microseconds(100));
+
+    std::vector<HostAndPort> hosts{kFast, kSlow};
+    stats.selectHost(&hosts);
+    ASSERT_EQ(kSlow, hosts[0]);
+}
+
+}  // namespace
+}  // namespace mongo
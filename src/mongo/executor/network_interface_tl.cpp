@@ -36,6 +36,8 @@
 #include "mongo/db/server_options.h"
 #include "mongo/executor/connection_pool_tl.h"
 #include "mongo/executor/hedging_metrics.h"
+#include "mongo/executor/host_latency_stats.h"
+#include "mongo/executor/host_latency_stats_gen.h"
 #include "mongo/logv2/log.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/transport/transport_layer_manager.h"
@@ -48,6 +50,16 @@ namespace executor {
 
 namespace {
 static inline const std::string kMaxTimeMSOpOnlyField = "maxTimeMSOpOnly";
+
+/**
+ * Returns whether 'request' waits on the remote for new data or a topology change, such as an
+ * awaitable hello or a getMore on an awaitData cursor, rather than returning as soon as possible.
+ */
+bool isLongPoll(const RemoteCommandRequest& request) {
+    const auto& cmdObj = request.cmdObj;
+    return cmdObj.hasField("maxAwaitTimeMS") ||
+        (cmdObj.firstElementFieldNameStringData() == "getMore"_sd && cmdObj.hasField("maxTimeMS"));
+}
 }  // unnamed namespace
 
 /**
@@ -268,9 +280,14 @@ NetworkInterfaceTL::CommandStateBase::CommandStateBase(
     : interface(interface_),
       requestOnAny(std::move(request_)),
       cbHandle(cbHandle_),
-      timer(interface->_reactor->makeTimer()),
       finishLine(1),
-      operationKey(requestOnAny.operationKey) {}
+      operationKey(requestOnAny.operationKey) {
+    // Commands without a timeout never arm the timer, so skip allocating one. A scatter/gather
+    // from mongos can start hundreds of these commands at once.
+    if (requestOnAny.timeout != RemoteCommandRequestOnAny::kNoTimeout) {
+        timer = interface->_reactor->makeTimer();
+    }
+}
 
 NetworkInterfaceTL::CommandState::CommandState(NetworkInterfaceTL* interface_,
                                                RemoteCommandRequestOnAny request_,
@@ -328,6 +345,7 @@ void NetworkInterfaceTL::CommandStateBase::setTimer() {
         return;
     }
 
+    invariant(timer);
     const auto nowVal = interface->now();
     if (nowVal >= deadline) {
         auto connDuration = stopwatch.elapsed();
@@ -383,7 +401,9 @@ void NetworkInterfaceTL::CommandStateBase::tryFinish(Status status) noexcept {
         4646302, 2, "Finished request", "requestId"_attr = requestOnAny.id, "status"_attr = status);
 
     // The command has resolved one way or another.
-    timer->cancel(baton);
+    if (timer) {
+        timer->cancel(baton);
+    }
 
     if (interface->_counters) {
         // Increment our counters for the integration test
@@ -780,6 +800,17 @@ void NetworkInterfaceTL::RequestManager::trySend(
         counters->recordSent();
     }
 
+    // Exhaust and other long-poll commands wait on the remote for an event or a timeout, so their
+    // response time says nothing about the latency of the host.
+    requestState->recordsLatency = cmdState->interface->_svcCtx &&
+        gAdaptiveReplicaSelectionEnabled.load() &&
+        !dynamic_cast<ExhaustCommandState*>(cmdState) && !isLongPoll(*requestState->request);
+    if (requestState->recordsLatency) {
+        HostLatencyStats::get(cmdState->interface->_svcCtx)
+            ->recordRequestStarted(requestState->host);
+        requestState->sendTimer.reset();
+    }
+
     requestState->resolve(cmdState->sendRequest(requestState));
 }
 
@@ -808,6 +839,17 @@ void NetworkInterfaceTL::RequestState::resolve(Future<RemoteCommandResponse> fut
             returnConnection(status);
 
             auto commandStatus = getStatusFromCommandResult(response.data);
+
+            if (recordsLatency) {
+                // Only complete round trips are representative of the host's latency. Hedged
+                // requests that hit their maxTimeMS were cut short on purpose.
+                auto isRoundTrip = status.isOK() &&
+                    !(isHedge && commandStatus == ErrorCodes::MaxTimeMSExpired);
+                HostLatencyStats::get(interface()->_svcCtx)->recordRequestFinished(
+                    host,
+                    isRoundTrip ? boost::make_optional(Microseconds(sendTimer.micros()))
+                                : boost::none);
+            }
             // Ignore maxTimeMS expiration errors for hedged reads without triggering the finish
             // line.
             if (isHedge && commandStatus == ErrorCodes::MaxTimeMSExpired) {
@@ -44,6 +44,7 @@
 #include "mongo/transport/transport_layer.h"
 #include "mongo/util/hierarchical_acquisition.h"
 #include "mongo/util/strong_weak_finish_line.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace executor {
@@ -169,6 +170,8 @@ private:
         ClockSource::StopWatch stopwatch;
 
         BatonHandle baton;
+
+        // Only allocated when the request has a timeout.
         std::unique_ptr<transport::ReactorTimer> timer;
 
         std::unique_ptr<RequestManager> requestManager;
@@ -289,6 +292,12 @@ private:
 
         ClockSource::StopWatch stopwatch;
 
+        // Measures the round trip of the request once it has been handed to the connection.
+        Timer sendTimer;
+
+        // True if the request is accounted for in the HostLatencyStats of its host.
+        bool recordsLatency{false};
+
         RequestManager* const requestManager{nullptr};
 
         boost::optional<RemoteCommandRequest> request;
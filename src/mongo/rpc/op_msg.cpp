@@ -65,6 +65,26 @@ enum class Section : uint8_t {
 
 constexpr int kCrc32Size = 4;
 
+/**
+ * Returns the number of documents in a document sequence by walking their length prefixes only.
+ * This lets the parser size the sequence once instead of growing it document by document, which
+ * matters for large bulk inserts. Stops at the first implausible length; the validating pass that
+ * follows is responsible for reporting it.
+ */
+size_t countDocumentsInSequence(const void* data, unsigned len) {
+    BufReader seqBuf(data, len);
+    size_t count = 0;
+    while (seqBuf.remaining() >= sizeof(int32_t)) {
+        const int32_t size = seqBuf.peek<LittleEndian<int32_t>>();
+        if (size < BSONObj::kMinBSONLength || static_cast<unsigned>(size) > seqBuf.remaining()) {
+            break;
+        }
+        seqBuf.skip(size);
+        ++count;
+    }
+    return count;
+}
+
 #ifdef MONGO_CONFIG_WIREDTIGER_ENABLED
 // All fields including size, requestId, and responseTo must already be set. The size must already
 // include the final 4-byte checksum.
@@ -182,8 +202,10 @@ OpMsg OpMsg::parse(const Message& message) try {
                         !msg.getSequence(name));  // TODO IDL
 
                 msg.sequences.push_back({name.toString()});
+                auto& objs = msg.sequences.back().objs;
+                objs.reserve(countDocumentsInSequence(seqBuf.pos(), seqBuf.remaining()));
                 while (!seqBuf.atEof()) {
-                    msg.sequences.back().objs.push_back(seqBuf.read<Validated<BSONObj>>());
+                    objs.push_back(seqBuf.read<Validated<BSONObj>>());
                 }
                 break;
             }
@@ -219,6 +219,29 @@ TEST_F(OpMsgParser, SucceedsWithBodyThenSequence) {
     ASSERT_BSONOBJ_EQ(msg.sequences[0].objs[1], fromjson("{a: 2}"));
 }
 
+TEST_F(OpMsgParser, SucceedsWithLargeSequenceSizedExactly) {
+    const int kNumDocs = 1000;
+
+    OpMsgBuilder builder;
+    {
+        auto docSeq = builder.beginDocSequence("docs");
+        for (int i = 0; i < kNumDocs; ++i) {
+            docSeq.append(BSON("a" << i));
+        }
+    }
+    builder.setBody(fromjson("{ping: 1}"));
+    auto msg = OpMsg::parse(builder.finish());
+
+    ASSERT_EQ(msg.sequences.size(), 1u);
+    const auto& objs = msg.sequences[0].objs;
+    ASSERT_EQ(objs.size(), size_t(kNumDocs));
+    // The parser counts the documents up front and sizes the sequence once.
+    ASSERT_EQ(objs.capacity(), objs.size());
+    for (int i = 0; i < kNumDocs; ++i) {
+        ASSERT_BSONOBJ_EQ(objs[i], BSON("a" << i));
+    }
+}
+
 TEST_F(OpMsgParser, SucceedsWithSequenceThenBody) {
     auto msg =
         OpMsgBytes{
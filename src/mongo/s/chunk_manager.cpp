@@ -52,6 +52,10 @@ namespace {
 // Used to generate sequence numbers to assign to each newly created RoutingTableHistory
 AtomicWord<unsigned> nextCMSequenceNumber(0);
 
+// Maximum number of chunks in each of the blocks a ChunkMap is divided into. Applying changed
+// chunks to a ChunkMap copies the blocks the changes fall into.
+const size_t kMaxChunksPerBlock = 1024;
+
 bool allElementsAreOfType(BSONType type, const BSONObj& obj) {
     for (auto&& elem : obj) {
         if (elem.type() != type) {
@@ -67,6 +71,74 @@ void checkAllElementsAreOfType(BSONType type, const BSONObj& o) {
             allElementsAreOfType(type, o));
 }
 
+/**
+ * Returns the first 8 bytes of 'keyString' as a big-endian integer, padded with zeroes. For any two
+ * KeyStrings a < b, keyStringPrefix(a) <= keyStringPrefix(b).
+ */
+uint64_t keyStringPrefix(const std::string& keyString) {
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < sizeof(prefix); ++i) {
+        prefix <<= 8;
+        if (i < keyString.size()) {
+            prefix |= static_cast<unsigned char>(keyString[i]);
+        }
+    }
+    return prefix;
+}
+
+/**
+ * Returns the index of the first of the max KeyStrings with the given packed 'prefixes' which is
+ * greater than 'keyString' (or not less than it, if 'isMaxInclusive' is false), or the number of
+ * prefixes if there is none. 'getMaxKeyString' returns the full max KeyString at an index.
+ */
+template <typename GetMaxKeyString>
+size_t findFirstMaxKeyStringAfter(const std::vector<uint64_t>& prefixes,
+                                  const std::string& keyString,
+                                  bool isMaxInclusive,
+                                  GetMaxKeyString&& getMaxKeyString) {
+    // Max KeyStrings whose prefix is less than (greater than) that of 'keyString' are less than
+    // (greater than) 'keyString', so only those with an equal prefix need to be compared in full.
+    const auto prefixRange =
+        std::equal_range(prefixes.begin(), prefixes.end(), keyStringPrefix(keyString));
+    size_t low = prefixRange.first - prefixes.begin();
+    size_t high = prefixRange.second - prefixes.begin();
+
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const auto& maxKeyString = getMaxKeyString(mid);
+        const bool isBefore =
+            isMaxInclusive ? !(keyString < maxKeyString) : maxKeyString < keyString;
+        if (isBefore) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * Throws if 'next' does not start where 'previous' ends and the two chunks are on different shards.
+ */
+void checkContinuity(const ChunkInfo& previous, const ChunkInfo& next) {
+    if (next.getShardIdAt(boost::none) == previous.getShardIdAt(boost::none) ||
+        SimpleBSONObjComparator::kInstance.evaluate(previous.getMax() == next.getMin())) {
+        return;
+    }
+
+    if (SimpleBSONObjComparator::kInstance.evaluate(previous.getMax() < next.getMin()))
+        uasserted(ErrorCodes::ConflictingOperationInProgress,
+                  str::stream() << "Gap exists in the routing table between chunks "
+                                << previous.getRange().toString() << " and "
+                                << next.getRange().toString());
+    else
+        uasserted(ErrorCodes::ConflictingOperationInProgress,
+                  str::stream() << "Overlap exists in the routing table between chunks "
+                                << previous.getRange().toString() << " and "
+                                << next.getRange().toString());
+}
+
 void appendChunkTo(std::vector<std::shared_ptr<ChunkInfo>>& chunks,
                    const std::shared_ptr<ChunkInfo>& chunk) {
     if (!chunks.empty() && chunk->getRange().overlaps(chunks.back()->getRange())) {
@@ -118,88 +190,49 @@ std::vector<std::shared_ptr<ChunkInfo>> flatten(const std::vector<ChunkType>& ch
 
 ShardVersionMap ChunkMap::constructShardVersionMap() const {
     ShardVersionMap shardVersions;
-    ChunkVector::const_iterator current = _chunkMap.cbegin();
-
-    boost::optional<BSONObj> firstMin = boost::none;
-    boost::optional<BSONObj> lastMax = boost::none;
-
-    while (current != _chunkMap.cend()) {
-        const auto& firstChunkInRange = *current;
-        const auto& currentRangeShardId = firstChunkInRange->getShardIdAt(boost::none);
-
-        // Tracks the max shard version for the shard on which the current range will reside
-        auto shardVersionIt = shardVersions.find(currentRangeShardId);
-        if (shardVersionIt == shardVersions.end()) {
-            shardVersionIt =
-                shardVersions.emplace(currentRangeShardId, _collectionVersion.epoch()).first;
-        }
 
-        auto& maxShardVersion = shardVersionIt->second.shardVersion;
-
-        current =
-            std::find_if(current,
-                         _chunkMap.cend(),
-                         [&currentRangeShardId, &maxShardVersion](const auto& currentChunk) {
-                             if (currentChunk->getShardIdAt(boost::none) != currentRangeShardId)
-                                 return true;
-
-                             if (currentChunk->getLastmod() > maxShardVersion)
-                                 maxShardVersion = currentChunk->getLastmod();
-
-                             return false;
-                         });
-
-        const auto rangeLast = *std::prev(current);
-
-        const auto& rangeMin = firstChunkInRange->getMin();
-        const auto& rangeMax = rangeLast->getMax();
-
-        // Check the continuity of the chunks map
-        if (lastMax && !SimpleBSONObjComparator::kInstance.evaluate(*lastMax == rangeMin)) {
-            if (SimpleBSONObjComparator::kInstance.evaluate(*lastMax < rangeMin))
-                uasserted(ErrorCodes::ConflictingOperationInProgress,
-                          str::stream() << "Gap exists in the routing table between chunks "
-                                        << findIntersectingChunk(*lastMax)->getRange().toString()
-                                        << " and " << rangeLast->getRange().toString());
-            else
-                uasserted(ErrorCodes::ConflictingOperationInProgress,
-                          str::stream() << "Overlap exists in the routing table between chunks "
-                                        << findIntersectingChunk(*lastMax)->getRange().toString()
-                                        << " and " << rangeLast->getRange().toString());
+    // The continuity of the chunks within each block was checked when the block was sealed, so
+    // only the boundaries between blocks need to be checked here.
+    const ChunkInfo* lastChunk = nullptr;
+    for (const auto& block : _blocks) {
+        const auto& firstChunk = *block->chunks.front();
+        if (lastChunk) {
+            checkContinuity(*lastChunk, firstChunk);
         }
+        lastChunk = block->chunks.back().get();
 
-        if (!firstMin)
-            firstMin = rangeMin;
-
-        lastMax = rangeMax;
+        for (const auto& [shardId, blockShardVersion] : block->shardVersions) {
+            auto shardVersionIt = shardVersions.find(shardId);
+            if (shardVersionIt == shardVersions.end()) {
+                shardVersionIt = shardVersions.emplace(shardId, _collectionVersion.epoch()).first;
+            }
 
-        // If a shard has chunks it must have a shard version, otherwise we have an invalid chunk
-        // somewhere, which should have been caught at chunk load time
-        invariant(maxShardVersion.isSet());
+            auto& maxShardVersion = shardVersionIt->second.shardVersion;
+            if (blockShardVersion > maxShardVersion)
+                maxShardVersion = blockShardVersion;
+        }
     }
 
-    if (!_chunkMap.empty()) {
+    if (!_blocks.empty()) {
         invariant(!shardVersions.empty());
-        invariant(firstMin.is_initialized());
-        invariant(lastMax.is_initialized());
 
-        checkAllElementsAreOfType(MinKey, firstMin.get());
-        checkAllElementsAreOfType(MaxKey, lastMax.get());
+        checkAllElementsAreOfType(MinKey, _blocks.front()->chunks.front()->getMin());
+        checkAllElementsAreOfType(MaxKey, _blocks.back()->chunks.back()->getMax());
     }
 
-    return shardVersions;
-}
-
-void ChunkMap::appendChunk(const std::shared_ptr<ChunkInfo>& chunk) {
-    appendChunkTo(_chunkMap, chunk);
+    // If a shard has chunks it must have a shard version, otherwise we have an invalid chunk
+    // somewhere, which should have been caught at chunk load time
+    for (const auto& [shardId, targetingInfo] : shardVersions) {
+        invariant(targetingInfo.shardVersion.isSet());
+    }
 
-    _collectionVersion = std::max(_collectionVersion, chunk->getLastmod());
+    return shardVersions;
 }
 
 std::shared_ptr<ChunkInfo> ChunkMap::findIntersectingChunk(const BSONObj& shardKey) const {
     const auto it = _findIntersectingChunk(shardKey);
 
-    if (it != _chunkMap.end())
+    if (it != _end())
         return *it;
 
     return std::shared_ptr<ChunkInfo>();
@@ -215,40 +248,69 @@ void validateChunk(const std::shared_ptr<ChunkInfo>& chunk, const ChunkVersion&
 }
 
 ChunkMap ChunkMap::createMerged(const std::vector<std::shared_ptr<ChunkInfo>>& changedChunks) {
-    size_t chunkMapIndex = 0;
+    invariant(_openBlock.empty());
+
+    // Position of the next chunk of this map to be considered.
+    size_t blockIndex = 0;
+    size_t chunkIndex = 0;
     size_t changedChunkIndex = 0;
 
-    ChunkMap updatedChunkMap(getVersion().epoch(), _chunkMap.size() + changedChunks.size());
+    const auto currentChunk = [&]() -> const std::shared_ptr<ChunkInfo>& {
+        return _blocks[blockIndex]->chunks[chunkIndex];
+    };
+    const auto advance = [&] {
+        if (++chunkIndex == _blocks[blockIndex]->chunks.size()) {
+            ++blockIndex;
+            chunkIndex = 0;
+        }
+    };
+
+    ChunkMap updatedChunkMap(getVersion().epoch());
 
-    while (chunkMapIndex < _chunkMap.size() || changedChunkIndex < changedChunks.size()) {
-        if (chunkMapIndex >= _chunkMap.size()) {
+    while (blockIndex < _blocks.size() || changedChunkIndex < changedChunks.size()) {
+        if (blockIndex >= _blocks.size()) {
             validateChunk(changedChunks[changedChunkIndex], getVersion());
-            updatedChunkMap.appendChunk(changedChunks[changedChunkIndex++]);
+            updatedChunkMap._appendChunk(changedChunks[changedChunkIndex++]);
             continue;
         }
 
+        // A whole block which ends before the next changed chunk starts is carried over as is.
+        if (chunkIndex == 0) {
+            const auto& block = _blocks[blockIndex];
+            if (changedChunkIndex >= changedChunks.size() ||
+                SimpleBSONObjComparator::kInstance.evaluate(
+                    changedChunks[changedChunkIndex]->getMin() >= block->chunks.back()->getMax())) {
+                updatedChunkMap._appendBlock(block, getVersion());
+                ++blockIndex;
+                continue;
+            }
+        }
+
         if (changedChunkIndex >= changedChunks.size()) {
-            updatedChunkMap.appendChunk(_chunkMap[chunkMapIndex++]);
+            updatedChunkMap._appendChunk(currentChunk());
+            advance();
             continue;
         }
 
-        auto overlap = _chunkMap[chunkMapIndex]->getRange().overlaps(
+        auto overlap = currentChunk()->getRange().overlaps(
             changedChunks[changedChunkIndex]->getRange());
 
         if (overlap) {
             auto& changedChunk = changedChunks[changedChunkIndex++];
-            auto& chunkInfo = _chunkMap[chunkMapIndex];
+            auto& chunkInfo = currentChunk();
 
             auto bytesInReplacedChunk = chunkInfo->getWritesTracker()->getBytesWritten();
             changedChunk->getWritesTracker()->addBytesWritten(bytesInReplacedChunk);
 
             validateChunk(changedChunk, getVersion());
-            updatedChunkMap.appendChunk(changedChunk);
+            updatedChunkMap._appendChunk(changedChunk);
         } else {
-            updatedChunkMap.appendChunk(_chunkMap[chunkMapIndex++]);
+            updatedChunkMap._appendChunk(currentChunk());
+            advance();
         }
     }
 
+    updatedChunkMap._sealOpenBlock();
     return updatedChunkMap;
 }
 
@@ -256,45 +318,139 @@ BSONObj ChunkMap::toBSON() const {
     BSONObjBuilder builder;
 
     builder.append("startingVersion"_sd, getVersion().toBSON());
-    builder.append("chunkCount", static_cast<int64_t>(_chunkMap.size()));
+    builder.append("chunkCount", static_cast<int64_t>(size()));
 
     {
         BSONArrayBuilder arrayBuilder(builder.subarrayStart("chunks"_sd));
-        for (const auto& chunk : _chunkMap) {
+        forEach([&](const auto& chunk) {
             arrayBuilder.append(chunk->toString());
-        }
+            return true;
+        });
     }
 
     return builder.obj();
 }
 
-ChunkMap::ChunkVector::const_iterator ChunkMap::_findIntersectingChunk(const BSONObj& shardKey,
-                                                                       bool isMaxInclusive) const {
+void ChunkMap::_appendChunk(const std::shared_ptr<ChunkInfo>& chunk) {
+    // Replacing the last chunk of a sealed block requires unsealing it first.
+    if (_openBlock.empty() && !_blocks.empty() &&
+        chunk->getRange().overlaps(_blocks.back()->chunks.back()->getRange())) {
+        _reopenLastBlock();
+    }
+
+    appendChunkTo(_openBlock, chunk);
+
+    _collectionVersion = std::max(_collectionVersion, chunk->getLastmod());
+
+    if (_openBlock.size() >= kMaxChunksPerBlock) {
+        _sealOpenBlock();
+    }
+}
+
+void ChunkMap::_appendBlock(const std::shared_ptr<const ChunkBlock>& block,
+                            const ChunkVersion& blockVersionBound) {
+    const ChunkInfo* lastChunk = nullptr;
+    if (!_openBlock.empty()) {
+        lastChunk = _openBlock.back().get();
+    } else if (!_blocks.empty()) {
+        lastChunk = _blocks.back()->chunks.back().get();
+    }
+    const bool overlapsLastChunk =
+        lastChunk && block->chunks.front()->getRange().overlaps(lastChunk->getRange());
+
+    // Merge the block into the chunks appended before it rather than sharing it when they fit in
+    // a single block, so that blocks do not get smaller with every refresh.
+    if (overlapsLastChunk ||
+        (!_openBlock.empty() && _openBlock.size() + block->chunks.size() <= kMaxChunksPerBlock)) {
+        for (const auto& chunk : block->chunks) {
+            _appendChunk(chunk);
+        }
+        return;
+    }
+
+    _sealOpenBlock();
+
+    _blocks.push_back(block);
+    _blockMaxKeyStringPrefixes.push_back(block->maxKeyStringPrefixes.back());
+    _size += block->chunks.size();
+
+    // The version of the map the block comes from bounds the versions of the chunks in it.
+    _collectionVersion = std::max(_collectionVersion, blockVersionBound);
+}
+
+void ChunkMap::_sealOpenBlock() {
+    if (_openBlock.empty()) {
+        return;
+    }
+
+    auto block = std::make_shared<ChunkBlock>();
+    block->chunks = std::move(_openBlock);
+    _openBlock.clear();
+
+    block->maxKeyStringPrefixes.reserve(block->chunks.size());
+    stdx::unordered_map<ShardId, ChunkVersion, ShardId::Hasher> shardVersions;
+    const ChunkInfo* previousChunk = nullptr;
+    for (const auto& chunk : block->chunks) {
+        if (previousChunk) {
+            checkContinuity(*previousChunk, *chunk);
+        }
+        previousChunk = chunk.get();
+
+        block->maxKeyStringPrefixes.push_back(keyStringPrefix(chunk->getMaxKeyString()));
+
+        auto [it, inserted] =
+            shardVersions.emplace(chunk->getShardIdAt(boost::none), chunk->getLastmod());
+        if (!inserted && chunk->getLastmod() > it->second) {
+            it->second = chunk->getLastmod();
+        }
+    }
+    block->shardVersions.assign(shardVersions.begin(), shardVersions.end());
+
+    _blockMaxKeyStringPrefixes.push_back(block->maxKeyStringPrefixes.back());
+    _size += block->chunks.size();
+    _blocks.push_back(std::move(block));
+}
+
+void ChunkMap::_reopenLastBlock() {
+    invariant(_openBlock.empty());
+
+    const auto& lastBlock = _blocks.back();
+    _openBlock = lastBlock->chunks;
+    _size -= lastBlock->chunks.size();
+
+    _blocks.pop_back();
+    _blockMaxKeyStringPrefixes.pop_back();
+}
+
+ChunkMap::ConstIterator ChunkMap::_findIntersectingChunk(const BSONObj& shardKey,
+                                                         bool isMaxInclusive) const {
     auto shardKeyString = ShardKeyPattern::toKeyString(shardKey);
 
-    if (!isMaxInclusive) {
-        return std::lower_bound(_chunkMap.begin(),
-                                _chunkMap.end(),
-                                shardKey,
-                                [&shardKeyString](const auto& chunkInfo, const BSONObj& shardKey) {
-                                    return chunkInfo->getMaxKeyString() < shardKeyString;
-                                });
-    } else {
-        return std::upper_bound(_chunkMap.begin(),
-                                _chunkMap.end(),
-                                shardKey,
-                                [&shardKeyString](const BSONObj& shardKey, const auto& chunkInfo) {
-                                    return shardKeyString < chunkInfo->getMaxKeyString();
-                                });
+    // Find the block holding the chunk, then the chunk within the block.
+    const auto blockIndex = findFirstMaxKeyStringAfter(
+        _blockMaxKeyStringPrefixes, shardKeyString, isMaxInclusive, [&](size_t i) -> const auto& {
+            return _blocks[i]->chunks.back()->getMaxKeyString();
+        });
+    if (blockIndex == _blocks.size()) {
+        return _end();
     }
+
+    const auto& block = *_blocks[blockIndex];
+    const auto chunkIndex = findFirstMaxKeyStringAfter(
+        block.maxKeyStringPrefixes, shardKeyString, isMaxInclusive, [&](size_t i) -> const auto& {
+            return block.chunks[i]->getMaxKeyString();
+        });
+    invariant(chunkIndex < block.chunks.size());
+
+    return ConstIterator(&_blocks, blockIndex, chunkIndex);
 }
 
-std::pair<ChunkMap::ChunkVector::const_iterator, ChunkMap::ChunkVector::const_iterator>
-ChunkMap::_overlappingBounds(const BSONObj& min, const BSONObj& max, bool isMaxInclusive) const {
+std::pair<ChunkMap::ConstIterator, ChunkMap::ConstIterator> ChunkMap::_overlappingBounds(
+    const BSONObj& min, const BSONObj& max, bool isMaxInclusive) const {
     const auto itMin = _findIntersectingChunk(min);
     const auto itMax = [&]() {
         auto it = _findIntersectingChunk(max, isMaxInclusive);
-        return it == _chunkMap.end() ? it : ++it;
+        return it == _end() ? it : ++it;
     }();
 
     return {itMin, itMax};
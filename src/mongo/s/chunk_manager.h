@@ -71,13 +71,64 @@ class ChunkMap {
     // Vector of chunks ordered by max key.
     using ChunkVector = std::vector<std::shared_ptr<ChunkInfo>>;
 
+    /**
+     * A contiguous run of chunks of the routing table. Blocks are never modified once built, so a
+     * ChunkMap produced by createMerged() shares with its predecessor every block which none of
+     * the changed chunks fall into, and only rebuilds the others.
+     */
+    struct ChunkBlock {
+        ChunkVector chunks;
+
+        // The first bytes of the max KeyString of each chunk, packed into integers that compare
+        // the same way as the KeyStrings they were taken from. Lookups binary search these
+        // contiguous arrays first and only compare full KeyStrings among chunks sharing the prefix
+        // of the key being looked up.
+        std::vector<uint64_t> maxKeyStringPrefixes;
+
+        // The max chunk version of each shard owning chunks in this block.
+        std::vector<std::pair<ShardId, ChunkVersion>> shardVersions;
+    };
+    using BlockVector = std::vector<std::shared_ptr<const ChunkBlock>>;
+
 public:
-    explicit ChunkMap(OID epoch, size_t initialCapacity = 0) : _collectionVersion(0, 0, epoch) {
-        _chunkMap.reserve(initialCapacity);
-    }
+    /**
+     * Forward iterator over the chunks of a ChunkMap, in ascending order of their max key.
+     */
+    class ConstIterator {
+    public:
+        ConstIterator(const BlockVector* blocks, size_t blockIndex, size_t chunkIndex)
+            : _blocks(blocks), _blockIndex(blockIndex), _chunkIndex(chunkIndex) {}
+
+        const std::shared_ptr<ChunkInfo>& operator*() const {
+            return (*_blocks)[_blockIndex]->chunks[_chunkIndex];
+        }
+
+        ConstIterator& operator++() {
+            if (++_chunkIndex == (*_blocks)[_blockIndex]->chunks.size()) {
+                ++_blockIndex;
+                _chunkIndex = 0;
+            }
+            return *this;
+        }
+
+        bool operator==(const ConstIterator& other) const {
+            return _blockIndex == other._blockIndex && _chunkIndex == other._chunkIndex;
+        }
+
+        bool operator!=(const ConstIterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        const BlockVector* _blocks;
+        size_t _blockIndex;
+        size_t _chunkIndex;
+    };
+
+    explicit ChunkMap(OID epoch) : _collectionVersion(0, 0, epoch) {}
 
     size_t size() const {
-        return _chunkMap.size();
+        return _size;
     }
 
     ChunkVersion getVersion() const {
@@ -86,9 +137,9 @@ public:
 
     template <typename Callable>
     void forEach(Callable&& handler, const BSONObj& shardKey = BSONObj()) const {
-        auto it = shardKey.isEmpty() ? _chunkMap.begin() : _findIntersectingChunk(shardKey);
+        auto it = shardKey.isEmpty() ? _begin() : _findIntersectingChunk(shardKey);
 
-        for (; it != _chunkMap.end(); ++it) {
+        for (; it != _end(); ++it) {
             if (!handler(*it))
                 break;
         }
@@ -110,18 +161,51 @@ public:
     ShardVersionMap constructShardVersionMap() const;
     std::shared_ptr<ChunkInfo> findIntersectingChunk(const BSONObj& shardKey) const;
 
-    void appendChunk(const std::shared_ptr<ChunkInfo>& chunk);
+    /**
+     * Returns a new ChunkMap with 'changedChunks' applied, which must be ordered by max key and not
+     * overlap each other. The cost is proportional to the number of changed chunks and the number
+     * of blocks, rather than to the number of chunks.
+     */
     ChunkMap createMerged(const std::vector<std::shared_ptr<ChunkInfo>>& changedChunks);
 
     BSONObj toBSON() const;
 
 private:
-    ChunkVector::const_iterator _findIntersectingChunk(const BSONObj& shardKey,
-                                                       bool isMaxInclusive = true) const;
-    std::pair<ChunkVector::const_iterator, ChunkVector::const_iterator> _overlappingBounds(
-        const BSONObj& min, const BSONObj& max, bool isMaxInclusive) const;
+    ConstIterator _begin() const {
+        return ConstIterator(&_blocks, 0, 0);
+    }
+
+    ConstIterator _end() const {
+        return ConstIterator(&_blocks, _blocks.size(), 0);
+    }
+
+    ConstIterator _findIntersectingChunk(const BSONObj& shardKey,
+                                         bool isMaxInclusive = true) const;
+    std::pair<ConstIterator, ConstIterator> _overlappingBounds(const BSONObj& min,
+                                                               const BSONObj& max,
+                                                               bool isMaxInclusive) const;
+
+    /**
+     * Methods used by createMerged() to build a new ChunkMap. Chunks are appended to '_openBlock',
+     * which is sealed into an immutable block once full, or once a block of the source ChunkMap is
+     * appended as a whole.
+     */
+    void _appendChunk(const std::shared_ptr<ChunkInfo>& chunk);
+    void _appendBlock(const std::shared_ptr<const ChunkBlock>& block,
+                      const ChunkVersion& blockVersionBound);
+    void _sealOpenBlock();
+    void _reopenLastBlock();
+
+    BlockVector _blocks;
+
+    // The packed prefix of the max KeyString of the last chunk of each block in '_blocks'.
+    std::vector<uint64_t> _blockMaxKeyStringPrefixes;
+
+    // Chunks appended but not yet sealed into a block. Always empty once a ChunkMap is built.
+    ChunkVector _openBlock;
 
-    ChunkVector _chunkMap;
+    // Number of chunks across all sealed blocks.
+    size_t _size = 0;
 
     // Max version across all chunks
     ChunkVersion _collectionVersion;
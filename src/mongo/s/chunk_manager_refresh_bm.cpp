@@ -378,6 +378,27 @@ MONGO_INITIALIZER(RegisterBenchmarks)(InitializerContext* context) {
             ->Args({2, 2});
     }
 
+    // Targeting on routing tables with a very large number of chunks, where the cost of a lookup is
+    // dominated by cache misses during the search.
+    std::initializer_list<benchmark::internal::Benchmark*> largeRoutingTableBmCases{
+        REGISTER_BENCHMARK_CAPTURE(BM_FindIntersectingChunk,
+                                   PessimalLargeRoutingTable,
+                                   makeChunkManagerWithPessimalBalancedDistribution),
+        REGISTER_BENCHMARK_CAPTURE(BM_FindIntersectingChunk,
+                                   OptimalLargeRoutingTable,
+                                   makeChunkManagerWithOptimalBalancedDistribution),
+        REGISTER_BENCHMARK_CAPTURE(BM_GetShardIdsForRange,
+                                   OptimalLargeRoutingTable,
+                                   makeChunkManagerWithOptimalBalancedDistribution),
+        REGISTER_BENCHMARK_CAPTURE(BM_KeyBelongsToMe,
+                                   OptimalLargeRoutingTable,
+                                   makeChunkManagerWithOptimalBalancedDistribution),
+    };
+
+    for (auto bmCase : largeRoutingTableBmCases) {
+        bmCase->Args({2, 250000})->Args({100, 500000})->Args({1000, 1000000});
+    }
+
     return Status::OK();
 }
 
@@ -132,6 +132,114 @@ TEST_F(ChunkMapTest, TestIntersectingChunk) {
                                                        BSON("a" << 100)));
 }
 
+TEST_F(ChunkMapTest, TestIntersectingChunkWithSharedKeyStringPrefixes) {
+    const OID epoch = OID::gen();
+    ChunkMap chunkMap{epoch};
+    ChunkVersion version{1, 0, epoch};
+
+    // Shard key values which only differ after a long common prefix, so their KeyStrings can only
+    // be told apart by full comparison.
+    const std::string prefix(32, 'x');
+    std::vector<BSONObj> bounds{getShardKeyPattern().globalMin()};
+    for (int i = 1; i < 10; ++i) {
+        bounds.push_back(BSON("a" << (prefix + std::to_string(i))));
+    }
+    bounds.push_back(getShardKeyPattern().globalMax());
+
+    std::vector<std::shared_ptr<ChunkInfo>> chunks;
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+        chunks.push_back(std::make_shared<ChunkInfo>(
+            ChunkType{kNss, ChunkRange{bounds[i], bounds[i + 1]}, version, kThisShard}));
+    }
+    auto newChunkMap = chunkMap.createMerged(chunks);
+
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+        // The min bound of a chunk belongs to that chunk.
+        auto intersectingChunk = newChunkMap.findIntersectingChunk(bounds[i]);
+        ASSERT(intersectingChunk);
+        ASSERT_BSONOBJ_EQ(bounds[i], intersectingChunk->getMin());
+    }
+
+    auto intersectingChunk = newChunkMap.findIntersectingChunk(BSON("a" << (prefix + "55")));
+    ASSERT(intersectingChunk);
+    ASSERT_BSONOBJ_EQ(BSON("a" << (prefix + "5")), intersectingChunk->getMin());
+    ASSERT_BSONOBJ_EQ(BSON("a" << (prefix + "6")), intersectingChunk->getMax());
+
+    int count = 0;
+    newChunkMap.forEachOverlappingChunk(
+        BSON("a" << (prefix + "3")), BSON("a" << (prefix + "5")), false, [&](const auto& chunk) {
+            count++;
+            return true;
+        });
+    ASSERT_EQ(count, 2);
+}
+
+TEST_F(ChunkMapTest, TestMergeIntoLargeChunkMap) {
+    const OID epoch = OID::gen();
+    const int nChunks = 5000;
+
+    auto boundAt = [&](int i) {
+        if (i == 0)
+            return getShardKeyPattern().globalMin();
+        if (i == nChunks)
+            return getShardKeyPattern().globalMax();
+        return BSON("a" << i * 10);
+    };
+
+    std::vector<std::shared_ptr<ChunkInfo>> chunks;
+    for (int i = 0; i < nChunks; ++i) {
+        chunks.push_back(std::make_shared<ChunkInfo>(
+            ChunkType{kNss,
+                      ChunkRange{boundAt(i), boundAt(i + 1)},
+                      ChunkVersion{static_cast<uint32_t>(i + 1), 0, epoch},
+                      ShardId(str::stream() << "shard" << (i % 4))}));
+    }
+    auto chunkMap = ChunkMap{epoch}.createMerged(chunks);
+    ASSERT_EQ(chunkMap.size(), nChunks);
+    ASSERT_EQ(chunkMap.constructShardVersionMap().size(), 4);
+
+    // Split two chunks far apart from each other.
+    auto version = chunkMap.getVersion();
+    std::vector<std::shared_ptr<ChunkInfo>> changedChunks;
+    for (int i : {10, 4000}) {
+        for (auto range : {ChunkRange{boundAt(i), BSON("a" << i * 10 + 5)},
+                           ChunkRange{BSON("a" << i * 10 + 5), boundAt(i + 1)}}) {
+            version.incMinor();
+            changedChunks.push_back(
+                std::make_shared<ChunkInfo>(ChunkType{kNss, range, version, kThisShard}));
+        }
+    }
+    auto updatedChunkMap = chunkMap.createMerged(changedChunks);
+
+    ASSERT_EQ(updatedChunkMap.size(), nChunks + 2);
+    ASSERT_EQ(updatedChunkMap.getVersion(), version);
+    ASSERT_EQ(updatedChunkMap.constructShardVersionMap().size(), 5);
+
+    // The chunks are contiguous and in order.
+    auto lastMax = getShardKeyPattern().globalMin();
+    updatedChunkMap.forEach([&](const auto& chunkInfo) {
+        ASSERT_BSONOBJ_EQ(lastMax, chunkInfo->getMin());
+        lastMax = chunkInfo->getMax();
+        return true;
+    });
+    ASSERT_BSONOBJ_EQ(getShardKeyPattern().globalMax(), lastMax);
+
+    auto intersectingChunk = updatedChunkMap.findIntersectingChunk(BSON("a" << 40007));
+    ASSERT(intersectingChunk);
+    ASSERT_EQ(kThisShard, intersectingChunk->getShardIdAt(boost::none));
+    ASSERT_BSONOBJ_EQ(BSON("a" << 40005), intersectingChunk->getMin());
+
+    intersectingChunk = updatedChunkMap.findIntersectingChunk(BSON("a" << 20000));
+    ASSERT(intersectingChunk);
+    ASSERT_BSONOBJ_EQ(BSON("a" << 20000), intersectingChunk->getMin());
+
+    // The original map is unaffected.
+    ASSERT_EQ(chunkMap.size(), nChunks);
+    intersectingChunk = chunkMap.findIntersectingChunk(BSON("a" << 40007));
+    ASSERT(intersectingChunk);
+    ASSERT_BSONOBJ_EQ(BSON("a" << 40000), intersectingChunk->getMin());
+}
+
 TEST_F(ChunkMapTest, TestEnumerateOverlappingChunks) {
     const OID epoch = OID::gen();
     ChunkMap chunkMap{epoch};
@@ -105,8 +105,8 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
       // since that is not supported we treat boost::none (unspecified) to mean 'kNormal'.
       _tailableMode(params.getTailableMode().value_or(TailableModeEnum::kNormal)),
       _params(std::move(params)),
-      _mergeQueue(MergingComparator(
-          _remotes, _params.getSort().value_or(BSONObj()), _params.getCompareWholeSortKey())),
+      _mergeTree(
+          _remotes, _params.getSort().value_or(BSONObj()), _params.getCompareWholeSortKey()),
       _promisedMinSortKeys(PromisedMinSortKeyComparator(_params.getSort().value_or(BSONObj()))) {
     if (params.getTxnNumber()) {
         invariant(params.getSessionId());
@@ -307,11 +307,11 @@ bool AsyncResultsMerger::_readySorted(WithLock lk) {
 }
 
 bool AsyncResultsMerger::_readySortedTailable(WithLock lk) {
-    if (_mergeQueue.empty()) {
+    if (_mergeTree.empty()) {
         return false;
     }
 
-    auto smallestRemote = _mergeQueue.top();
+    auto smallestRemote = _mergeTree.top();
     auto smallestResult = _remotes[smallestRemote].docBuffer.front();
     auto keyWeWantToReturn =
         extractSortKey(*smallestResult.getResult(), _params.getCompareWholeSortKey());
@@ -359,25 +359,24 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     // Tailable non-awaitData cursors cannot have a sort.
     invariant(_tailableMode != TailableModeEnum::kTailable);
 
-    if (_mergeQueue.empty()) {
+    if (_mergeTree.empty()) {
         return {};
     }
 
-    size_t smallestRemote = _mergeQueue.top();
-    _mergeQueue.pop();
+    size_t smallestRemote = _mergeTree.top();
 
     invariant(!_remotes[smallestRemote].docBuffer.empty());
     invariant(_remotes[smallestRemote].status.isOK());
 
     ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
     _remotes[smallestRemote].docBuffer.pop();
-
-    // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
-    // next result.
-    if (!_remotes[smallestRemote].docBuffer.empty()) {
-        _mergeQueue.push(smallestRemote);
+    if (_mergeTree.comparesEncodedSortKeys()) {
+        _remotes[smallestRemote].sortKeyBuffer.pop();
     }
 
+    // Replay the tree with the next result from 'smallestRemote', if it has a next result.
+    _mergeTree.replayTop();
+
     // For sorted tailable awaitData cursors, update the high water mark to the document's sort key.
     if (_tailableMode == TailableModeEnum::kTailableAndAwaitData) {
         if (_remotes[smallestRemote].eligibleForHighWaterMark) {
@@ -708,6 +707,9 @@ void AsyncResultsMerger::_cleanUpFailedBatch(WithLock lk, Status status, size_t
         remote.partialResultsReturned = (remote.status != ErrorCodes::ExchangePassthrough);
         std::queue<ClusterQueryResult> emptyBuffer;
         std::swap(remote.docBuffer, emptyBuffer);
+        std::queue<KeyString::Value> emptySortKeyBuffer;
+        std::swap(remote.sortKeyBuffer, emptySortKeyBuffer);
+        _mergeTree.invalidate();
         remote.status = Status::OK();
         remote.cursorId = 0;
     }
@@ -782,15 +784,19 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
             }
         }
 
+        if (_params.getSort() && _mergeTree.comparesEncodedSortKeys()) {
+            remote.sortKeyBuffer.push(_mergeTree.encodeSortKey(obj));
+        }
+
         ClusterQueryResult result(obj);
         remote.docBuffer.push(result);
         ++remote.fetchedCount;
     }
 
-    // If we're doing a sorted merge, then we have to make sure to put this remote onto the merge
-    // queue.
+    // If we're doing a sorted merge, then we have to make sure that this remote's results take part
+    // in the merge.
     if (_params.getSort() && !response.getBatch().empty()) {
-        _mergeQueue.push(remoteIndex);
+        _mergeTree.invalidate();
     }
     return true;
 }
@@ -904,16 +910,98 @@ bool AsyncResultsMerger::RemoteCursorData::exhausted() const {
 }
 
 //
-// AsyncResultsMerger::MergingComparator
+// AsyncResultsMerger::MergeTree
 //
 
-bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
-    const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
-    const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
+AsyncResultsMerger::MergeTree::MergeTree(const std::vector<RemoteCursorData>& remotes,
+                                         const BSONObj& sort,
+                                         bool compareWholeSortKey)
+    : _remotes(remotes), _sort(sort), _compareWholeSortKey(compareWholeSortKey) {
+    if (!_sort.isEmpty() &&
+        static_cast<size_t>(_sort.nFields()) <= Ordering::kMaxCompoundIndexKeys) {
+        _ordering = Ordering::make(_sort);
+    }
+}
+
+KeyString::Value AsyncResultsMerger::MergeTree::encodeSortKey(const BSONObj& obj) const {
+    invariant(_ordering);
+    return KeyString::Builder(KeyString::Version::kLatestVersion,
+                              extractSortKey(obj, _compareWholeSortKey),
+                              *_ordering)
+        .getValueCopy();
+}
+
+bool AsyncResultsMerger::MergeTree::empty() {
+    return _remotes.empty() || _remotes[top()].docBuffer.empty();
+}
+
+size_t AsyncResultsMerger::MergeTree::top() {
+    if (_needsRebuild || _losers.size() != _remotes.size()) {
+        _rebuild();
+    }
+    invariant(!_losers.empty());
+    return _losers[0];
+}
+
+void AsyncResultsMerger::MergeTree::replayTop() {
+    if (_needsRebuild || _losers.size() != _remotes.size()) {
+        _rebuild();
+        return;
+    }
+
+    // The previous winner won every match on the path from its leaf to the root, so the losers
+    // stored along that path are the only candidates to replace it.
+    const size_t numLeaves = _losers.size();
+    size_t winner = _losers[0];
+    for (size_t node = (numLeaves + winner) / 2; node > 0; node /= 2) {
+        if (_beats(_losers[node], winner)) {
+            std::swap(_losers[node], winner);
+        }
+    }
+    _losers[0] = winner;
+}
+
+bool AsyncResultsMerger::MergeTree::_beats(size_t lhs, size_t rhs) const {
+    const bool lhsHasNext = _remotes[lhs].hasNext();
+    const bool rhsHasNext = _remotes[rhs].hasNext();
+    if (!lhsHasNext || !rhsHasNext) {
+        return lhsHasNext || (!rhsHasNext && lhs < rhs);
+    }
 
-    return compareSortKeys(extractSortKey(*leftDoc.getResult(), _compareWholeSortKey),
-                           extractSortKey(*rightDoc.getResult(), _compareWholeSortKey),
-                           _sort) > 0;
+    int cmp;
+    if (_ordering) {
+        cmp = _remotes[lhs].sortKeyBuffer.front().compare(_remotes[rhs].sortKeyBuffer.front());
+    } else {
+        cmp = compareSortKeys(
+            extractSortKey(*_remotes[lhs].docBuffer.front().getResult(), _compareWholeSortKey),
+            extractSortKey(*_remotes[rhs].docBuffer.front().getResult(), _compareWholeSortKey),
+            _sort);
+    }
+    return cmp < 0 || (cmp == 0 && lhs < rhs);
+}
+
+void AsyncResultsMerger::MergeTree::_rebuild() {
+    const size_t numLeaves = _remotes.size();
+    _losers.assign(numLeaves, 0);
+    _needsRebuild = false;
+    if (numLeaves == 0) {
+        return;
+    }
+
+    // Play the tournament bottom-up, recording the winner of each node in 'winners' and the loser
+    // in '_losers'. Nodes [numLeaves, 2 * numLeaves) are the leaves.
+    std::vector<size_t> winners(2 * numLeaves);
+    for (size_t remoteIndex = 0; remoteIndex < numLeaves; ++remoteIndex) {
+        winners[numLeaves + remoteIndex] = remoteIndex;
+    }
+    for (size_t node = numLeaves - 1; node > 0; --node) {
+        const size_t left = winners[2 * node];
+        const size_t right = winners[2 * node + 1];
+        const bool leftWins = _beats(left, right);
+        winners[node] = leftWins ? left : right;
+        _losers[node] = leftWins ? right : left;
+    }
+    _losers[0] = winners[1];
 }
 
 bool AsyncResultsMerger::PromisedMinSortKeyComparator::operator()(
@@ -35,7 +35,9 @@
 
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
 #include "mongo/db/cursor_id.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/platform/mutex.h"
 #include "mongo/s/query/async_results_merger_params_gen.h"
@@ -89,7 +91,7 @@ public:
      *
      * Additionally copies each remote's first batch of results, if one exists, into that remote's
      * docBuffer. If a sort is specified in the ClusterClientCursorParams, places the remotes with
-     * buffered results onto _mergeQueue.
+     * buffered results onto _mergeTree.
      *
      * The TaskExecutor* must remain valid for the lifetime of the ARM.
      *
@@ -308,6 +310,10 @@ private:
         // The buffer of results that have been retrieved but not yet returned to the caller.
         std::queue<ClusterQueryResult> docBuffer;
 
+        // The KeyString encodings of the sort keys of the results in 'docBuffer', in the same
+        // order. Populated only if there is a sort and the merge tree compares encoded sort keys.
+        std::queue<KeyString::Value> sortKeyBuffer;
+
         // Is valid if there is currently a pending request to this remote.
         executor::TaskExecutor::CallbackHandle cbHandle;
 
@@ -320,16 +326,69 @@ private:
         long long fetchedCount = 0;
     };
 
-    class MergingComparator {
+    /**
+     * A loser tree over the indices of '_remotes' which selects the remote whose front buffered
+     * result sorts first. Remotes with an empty buffer lose every match. After the winner's front
+     * result is consumed, only the path from its leaf to the root is replayed, which costs one sort
+     * key comparison per level. Any other change to the fronts of the buffers must be followed by
+     * a call to invalidate(), and the tree is then rebuilt the next time the winner is requested.
+     *
+     * When the sort pattern fits in an Ordering, sort keys are encoded to KeyStrings once as each
+     * batch is buffered, so that every comparison is a memcmp rather than a BSON traversal.
+     */
+    class MergeTree {
     public:
-        MergingComparator(const std::vector<RemoteCursorData>& remotes,
-                          const BSONObj& sort,
-                          bool compareWholeSortKey)
-            : _remotes(remotes), _sort(sort), _compareWholeSortKey(compareWholeSortKey) {}
+        MergeTree(const std::vector<RemoteCursorData>& remotes,
+                  const BSONObj& sort,
+                  bool compareWholeSortKey);
+
+        /**
+         * Returns true if the remotes should buffer a KeyString alongside each result, as produced
+         * by encodeSortKey().
+         */
+        bool comparesEncodedSortKeys() const {
+            return _ordering.has_value();
+        }
+
+        /**
+         * Returns the KeyString encoding of the sort key of 'obj', which must contain a valid
+         * $sortKey. Only legal if comparesEncodedSortKeys() is true.
+         */
+        KeyString::Value encodeSortKey(const BSONObj& obj) const;
+
+        /**
+         * Returns true if none of the remotes has a buffered result.
+         */
+        bool empty();
+
+        /**
+         * Returns the index of the remote whose front buffered result sorts first. Only legal if
+         * empty() is false.
+         */
+        size_t top();
 
-        bool operator()(const size_t& lhs, const size_t& rhs);
+        /**
+         * Restores the tree after the front result of the remote returned by top() was popped.
+         */
+        void replayTop();
+
+        /**
+         * Signals that the front result of some remote other than the winner has changed, e.g.
+         * because a batch arrived for a remote whose buffer was empty.
+         */
+        void invalidate() {
+            _needsRebuild = true;
+        }
 
     private:
+        /**
+         * Returns true if the front result of remote 'lhs' should be returned before that of remote
+         * 'rhs'. Ties are broken on the remote index so that the order is strict.
+         */
+        bool _beats(size_t lhs, size_t rhs) const;
+
+        void _rebuild();
+
         const std::vector<RemoteCursorData>& _remotes;
 
         const BSONObj _sort;
@@ -338,6 +397,17 @@ private:
         // We extract the sort key {$sortKey: <value>}. The sort key pattern '_sort' is verified to
         // be {$sortKey: 1}.
         const bool _compareWholeSortKey;
+
+        // The ordering used to encode sort keys. Not set if the sort pattern has more fields than
+        // an Ordering can describe, in which case the sort keys are compared as BSON.
+        boost::optional<Ordering> _ordering;
+
+        // Element 0 holds the index of the overall winner. Element i for i > 0 holds the loser of
+        // the match played at internal node i, whose children are nodes 2i and 2i + 1. The leaf
+        // for remote r is node _remotes.size() + r.
+        std::vector<size_t> _losers;
+
+        bool _needsRebuild = true;
     };
 
     using MinSortKeyRemoteIdPair = std::pair<BSONObj, size_t>;
@@ -486,9 +556,9 @@ private:
     // Data tracking the state of our communication with each of the remote nodes.
     std::vector<RemoteCursorData> _remotes;
 
-    // The top of this priority queue is the index into '_remotes' for the remote host that has the
-    // next document to return, according to the sort order. Used only if there is a sort.
-    std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
+    // The winner of this tree is the index into '_remotes' for the remote host that has the next
+    // document to return, according to the sort order. Used only if there is a sort.
+    MergeTree _mergeTree;
 
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
@@ -441,6 +441,97 @@ TEST_F(AsyncResultsMergerTest, CompoundSortKey) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, CompoundSortKeyWithMixedTypesFromFirstBatches) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: 1, b: -1}}");
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[0],
+        kTestShardHosts[0],
+        CursorResponse(kTestNss,
+                       0,
+                       {fromjson("{$sortKey: [1, 'z']}"),
+                        fromjson("{$sortKey: [2.5, 3]}"),
+                        fromjson("{$sortKey: ['x', 1]}")})));
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[1],
+        kTestShardHosts[1],
+        CursorResponse(kTestNss,
+                       0,
+                       {fromjson("{$sortKey: [null, 0]}"),
+                        fromjson("{$sortKey: [1.0, 'a']}"),
+                        fromjson("{$sortKey: [2.5, 4]}")})));
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[2],
+        kTestShardHosts[2],
+        CursorResponse(kTestNss,
+                       0,
+                       {fromjson("{$sortKey: [1, 7]}"),
+                        fromjson("{$sortKey: [{$numberLong: '2'}, 0]}"),
+                        fromjson("{$sortKey: ['x', 2]}")})));
+    auto arm = makeARMFromExistingCursors(std::move(cursors), findCmd);
+
+    // Every remote supplied a first batch and is exhausted, so the ARM merges without waiting on
+    // the network. Numbers of different types compare by value, and strings sort after numbers.
+    std::vector<BSONObj> expected = {fromjson("{$sortKey: [null, 0]}"),
+                                     fromjson("{$sortKey: [1, 'z']}"),
+                                     fromjson("{$sortKey: [1.0, 'a']}"),
+                                     fromjson("{$sortKey: [1, 7]}"),
+                                     fromjson("{$sortKey: [{$numberLong: '2'}, 0]}"),
+                                     fromjson("{$sortKey: [2.5, 4]}"),
+                                     fromjson("{$sortKey: [2.5, 3]}"),
+                                     fromjson("{$sortKey: ['x', 2]}"),
+                                     fromjson("{$sortKey: ['x', 1]}")};
+    for (const auto& expectedObj : expected) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(expectedObj, *unittest::assertGet(arm->nextReady()).getResult());
+    }
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, SortPatternTooLongForOrderingComparesBSONSortKeys) {
+    // Build a sort pattern with more fields than an Ordering can describe. Only the first and last
+    // fields differ between the results, and the last one is descending.
+    BSONObjBuilder sortBuilder;
+    const size_t numFields = Ordering::kMaxCompoundIndexKeys + 1;
+    for (size_t i = 0; i < numFields; ++i) {
+        sortBuilder.append(str::stream() << "f" << i, i + 1 == numFields ? -1 : 1);
+    }
+    BSONObj findCmd = BSON("find"
+                           << "testcoll"
+                           << "sort" << sortBuilder.obj());
+
+    auto makeResult = [&](int first, int last) {
+        BSONArrayBuilder sortKey;
+        sortKey.append(first);
+        for (size_t i = 2; i < numFields; ++i) {
+            sortKey.append(0);
+        }
+        sortKey.append(last);
+        return BSON(AsyncResultsMerger::kSortKeyField << sortKey.arr());
+    };
+
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[0],
+        kTestShardHosts[0],
+        CursorResponse(kTestNss, 0, {makeResult(1, 1), makeResult(2, 5)})));
+    cursors.push_back(makeRemoteCursor(
+        kTestShardIds[1],
+        kTestShardHosts[1],
+        CursorResponse(kTestNss, 0, {makeResult(1, 3), makeResult(2, 4)})));
+    auto arm = makeARMFromExistingCursors(std::move(cursors), findCmd);
+
+    std::vector<BSONObj> expected = {
+        makeResult(1, 3), makeResult(1, 1), makeResult(2, 5), makeResult(2, 4)};
+    for (const auto& expectedObj : expected) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(expectedObj, *unittest::assertGet(arm->nextReady()).getResult());
+    }
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, SortedButNoSortKey) {
     BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: -1, b: 1}}");
     std::vector<RemoteCursor> cursors;
@@ -193,7 +193,8 @@ Status initializeGlobalShardingState(OperationContext* opCtx,
                                      boost::optional<size_t> taskExecutorPoolSize) {
     ConnectionPool::Options connPoolOptions;
     connPoolOptions.controllerFactory = []() noexcept {
-        return std::make_shared<ShardingTaskExecutorPoolController>();
+        return std::make_shared<ShardingTaskExecutorPoolController>(
+            getGlobalServiceContext()->getFastClockSource());
     };
 
     auto network = executor::makeNetworkInterface(
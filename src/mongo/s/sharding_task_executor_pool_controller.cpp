@@ -31,6 +31,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <cmath>
+
 #include "mongo/client/replica_set_monitor.h"
 #include "mongo/s/sharding_task_executor_pool_controller.h"
 
@@ -38,6 +40,10 @@ namespace mongo {
 
 namespace {
 
+// The time over which the weight of a demand sample in a pool's moving average of demand decays
+// by a factor of e
+constexpr Milliseconds kDemandTimeConstant = Seconds(5);
+
 template <typename Map, typename Key>
 auto& getOrInvariant(Map&& map, const Key& key) noexcept {
     auto it = std::forward<Map>(map).find(key);
@@ -97,9 +103,11 @@ Status ShardingTaskExecutorPoolController::onUpdateMatchingStrategy(const std::s
 }
 
 void ShardingTaskExecutorPoolController::_addGroup(WithLock,
-                                                   const ReplicaSetChangeNotifier::State& state) {
+                                                   const ReplicaSetChangeNotifier::State& state,
+                                                   size_t target) {
     auto groupData = std::make_shared<GroupData>();
     groupData->primary = state.primary;
+    groupData->target = target;
 
     // Find each active member
     for (auto& host : state.connStr.getServers()) {
@@ -127,13 +135,14 @@ void ShardingTaskExecutorPoolController::_addGroup(WithLock,
     emplaceOrInvariant(_groupDatas, state.connStr.getSetName(), std::move(groupData));
 }
 
-void ShardingTaskExecutorPoolController::_removeGroup(WithLock, const std::string& name) {
+size_t ShardingTaskExecutorPoolController::_removeGroup(WithLock, const std::string& name) {
     auto it = _groupDatas.find(name);
     if (it == _groupDatas.end()) {
-        return;
+        return 0;
     }
 
     auto& groupData = it->second;
+    auto target = groupData->target;
     for (auto& host : groupData->members) {
         auto& groupAndId = getOrInvariant(_groupAndIds, host);
         groupAndId.groupData.reset();
@@ -146,6 +155,7 @@ void ShardingTaskExecutorPoolController::_removeGroup(WithLock, const std::strin
     }
 
     _groupDatas.erase(it);
+    return target;
 }
 
 class ShardingTaskExecutorPoolController::ReplicaSetChangeListener final
@@ -161,8 +171,14 @@ public:
     void onConfirmedSet(const State& state) noexcept override {
         stdx::lock_guard lk(_controller->_mutex);
 
-        _controller->_removeGroup(lk, state.connStr.getSetName());
-        _controller->_addGroup(lk, state);
+        auto target = _controller->_removeGroup(lk, state.connStr.getSetName());
+        if (gParameters.predictiveHeadroomPercent.load() == 0) {
+            target = 0;
+        }
+
+        // With predictive scaling, keep the previous target so that the pools of the members which
+        // remain in the set do not drop their connections until they next update.
+        _controller->_addGroup(lk, state, target);
     }
 
     void onPossibleSet(const State& state) noexcept override {
@@ -216,7 +232,31 @@ auto ShardingTaskExecutorPoolController::updateHost(PoolId id, const HostState&
     const size_t maxConns = gParameters.maxConnections.load();
 
     // Update the target for just the pool first
-    poolData.target = stats.requests + stats.active;
+    const size_t demand = stats.requests + stats.active;
+    poolData.target = demand;
+
+    if (auto headroomPercent = gParameters.predictiveHeadroomPercent.load(); headroomPercent > 0) {
+        const auto now = _clockSource->now();
+        if (poolData.lastDemandUpdate) {
+            // The demand of the last update held until now, so it carries a weight which depends
+            // on the time elapsed since then rather than on how often the pool updates.
+            const auto elapsed = std::max(now - *poolData.lastDemandUpdate, Milliseconds(0));
+            const auto weight = 1 -
+                std::exp(-static_cast<double>(durationCount<Milliseconds>(elapsed)) /
+                         durationCount<Milliseconds>(kDemandTimeConstant));
+            poolData.averageDemand += weight * (poolData.lastDemand - poolData.averageDemand);
+        } else {
+            poolData.averageDemand = demand;
+        }
+        poolData.lastDemand = demand;
+        poolData.lastDemandUpdate = now;
+
+        auto predicted = std::ceil(poolData.averageDemand * (100 + headroomPercent) / 100);
+        poolData.target = std::max(demand, static_cast<size_t>(predicted));
+    } else {
+        poolData.averageDemand = demand;
+        poolData.lastDemandUpdate = boost::none;
+    }
 
     if (poolData.target < minConns) {
         poolData.target = minConns;
@@ -37,6 +37,7 @@
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/mutex.h"
 #include "mongo/stdx/unordered_map.h"
+#include "mongo/util/clock_source.h"
 
 namespace mongo {
 
@@ -59,6 +60,15 @@ namespace mongo {
  * When the MatchingStrategy is kMatchBusiestNode, it operates like kMatchPrimaryNode, but any pool
  * can be responsible for increasing the targetConnections of each member of its set.
  *
+ * Independently of the MatchingStrategy, a non-zero predictiveHeadroomPercent makes each pool keep
+ * an exponentially weighted moving average of its demand (requests plus connections in use) over
+ * time. The pool then targets that average plus the given percentage of headroom, so that ready
+ * connections are already established when a burst arrives instead of being opened inline with the
+ * requests. The group target follows from the pool targets as usual. It is carried over when a
+ * replica set's membership changes, so that the pools of the remaining members keep their
+ * connections. A pool for a new member is only created by its first request, and picks up the
+ * group target from then on.
+ *
  * Note that, in essence, there are three outside elements that can mutate the state of this class:
  * * The ReplicaSetChangeNotifier can notify the listener which updates the host groups
  * * The ServerParameters can update the Parameters which will used in the next update
@@ -87,6 +97,8 @@ public:
         AtomicWord<int> pendingTimeoutMS;
         AtomicWord<int> toRefreshTimeoutMS;
 
+        AtomicWord<int> predictiveHeadroomPercent;
+
         synchronized_value<std::string> matchingStrategyString;
         AtomicWord<MatchingStrategy> matchingStrategy;
     };
@@ -110,7 +122,11 @@ public:
      */
     static Status onUpdateMatchingStrategy(const std::string& str);
 
-    ShardingTaskExecutorPoolController() = default;
+    /**
+     * The 'clockSource' times the demand samples of predictive scaling.
+     */
+    explicit ShardingTaskExecutorPoolController(ClockSource* clockSource)
+        : _clockSource(clockSource) {}
     ShardingTaskExecutorPoolController& operator=(ShardingTaskExecutorPoolController&&) = delete;
 
     void init(ConnectionPool* parent) override;
@@ -130,8 +146,13 @@ public:
     }
 
 private:
-    void _addGroup(WithLock, const ReplicaSetChangeNotifier::State& state);
-    void _removeGroup(WithLock, const std::string& key);
+    void _addGroup(WithLock, const ReplicaSetChangeNotifier::State& state, size_t target);
+
+    /**
+     * Removes the GroupData for the given replica set and returns the target it had, or zero if
+     * there was no such group.
+     */
+    size_t _removeGroup(WithLock, const std::string& key);
 
     /**
      * GroupData is a shared state for a set of hosts (a replica set).
@@ -177,6 +198,14 @@ private:
         // The number of connections the host should maintain
         size_t target = 0;
 
+        // The moving average over time of requests plus active connections, only maintained
+        // while predictiveHeadroomPercent is set
+        double averageDemand = 0.0;
+
+        // The demand at the last update of averageDemand, and the time of that update
+        size_t lastDemand = 0;
+        boost::optional<Date_t> lastDemandUpdate;
+
         // This host is able to shutdown
         bool isAbleToShutdown = false;
     };
@@ -195,6 +224,8 @@ private:
 
     std::shared_ptr<ReplicaSetChangeNotifier::Listener> _listener;
 
+    ClockSource* const _clockSource;
+
     Mutex _mutex = MONGO_MAKE_LATCH("ShardingTaskExecutorPoolController::_mutex");
 
     // Entires to _poolDatas are added by addHost() and removed by removeHost()
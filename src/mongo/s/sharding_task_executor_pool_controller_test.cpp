@@ -0,0 +1,131 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/sharding_task_executor_pool_controller.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/clock_source_mock.h"
+
+namespace mongo {
+namespace {
+
+using Controller = ShardingTaskExecutorPoolController;
+
+const HostAndPort kHost("a", 27017);
+const Controller::PoolId kPoolId = 1;
+
+class ShardingTaskExecutorPoolControllerTest : public unittest::Test {
+protected:
+    void setUp() override {
+        auto& parameters = Controller::gParameters;
+        _originalMinConnections = parameters.minConnections.load();
+        _originalMaxConnections = parameters.maxConnections.load();
+        _originalHeadroomPercent = parameters.predictiveHeadroomPercent.load();
+        parameters.minConnections.store(1);
+        parameters.maxConnections.store(1000);
+    }
+
+    void tearDown() override {
+        auto& parameters = Controller::gParameters;
+        parameters.minConnections.store(_originalMinConnections);
+        parameters.maxConnections.store(_originalMaxConnections);
+        parameters.predictiveHeadroomPercent.store(_originalHeadroomPercent);
+    }
+
+    static size_t updateDemand(Controller* controller, size_t active) {
+        Controller::HostState state;
+        state.active = active;
+        controller->updateHost(kPoolId, state);
+        return controller->getControls(kPoolId).targetConnections;
+    }
+
+private:
+    int _originalMinConnections;
+    int _originalMaxConnections;
+    int _originalHeadroomPercent;
+};
+
+TEST_F(ShardingTaskExecutorPoolControllerTest, TargetsCurrentDemandWithoutHeadroom) {
+    Controller::gParameters.predictiveHeadroomPercent.store(0);
+    ClockSourceMock clock;
+    Controller controller(&clock);
+    controller.addHost(kPoolId, kHost);
+
+    ASSERT_EQ(10U, updateDemand(&controller, 10));
+    clock.advance(Milliseconds(10));
+    ASSERT_EQ(1U, updateDemand(&controller, 0));
+}
+
+TEST_F(ShardingTaskExecutorPoolControllerTest, KeepsHeadroomOverRecentDemand) {
+    Controller::gParameters.predictiveHeadroomPercent.store(50);
+    ClockSourceMock clock;
+    Controller controller(&clock);
+    controller.addHost(kPoolId, kHost);
+
+    ASSERT_EQ(15U, updateDemand(&controller, 10));
+
+    // The demand held at 10 until now, so the average has not moved.
+    clock.advance(Seconds(1));
+    ASSERT_EQ(15U, updateDemand(&controller, 0));
+
+    // Once the demand has been gone for long enough, the pool shrinks to its minimum.
+    clock.advance(Minutes(1));
+    ASSERT_EQ(1U, updateDemand(&controller, 0));
+}
+
+TEST_F(ShardingTaskExecutorPoolControllerTest, AverageDoesNotDependOnUpdateFrequency) {
+    Controller::gParameters.predictiveHeadroomPercent.store(50);
+
+    ClockSourceMock frequentClock;
+    Controller frequentController(&frequentClock);
+    frequentController.addHost(kPoolId, kHost);
+    updateDemand(&frequentController, 10);
+    updateDemand(&frequentController, 0);
+    for (int i = 0; i < 100; ++i) {
+        frequentClock.advance(Milliseconds(10));
+        updateDemand(&frequentController, 0);
+    }
+
+    ClockSourceMock rareClock;
+    Controller rareController(&rareClock);
+    rareController.addHost(kPoolId, kHost);
+    updateDemand(&rareController, 10);
+    updateDemand(&rareController, 0);
+    rareClock.advance(Seconds(1));
+    updateDemand(&rareController, 0);
+
+    // After a second without demand, the average has decayed from 10 to 10 * e^-0.2 = 8.19 for
+    // both, and the target is 150% of that.
+    ASSERT_EQ(13U, frequentController.getControls(kPoolId).targetConnections);
+    ASSERT_EQ(13U, rareController.getControls(kPoolId).targetConnections);
+}
+
+}  // namespace
+}  // namespace mongo
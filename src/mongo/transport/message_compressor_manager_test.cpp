@@ -252,6 +252,28 @@ TEST(ZstdMessageCompressor, Overflow) {
     checkOverflow(std::make_unique<ZstdMessageCompressor>());
 }
 
+TEST(ZstdMessageCompressor, ReusedContextAfterFailure) {
+    // The zstd contexts are kept per thread across calls and compressor instances, so a failed
+    // operation must not poison the messages that follow it on the same thread.
+    checkOverflow(std::make_unique<ZstdMessageCompressor>());
+
+    auto compressor = std::make_unique<ZstdMessageCompressor>();
+    for (int i = 1; i <= 3; ++i) {
+        const std::string data(1024 * i, static_cast<char>('a' + i));
+        std::vector<char> compressed(compressor->getMaxCompressedSize(data.size()));
+        auto sws = compressor->compressData(ConstDataRange(data.data(), data.size()),
+                                            DataRange(compressed.data(), compressed.size()));
+        ASSERT_OK(sws);
+
+        std::string decompressed(data.size(), '\0');
+        sws = compressor->decompressData(ConstDataRange(compressed.data(), sws.getValue()),
+                                         DataRange(&decompressed[0], decompressed.size()));
+        ASSERT_OK(sws);
+        ASSERT_EQ(sws.getValue(), data.size());
+        ASSERT_EQ(decompressed, data);
+    }
+}
+
 TEST(MessageCompressorManager, SERVER_28008) {
 
     // Create a client and server that will negotiate the same compressors,
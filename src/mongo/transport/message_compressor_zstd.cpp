@@ -36,8 +36,49 @@
 #include "mongo/base/init.h"
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/message_compressor_zstd.h"
+#include "mongo/util/assert_util.h"
 
 namespace mongo {
+namespace {
+
+struct CCtxDeleter {
+    void operator()(ZSTD_CCtx* cctx) const {
+        ZSTD_freeCCtx(cctx);
+    }
+};
+
+struct DCtxDeleter {
+    void operator()(ZSTD_DCtx* dctx) const {
+        ZSTD_freeDCtx(dctx);
+    }
+};
+
+/**
+ * The compressor is a process-wide singleton shared by every session, but each session is only
+ * ever serviced by one thread at a time. Keeping the zstd contexts thread local lets consecutive
+ * messages on a connection reuse the same working buffers and match tables instead of allocating
+ * and initializing a fresh context for every message.
+ */
+thread_local std::unique_ptr<ZSTD_CCtx, CCtxDeleter> compressionContext;
+thread_local std::unique_ptr<ZSTD_DCtx, DCtxDeleter> decompressionContext;
+
+ZSTD_CCtx* getCompressionContext() {
+    if (!compressionContext) {
+        compressionContext.reset(ZSTD_createCCtx());
+        invariant(compressionContext);
+    }
+    return compressionContext.get();
+}
+
+ZSTD_DCtx* getDecompressionContext() {
+    if (!decompressionContext) {
+        decompressionContext.reset(ZSTD_createDCtx());
+        invariant(decompressionContext);
+    }
+    return decompressionContext.get();
+}
+
+}  // namespace
 
 ZstdMessageCompressor::ZstdMessageCompressor() : MessageCompressorBase(MessageCompressor::kZstd) {}
 
@@ -47,11 +88,12 @@ std::size_t ZstdMessageCompressor::getMaxCompressedSize(size_t inputSize) {
 
 StatusWith<std::size_t> ZstdMessageCompressor::compressData(ConstDataRange input,
                                                             DataRange output) {
-    size_t ret = ZSTD_compress(const_cast<char*>(output.data()),
-                               output.length(),
-                               input.data(),
-                               input.length(),
-                               ZSTD_CLEVEL_DEFAULT);
+    size_t ret = ZSTD_compressCCtx(getCompressionContext(),
+                                   const_cast<char*>(output.data()),
+                                   output.length(),
+                                   input.data(),
+                                   input.length(),
+                                   ZSTD_CLEVEL_DEFAULT);
 
     if (ZSTD_isError(ret)) {
         return Status{ErrorCodes::BadValue,
@@ -63,8 +105,11 @@ StatusWith<std::size_t> ZstdMessageCompressor::compressData(ConstDataRange input
 
 StatusWith<std::size_t> ZstdMessageCompressor::decompressData(ConstDataRange input,
                                                               DataRange output) {
-    size_t ret = ZSTD_decompress(
-        const_cast<char*>(output.data()), output.length(), input.data(), input.length());
+    size_t ret = ZSTD_decompressDCtx(getDecompressionContext(),
+                                     const_cast<char*>(output.data()),
+                                     output.length(),
+                                     input.data(),
+                                     input.length());
 
     if (ZSTD_isError(ret)) {
         return Status{ErrorCodes::BadValue,